@@ -0,0 +1,386 @@
+#pragma once
+#include "CsvWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Minimal micro/macro benchmark harness in the style of Google Benchmark (no dependencies).
+//
+//   static void Integration_Analytical(Bench::State& state) {
+//       while (state.KeepRunning()) {
+//           Bench::DoNotOptimize(ConcreteIntegrationFast::CalculateForce(...));
+//       }
+//       state.SetItemsProcessed(state.Iterations());
+//   }
+//   BENCHMARK(Integration_Analytical);
+//   BENCHMARK(Diagram_Generate)->Arg(10)->Arg(50);
+//   BENCHMARK_MAIN();
+//
+// Each benchmark (and argument) is warmed up, its iteration count is calibrated until one run
+// lasts at least the minimum time, and then it is repeated; the report gives mean, median,
+// standard deviation, coefficient of variation, min and max per iteration over the repetitions.
+// Command line: --filter=<substring> --repetitions=<n> --min-time=<ms> --warmup=<ms>
+//               --max-arg=<n> --csv=<file> --list
+namespace Bench {
+
+    // Keep a value (and everything it depends on) alive, so the computation is not eliminated
+    template <typename T>
+    inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static const volatile void* volatile sink;
+        sink = &value;
+        _ReadWriteBarrier();
+#endif
+    }
+
+    // Force pending memory writes to be considered observable
+    inline void ClobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : : "memory");
+#else
+        _ReadWriteBarrier();
+#endif
+    }
+
+    class State {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        int64_t iterations;
+        int64_t remaining;
+        int64_t arg;
+        bool started = false;
+        bool paused = false;
+        Clock::time_point start;
+        Clock::duration elapsed{};
+        int64_t items = 0;
+        int64_t bytes = 0;
+        std::string label;
+
+    public:
+        State(int64_t iterations, int64_t arg) : iterations(iterations), remaining(iterations), arg(arg) {}
+
+        // Loop condition of the timed region; the clock runs from the first call to the last
+        bool KeepRunning() {
+            if (!started) {
+                started = true;
+                start = Clock::now();
+            }
+            if (remaining-- > 0) return true;
+            if (!paused) elapsed += Clock::now() - start;
+            return false;
+        }
+
+        // Exclude setup inside the loop from the measurement
+        void PauseTiming() {
+            if (!paused) {
+                elapsed += Clock::now() - start;
+                paused = true;
+            }
+        }
+
+        void ResumeTiming() {
+            if (paused) {
+                paused = false;
+                start = Clock::now();
+            }
+        }
+
+        int64_t Iterations() const { return iterations; }
+        int64_t Range() const { return arg; }
+
+        // Work done over all iterations, reported per second
+        void SetItemsProcessed(int64_t n) { items = n; }
+        void SetBytesProcessed(int64_t n) { bytes = n; }
+        void SetLabel(const std::string& text) { label = text; }
+
+        double ElapsedSeconds() const { return std::chrono::duration<double>(elapsed).count(); }
+        int64_t ItemsProcessed() const { return items; }
+        int64_t BytesProcessed() const { return bytes; }
+        const std::string& Label() const { return label; }
+    };
+
+    using Function = std::function<void(State&)>;
+
+    // One registered benchmark; the setters return this for chaining, like Google Benchmark
+    class Benchmark {
+    public:
+        std::string name;
+        Function fn;
+        std::vector<int64_t> args;
+        int64_t fixedIterations = 0;  // 0 = calibrate
+        int repetitions = 0;          // 0 = command-line default
+        double minTimeMs = 0.0;       // 0 = command-line default
+
+        Benchmark(std::string n, Function f) : name(std::move(n)), fn(std::move(f)) {}
+
+        Benchmark* Arg(int64_t a) {
+            args.push_back(a);
+            return this;
+        }
+
+        // lo, lo*mult, lo*mult^2, ... up to hi
+        Benchmark* Range(int64_t lo, int64_t hi, int64_t mult = 10) {
+            for (int64_t a = lo; a <= hi; a *= mult) {
+                args.push_back(a);
+                if (a > hi / mult) break;
+            }
+            return this;
+        }
+
+        Benchmark* Iterations(int64_t n) {
+            fixedIterations = n;
+            return this;
+        }
+
+        Benchmark* Repetitions(int n) {
+            repetitions = n;
+            return this;
+        }
+
+        Benchmark* MinTime(double ms) {
+            minTimeMs = ms;
+            return this;
+        }
+    };
+
+    // Statistics of one benchmark/argument over its repetitions
+    struct Result {
+        std::string name;
+        int64_t iterations = 0;
+        int repetitions = 0;
+        double meanNs = 0.0, medianNs = 0.0, stddevNs = 0.0, minNs = 0.0, maxNs = 0.0;
+        double itemsPerSecond = 0.0;
+        double bytesPerSecond = 0.0;
+        std::string label;
+
+        double Cv() const { return meanNs > 0.0 ? stddevNs / meanNs : 0.0; }
+    };
+
+    struct Options {
+        std::string filter;
+        int repetitions = 5;
+        double minTimeMs = 200.0;
+        double warmupMs = 50.0;
+        int64_t maxArg = 0;  // 0 = no limit
+        std::string csv;
+        bool list = false;
+    };
+
+    class Registry {
+    private:
+        std::vector<std::unique_ptr<Benchmark>> benchmarks;
+
+        static std::string FormatTime(double ns) {
+            std::ostringstream s;
+            s << std::fixed << std::setprecision(ns < 10.0 ? 2 : 1);
+            if (ns < 1e3) s << ns << " ns";
+            else if (ns < 1e6) s << ns / 1e3 << " us";
+            else if (ns < 1e9) s << ns / 1e6 << " ms";
+            else s << ns / 1e9 << " s";
+            return s.str();
+        }
+
+        static std::string FormatRate(double perSecond) {
+            std::ostringstream s;
+            s << std::fixed << std::setprecision(2);
+            if (perSecond >= 1e9) s << perSecond / 1e9 << "G/s";
+            else if (perSecond >= 1e6) s << perSecond / 1e6 << "M/s";
+            else if (perSecond >= 1e3) s << perSecond / 1e3 << "k/s";
+            else s << perSecond << "/s";
+            return s.str();
+        }
+
+        // One run of n iterations; returns seconds spent in the timed region
+        static double RunOnce(const Benchmark& b, int64_t arg, int64_t n) {
+            State state(n, arg);
+            b.fn(state);
+            return state.ElapsedSeconds();
+        }
+
+        static Result Measure(const Benchmark& b, int64_t arg, const std::string& name, const Options& opts) {
+            double minTime = (b.minTimeMs > 0.0 ? b.minTimeMs : opts.minTimeMs) / 1000.0;
+            int reps = b.repetitions > 0 ? b.repetitions : opts.repetitions;
+
+            // Warm-up: caches, page faults, frequency ramp
+            auto warmStart = std::chrono::steady_clock::now();
+            int64_t n = 1;
+            while (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - warmStart).count()
+                   < opts.warmupMs) {
+                RunOnce(b, arg, n);
+                n = std::min<int64_t>(n * 2, int64_t(1) << 30);
+            }
+
+            // Calibrate: grow the iteration count until one run takes at least minTime
+            if (b.fixedIterations > 0) {
+                n = b.fixedIterations;
+            } else {
+                n = 1;
+                for (;;) {
+                    double t = RunOnce(b, arg, n);
+                    if (t >= minTime || n >= (int64_t(1) << 40)) break;
+                    double scale = (t > 0.0) ? std::min(10.0, 1.4 * minTime / t) : 10.0;
+                    n = std::max<int64_t>(n + 1, (int64_t)std::ceil(n * scale));
+                }
+            }
+
+            std::vector<double> perIter;
+            perIter.reserve(reps);
+            double itemsPerSecond = 0.0, bytesPerSecond = 0.0;
+            std::string label;
+            for (int r = 0; r < reps; r++) {
+                State state(n, arg);
+                b.fn(state);
+                double t = state.ElapsedSeconds();
+                perIter.push_back(t * 1e9 / double(n));
+                if (t > 0.0) {
+                    itemsPerSecond += state.ItemsProcessed() / t / reps;
+                    bytesPerSecond += state.BytesProcessed() / t / reps;
+                }
+                label = state.Label();
+            }
+
+            Result res;
+            res.name = name;
+            res.iterations = n;
+            res.repetitions = reps;
+            res.label = label;
+            res.itemsPerSecond = itemsPerSecond;
+            res.bytesPerSecond = bytesPerSecond;
+
+            std::vector<double> sorted = perIter;
+            std::sort(sorted.begin(), sorted.end());
+            res.minNs = sorted.front();
+            res.maxNs = sorted.back();
+            size_t mid = sorted.size() / 2;
+            res.medianNs = (sorted.size() % 2) ? sorted[mid] : 0.5 * (sorted[mid - 1] + sorted[mid]);
+            for (double v : perIter) res.meanNs += v / reps;
+            double var = 0.0;
+            for (double v : perIter) var += (v - res.meanNs) * (v - res.meanNs);
+            res.stddevNs = (reps > 1) ? std::sqrt(var / (reps - 1)) : 0.0;
+            return res;
+        }
+
+        static void PrintHeader() {
+            std::cout << std::left << std::setw(44) << "Benchmark" << std::right
+                      << std::setw(12) << "Mean" << std::setw(12) << "Median" << std::setw(12) << "StdDev"
+                      << std::setw(8) << "CV" << std::setw(12) << "Min" << std::setw(12) << "Iterations"
+                      << std::setw(12) << "Items/s" << "\n";
+            std::cout << std::string(124, '-') << "\n";
+        }
+
+        static void PrintRow(const Result& r) {
+            std::ostringstream cv;
+            cv << std::fixed << std::setprecision(1) << r.Cv() * 100.0 << "%";
+            std::cout << std::left << std::setw(44) << r.name << std::right
+                      << std::setw(12) << FormatTime(r.meanNs) << std::setw(12) << FormatTime(r.medianNs)
+                      << std::setw(12) << FormatTime(r.stddevNs) << std::setw(8) << cv.str()
+                      << std::setw(12) << FormatTime(r.minNs) << std::setw(12) << r.iterations
+                      << std::setw(12) << (r.itemsPerSecond > 0.0 ? FormatRate(r.itemsPerSecond) : "")
+                      << (r.label.empty() ? "" : "  " + r.label) << "\n";
+        }
+
+        static bool WriteCSV(const std::vector<Result>& results, const std::string& filename) {
+            CsvWriter out(filename);
+            if (!out.IsOpen()) return false;
+            out.Text("Benchmark,Iterations,Repetitions,Mean[ns],Median[ns],StdDev[ns],CV[-],Min[ns],Max[ns],"
+                     "Items/s,Bytes/s,Label\n");
+            for (const Result& r : results) {
+                out.Text(r.name);
+                for (double v : { double(r.iterations), double(r.repetitions), r.meanNs, r.medianNs, r.stddevNs,
+                                  r.Cv(), r.minNs, r.maxNs, r.itemsPerSecond, r.bytesPerSecond }) {
+                    out.Char(',');
+                    out.Number(v);
+                }
+                out.Char(',');
+                out.Text(r.label);
+                out.Char('\n');
+            }
+            return out.Close();
+        }
+
+    public:
+        static Registry& Instance() {
+            static Registry registry;
+            return registry;
+        }
+
+        Benchmark* Add(const std::string& name, Function fn) {
+            benchmarks.push_back(std::make_unique<Benchmark>(name, std::move(fn)));
+            return benchmarks.back().get();
+        }
+
+        static Options ParseOptions(int argc, char** argv) {
+            Options opts;
+            for (int i = 1; i < argc; i++) {
+                std::string a = argv[i];
+                auto value = [&](const char* key) -> const char* {
+                    size_t len = std::char_traits<char>::length(key);
+                    return a.compare(0, len, key) == 0 ? a.c_str() + len : nullptr;
+                };
+                if (const char* v = value("--filter=")) opts.filter = v;
+                else if (const char* v = value("--repetitions=")) opts.repetitions = std::max(1, std::atoi(v));
+                else if (const char* v = value("--min-time=")) opts.minTimeMs = std::atof(v);
+                else if (const char* v = value("--warmup=")) opts.warmupMs = std::atof(v);
+                else if (const char* v = value("--max-arg=")) opts.maxArg = std::atoll(v);
+                else if (const char* v = value("--csv=")) opts.csv = v;
+                else if (a == "--list") opts.list = true;
+                else std::cerr << "Unknown option: " << a << "\n";
+            }
+            return opts;
+        }
+
+        // Run every benchmark matching the options; returns the process exit code
+        int Run(int argc, char** argv) {
+            Options opts = ParseOptions(argc, argv);
+            std::vector<Result> results;
+
+            if (!opts.list) PrintHeader();
+            for (const auto& b : benchmarks) {
+                std::vector<int64_t> args = b->args.empty() ? std::vector<int64_t>{ 0 } : b->args;
+                for (int64_t arg : args) {
+                    std::string name = b->args.empty() ? b->name : b->name + "/" + std::to_string(arg);
+                    if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos) continue;
+                    if (opts.maxArg > 0 && arg > opts.maxArg) continue;
+                    if (opts.list) {
+                        std::cout << name << "\n";
+                        continue;
+                    }
+                    results.push_back(Measure(*b, arg, name, opts));
+                    PrintRow(results.back());
+                }
+            }
+
+            if (!opts.csv.empty()) {
+                if (!WriteCSV(results, opts.csv)) {
+                    std::cerr << "Error: Writing " << opts.csv << " failed\n";
+                    return 1;
+                }
+                std::cout << "\nBenchmark results exported to: " << opts.csv << "\n";
+            }
+            return 0;
+        }
+    };
+}
+
+#define BENCH_CONCAT_(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_(a, b)
+#define BENCHMARK(fn) \
+    static ::Bench::Benchmark* BENCH_CONCAT(benchmark_, __LINE__) = ::Bench::Registry::Instance().Add(#fn, fn)
+#define BENCHMARK_MAIN() \
+    int main(int argc, char** argv) { return ::Bench::Registry::Instance().Run(argc, argv); }
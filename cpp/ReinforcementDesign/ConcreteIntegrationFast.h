@@ -1,33 +1,165 @@
 #pragma once
 #include "MaterialProperties.h"
 #include "ConcreteIntegration.h"  // Use ConcreteForces from original file
+#include "SimdLanes.h"
+#include "MaterialLaws.h"
 #include <cmath>
 #include <algorithm>
 #include <limits>
+#include <cstddef>
 
-// Fast analytical concrete stress block integration (ported from C# FastConcreteNM)
+// Concrete force resultants with their partial derivatives w.r.t. strain parameters k, q
+// (strain distribution ε(x) = k·x + q, x measured from the centroid)
+struct ConcreteForcesJacobian {
+    double Fc;       // [N] resultant compressive force
+    double Mc;       // [Nm] moment from concrete (about centroid)
+    double dFc_dk;   // [N·m]
+    double dFc_dq;   // [N]
+    double dMc_dk;   // [N·m^2]
+    double dMc_dq;   // [N·m]
+};
+
+// Fast analytical concrete stress block integration (ported from C# FastConcreteNM).
+// Templated on the concrete law (MaterialLaws.h); the overloads taking ConcreteProperties
+// use the EC2 parabola-rectangle with the configured εc2.
 class ConcreteIntegrationFast {
 private:
-    static constexpr double EC2 = -0.002;        // εc2 = -2‰
-    static constexpr double INV_EC2 = -500.0;    // 1/εc2
+    static constexpr double EC2 = -0.002;        // εc2 = -2‰ of the fcd-only overloads
     static constexpr double TOLERANCE = 1e-12;
 
     static inline bool IsNonZero(double val) { return std::abs(val) >= TOLERANCE; }
     static inline bool IsZero(double val) { return std::abs(val) < TOLERANCE; }
     static inline bool IsLess(double a, double b) { return a < b - TOLERANCE; }
 
-public:
-    /// <summary>
-    /// Fast analytical calculation of concrete forces using EC2 parabolic-rectangular diagram
-    /// Ported from C# FastConcreteNM
-    /// </summary>
-    /// <param name="b">Width [m]</param>
-    /// <param name="h">Height [m]</param>
-    /// <param name="k">Strain gradient (slope) [1/m]</param>
-    /// <param name="q">Strain at centroid [-]</param>
-    /// <param name="fcd">Design concrete strength [Pa] (negative for compression)</param>
-    /// <returns>Concrete forces (N, M about centroid)</returns>
-    static ConcreteForces FastConcreteNM(double b, double h, double k, double q, double fcd) {
+    // Branchless FastConcreteNM for one register of lanes.
+    // Every branch of the scalar routine is evaluated and merged with Select, and the
+    // zones are clipped with min/max. The operation order mirrors FastConcreteNM exactly,
+    // so each lane reproduces the scalar result bit-for-bit (see FastConcreteNMBatch).
+    template <typename L>
+    static inline void BatchKernel(typename L::Vec k, typename L::Vec q,
+                                   typename L::Vec b, typename L::Vec h, typename L::Vec fcd,
+                                   typename L::Vec ec2, typename L::Vec invEc2,
+                                   typename L::Vec& outN, typename L::Vec& outM) {
+        using Vec = typename L::Vec;
+        using Mask = typename L::Mask;
+
+        const Vec zero = L::Set1(0.0);
+        const Vec one = L::Set1(1.0);
+        const Vec two = L::Set1(2.0);
+        const Vec half = L::Set1(0.5);
+        const Vec tol = L::Set1(TOLERANCE);
+
+        Vec h2 = L::Mul(half, h);
+        Vec x1 = L::Neg(h2);
+        Vec x2 = h2;
+        Vec fcdb = L::Mul(fcd, b);
+
+        Vec absK = L::Abs(k);
+        Mask kZero = L::Less(absK, tol);
+
+        // Constant strain (k=0): resolved separately and merged at the end
+        Vec epsNorm = L::Mul(q, invEc2);
+        Vec oneMinus = L::Sub(one, epsNorm);
+        Vec sigma = L::Mul(fcd, L::Sub(one, L::Mul(oneMinus, oneMinus)));
+        Vec nUniform = L::Select(L::GreaterEq(q, zero), zero,
+                       L::Select(L::Less(ec2, q), L::Mul(L::Mul(sigma, b), h),
+                                 L::Mul(fcdb, h)));
+
+        // Critical points (garbage for k=0 lanes, discarded by the final Select)
+        Vec x0 = L::Div(L::Neg(q), k);
+        Vec xEc2 = L::Div(L::Sub(ec2, q), k);
+
+        // SEGMENT 2: Parabolic compression section
+        Vec xa = L::Max(x1, L::Min(xEc2, x0));
+        Vec xb = L::Min(x2, L::Max(xEc2, x0));
+        Mask hasPara = L::Less(xa, L::Sub(xb, tol));
+
+        Vec a = L::Mul(k, invEc2);
+        Vec c = L::Mul(q, invEc2);
+        Vec dx = L::Sub(xb, xa);
+        Vec xa2 = L::Mul(xa, xa);
+        Vec xb2 = L::Mul(xb, xb);
+        Vec dx2 = L::Sub(xb2, xa2);
+        Vec dx3 = L::Div(L::Sub(L::Mul(xb2, xb), L::Mul(xa2, xa)), L::Set1(3.0));
+        Vec dx4 = L::Mul(L::Set1(0.25), L::Sub(L::Mul(xb2, xb2), L::Mul(xa2, xa2)));
+
+        Vec twoA = L::Mul(two, a);
+        Vec coefLin = L::Sub(twoA, L::Mul(twoA, c));
+        Vec coefConst = L::Sub(L::Mul(two, c), L::Mul(c, c));
+        Vec coefSq = L::Mul(a, a);
+
+        Vec nPara = L::Mul(fcdb, L::Sub(L::Add(L::Mul(L::Mul(coefLin, dx2), half),
+                                              L::Mul(coefConst, dx)),
+                                       L::Mul(coefSq, dx3)));
+        Vec mPara = L::Mul(fcdb, L::Sub(L::Add(L::Mul(coefLin, dx3),
+                                              L::Mul(L::Mul(coefConst, dx2), half)),
+                                       L::Mul(coefSq, dx4)));
+
+        Vec N = L::Select(hasPara, L::Add(zero, nPara), zero);
+        Vec M = L::Select(hasPara, L::Add(zero, mPara), zero);
+
+        // SEGMENT 3: Constant compression section (ε ≤ εc2)
+        Mask kPos = L::Less(zero, k);
+        Vec xaConst = L::Select(kPos, x1, L::Max(xEc2, x1));
+        Vec xbConst = L::Select(kPos, L::Min(xEc2, x2), x2);
+        Mask hasConst = L::Less(xaConst, L::Sub(xbConst, tol));
+
+        Vec nConst = L::Mul(fcdb, L::Sub(xbConst, xaConst));
+        Vec mConst = L::Mul(nConst, L::Mul(half, L::Add(xaConst, xbConst)));
+        N = L::Select(hasConst, L::Add(N, nConst), N);
+        M = L::Select(hasConst, L::Add(M, mConst), M);
+
+        outN = L::Select(kZero, nUniform, N);
+        outM = L::Select(kZero, zero, M);
+    }
+
+    // Batch driver: widest available lanes first, then the scalar tail
+    template <bool PerElement, typename L>
+    static inline std::size_t BatchLoop(const double* k, const double* q,
+                                        const double* b, const double* h, const double* fcd,
+                                        const MaterialLaws::ParabolaRectangle& law,
+                                        double* N, double* M, std::size_t begin, std::size_t count) {
+        const std::size_t end = begin + (count - begin) / L::Width * L::Width;
+        const typename L::Vec ec2 = L::Set1(law.EpsC2()), invEc2 = L::Set1(law.InvEpsC2());
+        std::size_t i = begin;
+        for (; i < end; i += L::Width) {
+            typename L::Vec vN, vM;
+            BatchKernel<L>(L::Load(k + i), L::Load(q + i),
+                           PerElement ? L::Load(b + i) : L::Set1(*b),
+                           PerElement ? L::Load(h + i) : L::Set1(*h),
+                           PerElement ? L::Load(fcd + i) : L::Set1(*fcd),
+                           ec2, invEc2, vN, vM);
+            L::Store(N + i, vN);
+            L::Store(M + i, vM);
+        }
+        return i;
+    }
+
+    template <bool PerElement>
+    static void BatchDispatch(const double* k, const double* q,
+                              const double* b, const double* h, const double* fcd,
+                              const MaterialLaws::ParabolaRectangle& law,
+                              double* N, double* M, std::size_t count) {
+        std::size_t i = 0;
+#if defined(__AVX512F__)
+        i = BatchLoop<PerElement, ConcreteSimd::Avx512Lane>(k, q, b, h, fcd, law, N, M, i, count);
+#endif
+#if defined(__AVX2__)
+        i = BatchLoop<PerElement, ConcreteSimd::Avx2Lane>(k, q, b, h, fcd, law, N, M, i, count);
+#endif
+        BatchLoop<PerElement, ConcreteSimd::ScalarLane>(k, q, b, h, fcd, law, N, M, i, count);
+    }
+
+    // Shared body of FastConcreteNM and FastConcreteNMWithJacobian.
+    // The derivatives only come from the curved zone: the stress law is continuous,
+    // so moving zone boundaries contribute nothing, and the constant zone has dσ/dε = 0.
+    template <bool WithJacobian, class Law>
+    static ConcreteForcesJacobian FastConcreteNMImpl(double b, double h, double k, double q, const Law& law) {
+        ConcreteForcesJacobian r = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+        const double fcd = law.Fcd();
+        const double epsC2 = law.EpsC2();
+
         double h2 = 0.5 * h;
         double x1 = -h2;  // BOTTOM (in local coordinates, x=0 at centroid)
         double x2 = h2;   // TOP
@@ -37,7 +169,7 @@ public:
         // Calculate critical points
         if (IsNonZero(k)) {
             x0 = -q / k;                  // Point where ε = 0
-            xEc2 = (EC2 - q) / k;         // Point where ε = εc2
+            xEc2 = (epsC2 - q) / k;       // Point where ε = εc2
         } else {
             // Constant strain case
             if (IsZero(q)) {
@@ -52,65 +184,45 @@ public:
         double N = 0.0;
         double M = 0.0;
 
-        // Constant strain (k=0)
+        // Constant strain (k=0): uniform stress, ∫x dx = 0, ∫x² dx = h³/12
         if (IsZero(k)) {
-            if (q >= 0) {
-                // Tension or zero
-                return { 0.0, 0.0 };
-            } else if (q > EC2) {
-                // Parabolic section
-                double epsilonNorm = q / EC2;
-                double sigma = fcd * (1.0 - (1.0 - epsilonNorm) * (1.0 - epsilonNorm));
-                N = sigma * b * h;
-                M = 0.0;
-            } else {
-                // Constant section
-                N = fcd * b * h;
-                M = 0.0;
+            N = law.Stress(q) * b * h;
+            M = 0.0;
+
+            if constexpr (WithJacobian) {
+                double dSigma = law.Tangent(q);
+                r.dFc_dq = dSigma * b * h;
+                r.dMc_dk = dSigma * b * h * h * h / 12.0;
             }
-            return { N, M };
+            r.Fc = N;
+            r.Mc = M;
+            return r;
         }
 
-        // SEGMENT 2: Parabolic compression section
+        // SEGMENT 2: Curved compression section (εc2 < ε < 0)
         double xaPara = std::max(x1, std::min(xEc2, x0));
         double xbPara = std::min(x2, std::max(xEc2, x0));
 
         if (IsLess(xaPara, xbPara)) {
-            double a = k * INV_EC2;
-            double c = q * INV_EC2;
-
-            double dx = xbPara - xaPara;
-            double dx2 = xbPara * xbPara - xaPara * xaPara;
-            double dx3 = (xbPara * xbPara * xbPara - xaPara * xaPara * xaPara) / 3.0;
-
-            double nPara = fcd * b * (
-                (2.0 * a - 2.0 * a * c) * dx2 * 0.5 +
-                (2.0 * c - c * c) * dx -
-                a * a * dx3
-            );
-
-            double xa2 = xaPara * xaPara;
-            double xb2 = xbPara * xbPara;
-            double xa4 = xa2 * xa2;
-            double xb4 = xb2 * xb2;
-            double dx4 = 0.25 * (xb4 - xa4);
-
-            double mPara = fcd * b * (
-                (2.0 * a - 2.0 * a * c) * dx3 +
-                (2.0 * c - c * c) * dx2 * 0.5 -
-                a * a * dx4
-            );
-
-            N += nPara;
-            M += mPara;
+            MaterialLaws::CurveIntegrals ci = law.template Curve<WithJacobian>(k, q, xaPara, xbPara);
+
+            N += fcd * b * ci.n;
+            M += fcd * b * ci.m;
+
+            if constexpr (WithJacobian) {
+                // dσ/dq = σ', dσ/dk = σ'·x
+                double fac = fcd * b;
+                r.dFc_dq = fac * ci.t0;
+                r.dFc_dk = fac * ci.t1;
+                r.dMc_dq = fac * ci.t1;
+                r.dMc_dk = fac * ci.t2;
+            }
         }
 
         // SEGMENT 3: Constant compression section (ε ≤ εc2)
         double xaConst, xbConst;
 
-        if (std::abs(k) < 1e-10) {
-            xaConst = xbConst = 0.0;
-        } else if (k > 0) {
+        if (k > 0) {
             // ε increases with x, greater compression (ε ≤ εc2) is for x ≤ xEc2
             xaConst = x1;
             xbConst = std::min(xEc2, x2);
@@ -130,19 +242,106 @@ public:
             M += mConst;
         }
 
-        return { N, M };
+        r.Fc = N;
+        r.Mc = M;
+        return r;
+    }
+
+    // EC2 parabola-rectangle with εc2 = -2‰, for the overloads that take only fcd
+    static MaterialLaws::ParabolaRectangle DefaultLaw(double fcd) {
+        return MaterialLaws::ParabolaRectangle(ConcreteProperties{ fcd, EC2, EC2 });
+    }
+
+public:
+    /// <summary>
+    /// Fast analytical calculation of concrete forces using EC2 parabolic-rectangular diagram
+    /// (εc2 = -2‰). Ported from C# FastConcreteNM
+    /// </summary>
+    /// <param name="b">Width [m]</param>
+    /// <param name="h">Height [m]</param>
+    /// <param name="k">Strain gradient (slope) [1/m]</param>
+    /// <param name="q">Strain at centroid [-]</param>
+    /// <param name="fcd">Design concrete strength [Pa] (negative for compression)</param>
+    /// <returns>Concrete forces (N, M about centroid)</returns>
+    static ConcreteForces FastConcreteNM(double b, double h, double k, double q, double fcd) {
+        ConcreteForcesJacobian r = FastConcreteNMImpl<false>(b, h, k, q, DefaultLaw(fcd));
+        return { r.Fc, r.Mc };
+    }
+
+    /// <summary>
+    /// FastConcreteNM for any concrete law of MaterialLaws.h (the law carries fcd and εc2)
+    /// </summary>
+    template <class Law>
+    static ConcreteForces FastConcreteNM(double b, double h, double k, double q, const Law& law) {
+        ConcreteForcesJacobian r = FastConcreteNMImpl<false>(b, h, k, q, law);
+        return { r.Fc, r.Mc };
+    }
+
+    /// <summary>
+    /// FastConcreteNM together with its closed-form partial derivatives w.r.t. k and q
+    /// (same local sign convention as FastConcreteNM). N and M are bit-identical to FastConcreteNM.
+    /// Intended for Newton-type strain-state solvers, replacing finite differences.
+    /// </summary>
+    static ConcreteForcesJacobian FastConcreteNMWithJacobian(double b, double h, double k, double q, double fcd) {
+        return FastConcreteNMImpl<true>(b, h, k, q, DefaultLaw(fcd));
+    }
+
+    template <class Law>
+    static ConcreteForcesJacobian FastConcreteNMWithJacobian(double b, double h, double k, double q, const Law& law) {
+        return FastConcreteNMImpl<true>(b, h, k, q, law);
+    }
+
+    /// <summary>
+    /// Batch version of FastConcreteNM over structure-of-arrays inputs (one section, many strain states)
+    /// Branchless: zones are clipped with min/max and merged with masks, so the loop runs
+    /// 8 lanes wide with AVX-512, 4 lanes with AVX2 and falls back to scalar code otherwise.
+    /// Accuracy: every lane performs the same IEEE operations in the same order as FastConcreteNM,
+    /// so results are bit-identical as long as the compiler does not contract a*b+c into FMA
+    /// (MSVC /fp:precise, GCC/Clang -ffp-contract=off). With contraction enabled, the difference
+    /// stays within 4 ULP of |fcd*b*h| for N and |fcd*b*h^2| for M.
+    /// Moments are in the local (C#) convention, like FastConcreteNM.
+    /// </summary>
+    /// <param name="k">Strain gradients [1/m], count elements</param>
+    /// <param name="q">Strains at centroid [-], count elements</param>
+    /// <param name="N">Output axial forces [N], count elements</param>
+    /// <param name="M">Output moments about centroid [Nm], count elements</param>
+    static void FastConcreteNMBatch(const double* k, const double* q, std::size_t count,
+                                    double b, double h, double fcd,
+                                    double* N, double* M) {
+        BatchDispatch<false>(k, q, &b, &h, &fcd, DefaultLaw(fcd), N, M, count);
+    }
+
+    /// <summary>
+    /// Batch version of FastConcreteNM for a parabola-rectangle law with any εc2
+    /// (the batch kernel is specialized for n = 2)
+    /// </summary>
+    static void FastConcreteNMBatch(const double* k, const double* q, std::size_t count,
+                                    double b, double h, const MaterialLaws::ParabolaRectangle& law,
+                                    double* N, double* M) {
+        double fcd = law.Fcd();
+        BatchDispatch<false>(k, q, &b, &h, &fcd, law, N, M, count);
+    }
+
+    /// <summary>
+    /// Batch version of FastConcreteNM with per-element section width, height and strength
+    /// </summary>
+    static void FastConcreteNMBatch(const double* k, const double* q,
+                                    const double* b, const double* h, const double* fcd,
+                                    std::size_t count, double* N, double* M) {
+        BatchDispatch<true>(k, q, b, h, fcd, DefaultLaw(0.0), N, M, count);
     }
 
     /// <summary>
     /// Calculate concrete forces given strain at top and bottom
     /// (Wrapper that converts to k,q parameterization and calls FastConcreteNM)
     /// </summary>
+    template <class Law>
     static ConcreteForces CalculateForce(
         double epsTop,
         double epsBot,
         double b,
         double h,
-        const ConcreteProperties& props
+        const Law& law
     ) {
         // Convert epsTop, epsBot to k, q parameterization
         // Local coordinates: x=0 at centroid, x=+h/2 at top, x=-h/2 at bottom
@@ -158,7 +357,7 @@ public:
         double k = (epsTop - epsBot) / h;
         double q = (epsTop + epsBot) / 2.0;
 
-        auto result = FastConcreteNM(b, h, k, q, props.fcd);
+        auto result = FastConcreteNM(b, h, k, q, law);
 
         // IMPORTANT: Negate moment for consistency with C++ sign convention
         // C++ numericalintegration uses: momentSum += dF * (-yFromCenter)
@@ -167,4 +366,52 @@ public:
 
         return result;
     }
+
+    /// <summary>
+    /// CalculateForce with the EC2 parabola-rectangle law of the given properties (fcd, εc2)
+    /// </summary>
+    static ConcreteForces CalculateForce(
+        double epsTop,
+        double epsBot,
+        double b,
+        double h,
+        const ConcreteProperties& props
+    ) {
+        return CalculateForce(epsTop, epsBot, b, h, MaterialLaws::ParabolaRectangle(props));
+    }
+
+    /// <summary>
+    /// CalculateForce together with the partial derivatives of Fc and Mc w.r.t. k and q,
+    /// where k = (epsTop - epsBot) / h and q = (epsTop + epsBot) / 2.
+    /// Moment and its derivatives use the same (negated) sign convention as CalculateForce.
+    /// </summary>
+    template <class Law>
+    static ConcreteForcesJacobian CalculateForceWithJacobian(
+        double epsTop,
+        double epsBot,
+        double b,
+        double h,
+        const Law& law
+    ) {
+        double k = (epsTop - epsBot) / h;
+        double q = (epsTop + epsBot) / 2.0;
+
+        ConcreteForcesJacobian result = FastConcreteNMWithJacobian(b, h, k, q, law);
+
+        result.Mc = -result.Mc;
+        result.dMc_dk = -result.dMc_dk;
+        result.dMc_dq = -result.dMc_dq;
+
+        return result;
+    }
+
+    static ConcreteForcesJacobian CalculateForceWithJacobian(
+        double epsTop,
+        double epsBot,
+        double b,
+        double h,
+        const ConcreteProperties& props
+    ) {
+        return CalculateForceWithJacobian(epsTop, epsBot, b, h, MaterialLaws::ParabolaRectangle(props));
+    }
 };
@@ -0,0 +1,410 @@
+#pragma once
+#include "MaterialProperties.h"
+#include "ConcreteIntegration.h"  // ConcreteForces
+#include "MaterialLaws.h"
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+// Polygon vertex [m]: x horizontal, y vertical (up; the top fiber has the largest y)
+struct PolygonVertex {
+    double x;
+    double y;
+};
+
+// Cross-section made of simple polygons: one outer boundary and optional holes.
+// Rings may be given in either orientation; they are normalized on construction
+// (outer counter-clockwise, holes clockwise) so that holes subtract.
+// Per-edge data is stored relative to the centroid, ready for ConcreteIntegrationPolygon.
+class PolygonSection {
+public:
+    // Edge from (x1, y1) to (x1 + dx, y1 + dy), coordinates relative to the centroid
+    struct Edge {
+        double x1, y1;
+        double dx, dy;
+    };
+
+private:
+    std::vector<std::vector<PolygonVertex>> rings;  // input coordinates, normalized orientation
+    std::vector<Edge> edges;  // edges with dx != 0 (vertical edges do not contribute)
+    double area = 0.0;
+    double xc = 0.0, yc = 0.0;     // centroid in input coordinates
+    double yTop = 0.0, yBot = 0.0; // extreme fibers relative to the centroid
+    double inertia = 0.0;          // second moment about the horizontal centroidal axis
+
+    static double SignedArea(const std::vector<PolygonVertex>& ring) {
+        double a = 0.0;
+        for (size_t i = 0, n = ring.size(); i < n; i++) {
+            const PolygonVertex& p = ring[i];
+            const PolygonVertex& r = ring[(i + 1) % n];
+            a += p.x * r.y - r.x * p.y;
+        }
+        return 0.5 * a;
+    }
+
+    void Build(std::vector<std::vector<PolygonVertex>> input) {
+        rings = std::move(input);
+
+        // Orientation: outer ring CCW (positive area), holes CW
+        for (size_t r = 0; r < rings.size(); r++) {
+            double a = SignedArea(rings[r]);
+            if ((r == 0) != (a > 0.0)) {
+                std::reverse(rings[r].begin(), rings[r].end());
+            }
+        }
+
+        // Area, centroid and extreme fibers (Green's theorem)
+        double a = 0.0, sx = 0.0, sy = 0.0;
+        double yMax = -1e300, yMin = 1e300;
+        for (const auto& ring : rings) {
+            for (size_t i = 0, n = ring.size(); i < n; i++) {
+                const PolygonVertex& p = ring[i];
+                const PolygonVertex& r = ring[(i + 1) % n];
+                double cross = p.x * r.y - r.x * p.y;
+                a += cross;
+                sx += (p.x + r.x) * cross;
+                sy += (p.y + r.y) * cross;
+                yMax = std::max(yMax, p.y);
+                yMin = std::min(yMin, p.y);
+            }
+        }
+        area = 0.5 * a;
+        xc = area != 0.0 ? sx / (6.0 * area) : 0.0;
+        yc = area != 0.0 ? sy / (6.0 * area) : 0.0;
+        yTop = yMax - yc;
+        yBot = yMin - yc;
+
+        // Edges relative to the centroid, and Ixx = -∮ y³/3 dx
+        edges.clear();
+        inertia = 0.0;
+        for (const auto& ring : rings) {
+            for (size_t i = 0, n = ring.size(); i < n; i++) {
+                const PolygonVertex& p = ring[i];
+                const PolygonVertex& r = ring[(i + 1) % n];
+                Edge e = { p.x - xc, p.y - yc, r.x - p.x, r.y - p.y };
+                if (e.dx == 0.0) continue;
+                double y2 = e.y1 + e.dy;
+                inertia -= e.dx * (e.y1 * e.y1 * e.y1 + e.y1 * e.y1 * y2 + e.y1 * y2 * y2 + y2 * y2 * y2) / 12.0;
+                edges.push_back(e);
+            }
+        }
+    }
+
+public:
+    PolygonSection() = default;
+
+    explicit PolygonSection(const std::vector<PolygonVertex>& outer,
+                            const std::vector<std::vector<PolygonVertex>>& holes = {}) {
+        std::vector<std::vector<PolygonVertex>> input;
+        input.push_back(outer);
+        input.insert(input.end(), holes.begin(), holes.end());
+        Build(std::move(input));
+    }
+
+    // Rectangle b x h
+    static PolygonSection Rectangle(double b, double h) {
+        return PolygonSection({ { 0.0, 0.0 }, { b, 0.0 }, { b, h }, { 0.0, h } });
+    }
+
+    // T-section: flange bf x hf on top of web bw, total height h
+    static PolygonSection TSection(double bf, double hf, double bw, double h) {
+        double x0 = 0.5 * (bf - bw);
+        return PolygonSection({ { x0, 0.0 }, { x0 + bw, 0.0 }, { x0 + bw, h - hf }, { bf, h - hf },
+                                { bf, h }, { 0.0, h }, { 0.0, h - hf }, { x0, h - hf } });
+    }
+
+    // Doubly symmetric I-section: flanges bf x tf, web tw, total height h
+    static PolygonSection ISection(double bf, double tf, double tw, double h) {
+        double x0 = 0.5 * (bf - tw);
+        return PolygonSection({ { 0.0, 0.0 }, { bf, 0.0 }, { bf, tf }, { x0 + tw, tf },
+                                { x0 + tw, h - tf }, { bf, h - tf }, { bf, h }, { 0.0, h },
+                                { 0.0, h - tf }, { x0, h - tf }, { x0, tf }, { 0.0, tf } });
+    }
+
+    // Rectangular hollow box b x h with wall thicknesses tw (sides) and tf (top/bottom)
+    static PolygonSection HollowBox(double b, double h, double tw, double tf) {
+        return PolygonSection({ { 0.0, 0.0 }, { b, 0.0 }, { b, h }, { 0.0, h } },
+                              { { { tw, tf }, { b - tw, tf }, { b - tw, h - tf }, { tw, h - tf } } });
+    }
+
+    // Circle of diameter d approximated by a regular polygon of equal area
+    static PolygonSection Circle(double d, int segments = 64) {
+        const double pi = 3.14159265358979323846;
+        segments = std::max(segments, 3);
+        // Circumradius giving the same area as the circle
+        double r = 0.5 * d * std::sqrt((2.0 * pi / segments) / std::sin(2.0 * pi / segments));
+        std::vector<PolygonVertex> ring(segments);
+        for (int i = 0; i < segments; i++) {
+            double phi = 2.0 * pi * i / segments;
+            ring[i] = { r * std::cos(phi), r * std::sin(phi) };
+        }
+        return PolygonSection(ring);
+    }
+
+    // Copy rotated counter-clockwise by angle [rad] about the centroid, with the centroid moved
+    // to the origin. A point (x, y) maps to (x·cos - y·sin, x·sin + y·cos) relative to the centroid,
+    // so the fiber direction (sin, cos) becomes vertical (biaxial bending about a rotated axis).
+    PolygonSection Rotated(double angle) const {
+        double c = std::cos(angle), s = std::sin(angle);
+        std::vector<std::vector<PolygonVertex>> rotated = rings;
+        for (auto& ring : rotated) {
+            for (PolygonVertex& v : ring) {
+                double x = v.x - xc, y = v.y - yc;
+                v = { x * c - y * s, x * s + y * c };
+            }
+        }
+        PolygonSection result;
+        result.Build(std::move(rotated));
+        return result;
+    }
+
+    const std::vector<Edge>& Edges() const { return edges; }
+    double Area() const { return area; }
+    double CentroidX() const { return xc; }
+    double CentroidY() const { return yc; }
+    double Top() const { return yTop; }        // [m] top fiber above the centroid (> 0)
+    double Bottom() const { return yBot; }     // [m] bottom fiber below the centroid (< 0)
+    double Height() const { return yTop - yBot; }
+    double Inertia() const { return inertia; } // [m^4] about the horizontal centroidal axis
+};
+
+// Concrete forces including the moment about the vertical axis, local convention
+struct BiaxialConcreteForces {
+    double Fc;   // [N] ∫σ dA
+    double Mc;   // [Nm] ∫σ·y dA
+    double McX;  // [Nm] ∫σ·x dA
+};
+
+// Exact analytical integration of the concrete stress block over a PolygonSection
+// (strain distribution ε(y) = k·y + q, y measured from the centroid).
+//
+// By Green's theorem, ∫∫ f(y) dA = -∮ F(y) dx with F' = f, so each edge contributes
+// -dx·∫F(y(τ))dτ. F is a piecewise polynomial (degree ≤ 3 for N, ≤ 4 for M) whose pieces
+// meet where ε = 0 and ε = εc2; each edge is clipped at those two lines and every piece is
+// integrated exactly with 3-point Gauss-Legendre quadrature. This needs a polynomial law of
+// degree ≤ 2 (MaterialLaws::ParabolaRectangle or BilinearConcrete).
+class ConcreteIntegrationPolygon {
+private:
+    // Stress zone [y0, y1] along the height: σ(y0 + w) = c0 + c1·w + c2·w²,
+    // with the antiderivatives FN = ∫σ dy and FM = ∫σ·y dy at y0
+    struct Zone {
+        double y0;
+        double c0, c1, c2;
+        double fn0, fm0;
+
+        void Evaluate(double y, double& fn, double& fm) const {
+            double w = y - y0;
+            double p = w * (c0 + w * (c1 * 0.5 + w * c2 / 3.0));
+            // ∫(c0 + c1 s + c2 s²)(y0 + s) ds over [0, w]
+            fn = fn0 + p;
+            fm = fm0 + y0 * p + w * w * (c0 * 0.5 + w * (c1 / 3.0 + w * c2 * 0.25));
+        }
+    };
+
+    struct StressProfile {
+        Zone zones[3];
+        double bounds[2];  // interior zone boundaries (ascending)
+        int zoneCount = 0;
+        // Stress-free zone, where FN = FM = 0 (empty if lo > hi)
+        double freeLo = 1.0, freeHi = -1.0;
+
+        int Find(double y) const {
+            int z = 0;
+            while (z + 1 < zoneCount && y > bounds[z]) z++;
+            return z;
+        }
+    };
+
+    template <class Law>
+    static StressProfile BuildProfile(double yBot, double yTop, double k, double q, const Law& law) {
+        StressProfile p;
+        const double epsC2 = law.EpsC2();
+
+        // Zone boundaries where ε = εc2 and ε = 0, inside (yBot, yTop)
+        double cuts[2];
+        int cutCount = 0;
+        if (k != 0.0) {
+            for (double eps : { epsC2, 0.0 }) {
+                double y = (eps - q) / k;
+                if (y > yBot && y < yTop) cuts[cutCount++] = y;
+            }
+            if (cutCount == 2 && cuts[0] > cuts[1]) std::swap(cuts[0], cuts[1]);
+        }
+
+        double fn = 0.0, fm = 0.0;
+        int freeZone = -1;
+        for (int z = 0; z <= cutCount; z++) {
+            double y0 = (z == 0) ? yBot : cuts[z - 1];
+            double y1 = (z == cutCount) ? yTop : cuts[z];
+
+            Zone& zone = p.zones[z];
+            zone.y0 = y0;
+            zone.fn0 = fn;
+            zone.fm0 = fm;
+
+            // Zone type from the strain in its middle
+            double epsMid = k * 0.5 * (y0 + y1) + q;
+            if (epsMid >= 0.0) {
+                zone.c0 = zone.c1 = zone.c2 = 0.0;
+                freeZone = z;
+                p.freeLo = y0;
+                p.freeHi = y1;
+            } else if (epsMid <= epsC2) {
+                zone.c0 = law.Fcd();
+                zone.c1 = zone.c2 = 0.0;
+            } else {
+                // σ(ε0 + k·w) on the curved branch
+                law.CurvePolynomial(k * y0 + q, k, zone.c0, zone.c1, zone.c2);
+            }
+
+            if (z < cutCount) p.bounds[z] = y1;
+            p.zoneCount = z + 1;
+            zone.Evaluate(y1, fn, fm);
+        }
+
+        // ∮ const·dx = 0 around a closed ring, so the antiderivatives may be shifted freely.
+        // Shifting them to zero in the stress-free zone lets edges lying there be skipped.
+        if (freeZone >= 0) {
+            double fnFree = p.zones[freeZone].fn0, fmFree = p.zones[freeZone].fm0;
+            for (int z = 0; z < p.zoneCount; z++) {
+                p.zones[z].fn0 -= fnFree;
+                p.zones[z].fm0 -= fmFree;
+            }
+        }
+        return p;
+    }
+
+    // N = ∫σ dA, M = ∫σ·y dA and, if WithX, Mx = ∫σ·x dA (= -∮ x·FN(y) dx, degree ≤ 4 on an edge)
+    template <bool WithX, class Law>
+    static void Integrate(const PolygonSection& section, double k, double q, const Law& law,
+                          double& N, double& M, double& Mx) {
+        static_assert(Law::Polynomial, "polygon integration needs a polynomial concrete law");
+        N = M = Mx = 0.0;
+
+        // Uncracked tension everywhere: nothing to integrate
+        if (std::min(k * section.Top(), k * section.Bottom()) + q >= 0.0) {
+            return;
+        }
+
+        StressProfile profile = BuildProfile(section.Bottom(), section.Top(), k, q, law);
+
+        // 3-point Gauss-Legendre on [0, 1]
+        static const double gt[3] = { 0.1127016653792583, 0.5, 0.8872983346207417 };
+        static const double gw[3] = { 5.0 / 18.0, 8.0 / 18.0, 5.0 / 18.0 };
+
+        for (const PolygonSection::Edge& e : section.Edges()) {
+            double y2 = e.y1 + e.dy;
+            double yMin = std::min(e.y1, y2), yMax = std::max(e.y1, y2);
+            if (yMin >= profile.freeLo && yMax <= profile.freeHi) continue;
+
+            double sumN = 0.0, sumM = 0.0, sumX = 0.0;
+            if (e.dy == 0.0) {
+                profile.zones[profile.Find(e.y1)].Evaluate(e.y1, sumN, sumM);
+                if (WithX) sumX = (e.x1 + 0.5 * e.dx) * sumN;
+            } else {
+                // Clip the edge at the zone boundaries it crosses
+                double ts[4] = { 0.0, 1.0, 1.0, 1.0 };
+                int tCount = 1;
+                for (int b = 0; b + 1 < profile.zoneCount; b++) {
+                    if (profile.bounds[b] > yMin && profile.bounds[b] < yMax) {
+                        ts[tCount++] = (profile.bounds[b] - e.y1) / e.dy;
+                    }
+                }
+                if (tCount == 3 && ts[1] > ts[2]) std::swap(ts[1], ts[2]);
+                ts[tCount] = 1.0;
+
+                for (int s = 0; s < tCount; s++) {
+                    double t0 = ts[s];
+                    double dt = ts[s + 1] - t0;
+                    if (dt <= 0.0) continue;
+                    const Zone& zone = profile.zones[profile.Find(e.y1 + (t0 + 0.5 * dt) * e.dy)];
+                    double pn = 0.0, pm = 0.0, px = 0.0;
+                    for (int g = 0; g < 3; g++) {
+                        double t = t0 + gt[g] * dt;
+                        double fn, fm;
+                        zone.Evaluate(e.y1 + t * e.dy, fn, fm);
+                        pn += gw[g] * fn;
+                        pm += gw[g] * fm;
+                        if (WithX) px += gw[g] * (e.x1 + t * e.dx) * fn;
+                    }
+                    sumN += dt * pn;
+                    sumM += dt * pm;
+                    sumX += dt * px;
+                }
+            }
+            N -= e.dx * sumN;
+            M -= e.dx * sumM;
+            if (WithX) Mx -= e.dx * sumX;
+        }
+
+    }
+
+public:
+    /// <summary>
+    /// Concrete forces over a polygonal section for the strain distribution ε(y) = k·y + q
+    /// Same local sign convention as ConcreteIntegrationFast::FastConcreteNM (M = ∫σ·y dA)
+    /// </summary>
+    /// <param name="section">Cross-section (edges relative to its centroid)</param>
+    /// <param name="k">Strain gradient (slope) [1/m]</param>
+    /// <param name="q">Strain at centroid [-]</param>
+    /// <param name="law">Concrete law (MaterialLaws.h, polynomial)</param>
+    /// <returns>Concrete forces (N, M about centroid)</returns>
+    template <class Law>
+    static ConcreteForces PolygonConcreteNM(const PolygonSection& section, double k, double q, const Law& law) {
+        double N, M, Mx;
+        Integrate<false>(section, k, q, law, N, M, Mx);
+        return { N, M };
+    }
+
+    /// <summary>
+    /// PolygonConcreteNM with the EC2 parabola-rectangle law of the given properties
+    /// </summary>
+    static ConcreteForces PolygonConcreteNM(const PolygonSection& section, double k, double q,
+                                            const ConcreteProperties& props) {
+        return PolygonConcreteNM(section, k, q, MaterialLaws::ParabolaRectangle(props));
+    }
+
+    /// <summary>
+    /// As PolygonConcreteNM, plus the first moment about the vertical axis (McX = ∫σ·x dA),
+    /// for biaxial bending where the section is rotated so that the neutral axis is horizontal
+    /// </summary>
+    template <class Law>
+    static BiaxialConcreteForces PolygonConcreteNMM(const PolygonSection& section, double k, double q, const Law& law) {
+        BiaxialConcreteForces result;
+        Integrate<true>(section, k, q, law, result.Fc, result.Mc, result.McX);
+        return result;
+    }
+
+    static BiaxialConcreteForces PolygonConcreteNMM(const PolygonSection& section, double k, double q,
+                                                    const ConcreteProperties& props) {
+        return PolygonConcreteNMM(section, k, q, MaterialLaws::ParabolaRectangle(props));
+    }
+
+    /// <summary>
+    /// Calculate concrete forces given strain at the top and bottom fibers of a polygonal section
+    /// (same sign convention as ConcreteIntegrationFast::CalculateForce)
+    /// </summary>
+    template <class Law>
+    static ConcreteForces CalculateForce(
+        double epsTop,
+        double epsBot,
+        const PolygonSection& section,
+        const Law& law
+    ) {
+        double k = (epsTop - epsBot) / section.Height();
+        double q = epsBot - k * section.Bottom();
+
+        ConcreteForces result = PolygonConcreteNM(section, k, q, law);
+        result.Mc = -result.Mc;
+        return result;
+    }
+
+    static ConcreteForces CalculateForce(
+        double epsTop,
+        double epsBot,
+        const PolygonSection& section,
+        const ConcreteProperties& props
+    ) {
+        return CalculateForce(epsTop, epsBot, section, MaterialLaws::ParabolaRectangle(props));
+    }
+};
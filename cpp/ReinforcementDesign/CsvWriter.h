@@ -0,0 +1,155 @@
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef CSV_WRITER_ZLIB
+#include <zlib.h>
+#endif
+
+// Buffered CSV writer. Numbers are formatted with std::to_chars (shortest round-trip, or fixed
+// precision) straight into a large buffer that is written out in blocks, instead of going
+// through ostream operator<< field by field.
+//
+// Optional gzip compression needs zlib: build with CSV_WRITER_ZLIB defined and link zlib (the
+// CMake option of the same name). Without it, a compressed writer does not open.
+class CsvWriter {
+private:
+    static constexpr size_t MAX_FIELD = 384;  // longest formatted number (fixed notation of 1e308)
+
+    std::vector<char> buffer;
+    size_t used = 0;
+    std::ofstream file;
+#ifdef CSV_WRITER_ZLIB
+    gzFile gz = nullptr;
+#endif
+    bool ok = false;
+
+    void WriteBlock(const char* data, size_t size) {
+        if (size == 0 || !ok) return;
+#ifdef CSV_WRITER_ZLIB
+        if (gz) {
+            ok = gzwrite(gz, data, (unsigned)size) == (int)size;
+            return;
+        }
+#endif
+        file.write(data, (std::streamsize)size);
+        ok = (bool)file;
+    }
+
+    void Flush() {
+        WriteBlock(buffer.data(), used);
+        used = 0;
+    }
+
+    // Pointer to at least n free bytes (n <= buffer size)
+    char* Reserve(size_t n) {
+        if (buffer.size() - used < n) Flush();
+        return buffer.data() + used;
+    }
+
+public:
+    // Whether compress = true can be used (built with CSV_WRITER_ZLIB)
+#ifdef CSV_WRITER_ZLIB
+    static constexpr bool COMPRESSION_AVAILABLE = true;
+#else
+    static constexpr bool COMPRESSION_AVAILABLE = false;
+#endif
+
+    // compress = gzip output (see above); bufferSize = bytes collected before each write
+    explicit CsvWriter(const std::string& filename, bool compress = false, size_t bufferSize = 1 << 20)
+        : buffer(bufferSize > MAX_FIELD ? bufferSize : MAX_FIELD) {
+        if (compress) {
+#ifdef CSV_WRITER_ZLIB
+            gz = gzopen(filename.c_str(), "wb6");
+            ok = gz != nullptr;
+            if (gz) gzbuffer(gz, (unsigned)buffer.size());
+            return;
+#else
+            std::cerr << "Error: built without CSV_WRITER_ZLIB, cannot write " << filename << " compressed\n";
+            return;  // never plain text under a compressed file name
+#endif
+        }
+        file.open(filename);  // text mode, same line endings as the ofstream exports
+        ok = file.is_open();
+    }
+
+    ~CsvWriter() {
+        Close();
+    }
+
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    bool IsOpen() const {
+        return ok;
+    }
+
+    void Text(const char* s, size_t n) {
+        if (n > buffer.size() - used) {
+            Flush();
+            if (n > buffer.size()) {
+                WriteBlock(s, n);  // larger than the buffer: write through
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, s, n);
+        used += n;
+    }
+
+    void Text(const char* s) {
+        Text(s, std::strlen(s));
+    }
+
+    void Text(const std::string& s) {
+        Text(s.data(), s.size());
+    }
+
+    void Char(char c) {
+        *Reserve(1) = c;
+        used++;
+    }
+
+    // Shortest representation that reads back to the same double
+    void Number(double v) {
+        char* p = Reserve(MAX_FIELD);
+        used = std::to_chars(p, p + MAX_FIELD, v).ptr - buffer.data();
+    }
+
+    // Fixed notation with the given number of decimals (as std::fixed << std::setprecision)
+    void Fixed(double v, int precision) {
+        char* p = Reserve(MAX_FIELD);
+        auto result = std::to_chars(p, p + MAX_FIELD, v, std::chars_format::fixed, precision);
+        if (result.ec != std::errc()) {
+            // Does not fit a field (very large precision): fall back to the shortest form
+            result = std::to_chars(p, p + MAX_FIELD, v);
+        }
+        used = result.ptr - buffer.data();
+    }
+
+    void Integer(int64_t v) {
+        char* p = Reserve(MAX_FIELD);
+        used = std::to_chars(p, p + MAX_FIELD, v).ptr - buffer.data();
+    }
+
+    // Write pending data and close the file; returns false if any write failed
+    bool Close() {
+        Flush();
+#ifdef CSV_WRITER_ZLIB
+        if (gz) {
+            ok = (gzclose(gz) == Z_OK) && ok;
+            gz = nullptr;
+            return ok;
+        }
+#endif
+        if (file.is_open()) {
+            file.close();
+            ok = ok && !file.fail();
+        }
+        return ok;
+    }
+};
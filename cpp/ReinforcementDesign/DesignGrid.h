@@ -0,0 +1,364 @@
+#pragma once
+#include "MaterialProperties.h"
+#include "ReinforcementDesigner.h"
+#include "LoadCaseFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Precomputed As2(N, M) of one section, for sections that are queried millions of times.
+//
+// A rectangle of the (N, M) plane is split into cellsN x cellsM cells holding As2 at their
+// corners; a query interpolates bilinearly in its cell. The build checks every cell against
+// the designer on a lattice of checkSteps x checkSteps steps inside it, with half the
+// tolerance. As2 is smooth within one strain regime, but has a kink where the design changes
+// regime: As2 starts to be needed, the bottom steel yields, the steel or the concrete strain
+// limit governs, the whole section is compressed. A kink can cut a corner of a cell between
+// the check points, so the build also compares the regimes of all the lattice points: a cell
+// whose points are not all of one regime fails the check like one that misses the tolerance.
+// A cell that fails is refined into refine x refine sub-cells, checked the same way.
+// Sub-cells that still fail (the band along each kink), and cells the designer cannot design
+// at a lattice point (outside the feasible region, no convergence), are masked invalid:
+// queries there report false and the caller designs those cases directly. The tolerance is
+// still checked at the lattice points only; a kink that misses all of them is not detected.
+//
+// Every cell is a block {first node, first mask entry, sub-cells per side}, 1 for cells that
+// were not refined, so a query is the same arithmetic for every cell: two scalings, one block
+// and four node reads, no data-dependent branches. Loops over load columns vectorize.
+class DesignGrid {
+public:
+    struct Options {
+        double nMin = 0.0, nMax = 0.0;  // [N] domain; nMin >= nMax: from the diagram, see DefaultDomain
+        double mMin = 0.0, mMax = 0.0;  // [Nm] likewise
+        double maxAs2 = 0.0;            // [m^2] As2 the default domain covers; 0 = 4 % of b*h (EC2 maximum)
+        unsigned cellsN = 128;
+        unsigned cellsM = 128;
+        unsigned refine = 8;            // sub-cells per side of a refined cell; 1 = no refinement
+        unsigned checkSteps = 4;        // check lattice steps per side of every cell and sub-cell (>= 2)
+        double tolerance = 1e-6;        // [m^2] |grid - Design| targeted in valid cells (0.01 cm^2), see above
+    };
+
+    struct Stats {
+        size_t cells = 0;            // cellsN x cellsM
+        size_t refinedCells = 0;
+        size_t leafCells = 0;        // cells and sub-cells that answer queries
+        size_t validCells = 0;       // leaf cells that passed the check
+        size_t kinkCells = 0;        // leaf cells masked because a regime changes inside them
+        size_t designs = 0;          // designer calls of the build
+        double maxCheckError = 0.0;  // [m^2] largest |grid - Design| at the check points of valid cells
+                                     // (not a bound for the points between them)
+        double seconds = 0.0;        // build time
+        size_t memoryBytes = 0;      // blocks, nodes and mask
+    };
+
+private:
+    struct Block {
+        uint32_t node;  // first node in nodes, (res+1)^2 values row by row along N
+        uint32_t mask;  // first entry in mask, res^2 sub-cells
+        uint32_t res;   // sub-cells per side
+    };
+
+    // Rectangle at n0, m0 split into rN x rM cells of dn x dm, designed on the lattice of k
+    // steps per cell side: nodes at lattice indices divisible by k, check points in between
+    struct Patch {
+        double n0, m0, dn, dm;
+        unsigned rN, rM, k;
+
+        size_t Stride() const { return size_t(k) * rM + 1; }
+        size_t Size() const { return (size_t(k) * rN + 1) * Stride(); }
+    };
+
+    double n0 = 0.0, m0 = 0.0;
+    double invDn = 0.0, invDm = 0.0;  // 1 / cell size
+    double nLimit = 0.0, mLimit = 0.0;  // largest scaled coordinate below cellsN, cellsM
+    double spanN = 0.0, spanM = 0.0;    // cellsN, cellsM (domain in scaled coordinates)
+    size_t cellsN = 0, cellsM = 0;
+    double tolerance = 0.0;
+    double yieldStrain = 0.0, limitStrain = 0.0;  // [-] of the bottom steel, for Regime
+    std::vector<Block> blocks;
+    std::vector<double> nodes;   // [m^2] As2, 0 where the designer failed
+    std::vector<uint8_t> mask;   // 1 = valid sub-cell
+    Stats stats;
+
+    // Detaches the designer's cache for the build and reattaches it on every way out
+    template <class Designer>
+    struct CacheBypass {
+        Designer& designer;
+        std::shared_ptr<DesignCache> cache;
+
+        explicit CacheBypass(Designer& d) : designer(d), cache(d.GetCache()) {
+            designer.SetCache(nullptr);
+        }
+        ~CacheBypass() {
+            designer.SetCache(cache);
+        }
+        CacheBypass(const CacheBypass&) = delete;
+        CacheBypass& operator=(const CacheBypass&) = delete;
+    };
+
+    static void AppendLattice(const Patch& p, std::vector<DesignLoads>& loads) {
+        for (size_t i = 0; i <= size_t(p.k) * p.rN; i++) {
+            for (size_t j = 0; j <= size_t(p.k) * p.rM; j++) {
+                loads.push_back({ p.n0 + p.dn * double(i) / p.k, p.m0 + p.dm * double(j) / p.k });
+            }
+        }
+    }
+
+    // Strain regime of a design; As2 is smooth within one and has a kink between two
+    uint32_t Regime(const DesignResult& r) const {
+        if (!(r.As2 > 0.0)) return 0;  // no steel needed (As2 = 0 throughout)
+        return 1 | (r.epsS2 >= yieldStrain ? 2 : 0) | (r.epsS2 <= -yieldStrain ? 4 : 0) |
+               (r.epsS2 >= limitStrain * (1.0 - 1e-9) ? 8 : 0) | (r.epsBot <= 0.0 && r.epsTop <= 0.0 ? 16 : 0);
+    }
+
+    // Cell (i, j) of a designed patch: all (k+1)^2 lattice points designed and of one regime,
+    // and the bilinear values at the points that are not corners within tol / 2; err = largest
+    // deviation, kink = the points are designed but of more than one regime
+    bool CellOk(const DesignResult* lattice, const Patch& p, size_t i, size_t j, double& err, bool& kink) const {
+        const size_t k = p.k, stride = p.Stride();
+        const DesignResult* q = lattice + k * i * stride + k * j;
+        auto at = [&](size_t a, size_t b) -> const DesignResult& { return q[a * stride + b]; };
+        kink = false;
+        for (size_t a = 0; a <= k; a++) {
+            for (size_t b = 0; b <= k; b++) {
+                if (!at(a, b).converged || !std::isfinite(at(a, b).As2)) return false;
+            }
+        }
+        const uint32_t regime = Regime(at(0, 0));
+        for (size_t a = 0; a <= k; a++) {
+            for (size_t b = 0; b <= k; b++) {
+                if (Regime(at(a, b)) != regime) kink = true;
+            }
+        }
+        if (kink) return false;
+
+        const double c00 = at(0, 0).As2, c0k = at(0, k).As2, ck0 = at(k, 0).As2, ckk = at(k, k).As2;
+        err = 0.0;
+        for (size_t a = 0; a <= k; a++) {
+            const double u = double(a) / double(k);
+            const double lo = c00 + (ck0 - c00) * u, hi = c0k + (ckk - c0k) * u;
+            for (size_t b = 0; b <= k; b++) {
+                const double v = double(b) / double(k);
+                err = std::max(err, std::abs(at(a, b).As2 - (lo + (hi - lo) * v)));
+            }
+        }
+        return err <= 0.5 * tolerance;
+    }
+
+    static bool AnyDesigned(const DesignResult* lattice, const Patch& p, size_t i, size_t j) {
+        const size_t k = p.k, stride = p.Stride();
+        const DesignResult* q = lattice + k * i * stride + k * j;
+        for (size_t a = 0; a <= k; a++) {
+            for (size_t b = 0; b <= k; b++) {
+                if (q[a * stride + b].converged) return true;
+            }
+        }
+        return false;
+    }
+
+    // Block of the cells of a designed patch (rN = rM = res)
+    void AppendBlock(const DesignResult* lattice, const Patch& p) {
+        const size_t res = p.rN, stride = p.Stride();
+        blocks.push_back({ uint32_t(nodes.size()), uint32_t(mask.size()), uint32_t(res) });
+        for (size_t i = 0; i <= res; i++) {
+            for (size_t j = 0; j <= res; j++) {
+                const DesignResult& r = lattice[p.k * (i * stride + j)];
+                nodes.push_back(r.converged && std::isfinite(r.As2) ? r.As2 : 0.0);
+            }
+        }
+        for (size_t i = 0; i < res; i++) {
+            for (size_t j = 0; j < res; j++) {
+                double err = 0.0;
+                bool kink = false;
+                bool ok = CellOk(lattice, p, i, j, err, kink);
+                mask.push_back(ok ? 1 : 0);
+                stats.leafCells++;
+                if (kink) stats.kinkCells++;
+                if (ok) {
+                    stats.validCells++;
+                    stats.maxCheckError = std::max(stats.maxCheckError, err);
+                }
+            }
+        }
+    }
+
+public:
+    /// <summary>
+    /// Default domain: the bounding box of the concrete-only diagram and of the diagram moved by
+    /// the yielded force of maxAs2 (adding As2 moves a point by Fs2 * (1, z2)), i.e. every load
+    /// the section can carry with As2 up to maxAs2
+    /// </summary>
+    template <class Designer>
+    static void DefaultDomain(const Designer& designer, Options& options) {
+        const DiagramView& d = designer.GetDiagram();
+        const SectionGeometry& g = designer.GetGeometry();
+        const double maxAs2 = options.maxAs2 > 0.0 ? options.maxAs2 : 0.04 * g.b * g.h;
+        const double Fs2 = maxAs2 * designer.GetSteel().fyd;
+        const double z2 = g.h / 2.0 - g.d2;
+        options.nMin = options.mMin = HUGE_VAL;
+        options.nMax = options.mMax = -HUGE_VAL;
+        for (size_t i = 0; i < d.Size(); i++) {
+            double N = d.N[i] * 1000.0, M = d.M[i] * 1000.0;  // kN, kNm -> N, Nm
+            options.nMin = std::min(options.nMin, N);
+            options.nMax = std::max(options.nMax, N + Fs2);
+            options.mMin = std::min(options.mMin, M);
+            options.mMax = std::max(options.mMax, M + Fs2 * z2);
+        }
+    }
+
+    /// <summary>
+    /// Grid of the designer's As2 over the domain of options. All designs of the build run as
+    /// DesignBatch calls on the designer's thread pool; its cache, if any, is bypassed so the
+    /// nodes are exact designs. Valid cells lie in one strain regime at their check lattice and
+    /// agree with Design within options.tolerance / 2 there (only there, see the class comment).
+    /// </summary>
+    template <class Designer>
+    static DesignGrid Build(Designer& designer, Options options = Options()) {
+        auto start = std::chrono::steady_clock::now();
+        if (!(options.nMin < options.nMax) || !(options.mMin < options.mMax)) DefaultDomain(designer, options);
+
+        DesignGrid grid;
+        grid.cellsN = std::max(1u, options.cellsN);
+        grid.cellsM = std::max(1u, options.cellsM);
+        grid.tolerance = options.tolerance;
+        grid.yieldStrain = designer.GetSteel().fyd / designer.GetSteel().Es;
+        grid.limitStrain = designer.GetSteel().epsUd;
+        const unsigned k = std::max(2u, options.checkSteps);
+        const double dn = (options.nMax - options.nMin) / double(grid.cellsN);
+        const double dm = (options.mMax - options.mMin) / double(grid.cellsM);
+        grid.n0 = options.nMin;
+        grid.m0 = options.mMin;
+        grid.invDn = 1.0 / dn;
+        grid.invDm = 1.0 / dm;
+        grid.spanN = double(grid.cellsN);
+        grid.spanM = double(grid.cellsM);
+        grid.nLimit = std::nextafter(grid.spanN, 0.0);
+        grid.mLimit = std::nextafter(grid.spanM, 0.0);
+        grid.stats.cells = grid.cellsN * grid.cellsM;
+
+        CacheBypass<Designer> bypass(designer);
+
+        // Coarse lattice: corners and check points of all cells, each designed once
+        const Patch coarse = { options.nMin, options.mMin, dn, dm, unsigned(grid.cellsN), unsigned(grid.cellsM), k };
+        std::vector<DesignLoads> loads;
+        loads.reserve(coarse.Size());
+        AppendLattice(coarse, loads);
+        std::vector<DesignResult> coarseResults(loads.size());
+        designer.DesignBatch(loads.data(), loads.size(), coarseResults.data());
+        grid.stats.designs += loads.size();
+
+        // Cells that miss the tolerance but are designable somewhere get a finer lattice of their own
+        const unsigned refine = std::max(1u, options.refine);
+        std::vector<uint32_t> refinedAt(grid.stats.cells, UINT32_MAX);  // index into refined patches
+        std::vector<Patch> refined;
+        loads.clear();
+        for (size_t i = 0; i < grid.cellsN; i++) {
+            for (size_t j = 0; j < grid.cellsM; j++) {
+                double err;
+                bool kink;
+                if (refine == 1 || grid.CellOk(coarseResults.data(), coarse, i, j, err, kink) ||
+                    !AnyDesigned(coarseResults.data(), coarse, i, j)) {
+                    continue;
+                }
+                refinedAt[i * grid.cellsM + j] = uint32_t(refined.size());
+                refined.push_back({ coarse.n0 + dn * double(i), coarse.m0 + dm * double(j), dn / refine, dm / refine,
+                                    refine, refine, k });
+                AppendLattice(refined.back(), loads);
+            }
+        }
+        std::vector<DesignResult> refinedResults(loads.size());
+        designer.DesignBatch(loads.data(), loads.size(), refinedResults.data());
+        grid.stats.designs += loads.size();
+        grid.stats.refinedCells = refined.size();
+
+        // Blocks in cell order: the coarse cell itself, or its refined patch
+        const size_t patchSize = refined.empty() ? 0 : refined[0].Size();
+        grid.blocks.reserve(grid.stats.cells);
+        grid.nodes.reserve(grid.stats.cells * 4 + refinedResults.size() / 4);
+        const Patch cell = { 0.0, 0.0, dn, dm, 1, 1, k };
+        std::vector<DesignResult> lattice(cell.Size());
+        for (size_t i = 0; i < grid.cellsN; i++) {
+            for (size_t j = 0; j < grid.cellsM; j++) {
+                uint32_t r = refinedAt[i * grid.cellsM + j];
+                if (r != UINT32_MAX) {
+                    grid.AppendBlock(refinedResults.data() + r * patchSize, refined[r]);
+                    continue;
+                }
+                // One-cell patch out of the coarse lattice
+                for (size_t a = 0; a <= k; a++) {
+                    for (size_t b = 0; b <= k; b++) {
+                        lattice[a * (k + 1) + b] = coarseResults[(k * i + a) * coarse.Stride() + k * j + b];
+                    }
+                }
+                grid.AppendBlock(lattice.data(), cell);
+            }
+        }
+
+        grid.stats.memoryBytes = grid.blocks.size() * sizeof(Block) + grid.nodes.size() * sizeof(double) + grid.mask.size();
+        grid.stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return grid;
+    }
+
+    /// <summary>
+    /// As2 [m^2] for N [N], M [Nm] by bilinear interpolation. False (and As2 = 0) outside the
+    /// domain or in an invalid cell.
+    /// </summary>
+    bool Lookup(double N, double M, double& As2) const {
+        double fx = (N - n0) * invDn, fy = (M - m0) * invDm;
+        const bool inside = fx >= 0.0 && fx <= spanN && fy >= 0.0 && fy <= spanM;
+        fx = fx > 0.0 ? fx : 0.0;  // also NaN -> 0
+        fy = fy > 0.0 ? fy : 0.0;
+        fx = fx < nLimit ? fx : nLimit;
+        fy = fy < mLimit ? fy : mLimit;
+        const size_t i = size_t(fx), j = size_t(fy);
+
+        const Block b = blocks[i * cellsM + j];
+        const double sx = (fx - double(i)) * double(b.res), sy = (fy - double(j)) * double(b.res);
+        const size_t ii = std::min<size_t>(size_t(sx), b.res - 1), jj = std::min<size_t>(size_t(sy), b.res - 1);
+        const double u = sx - double(ii), v = sy - double(jj);
+        const size_t stride = size_t(b.res) + 1;
+        const double* p = nodes.data() + b.node + ii * stride + jj;
+        const double a = p[0] + (p[1] - p[0]) * v;
+        const double c = p[stride] + (p[stride + 1] - p[stride]) * v;
+
+        const bool valid = inside & (mask[b.mask + ii * b.res + jj] != 0);
+        As2 = valid ? a + (c - a) * u : 0.0;
+        return valid;
+    }
+
+    // Lookup over load columns (N[i], M[i]) into As2[i] and valid[i] (1 = from the grid);
+    // returns the number of valid cases. Cases with valid[i] = 0 are left to Design.
+    size_t Lookup(const double* N, const double* M, size_t count, double* As2, uint8_t* valid) const {
+        size_t hits = 0;
+        for (size_t i = 0; i < count; i++) {
+            const bool ok = Lookup(N[i], M[i], As2[i]);
+            valid[i] = ok ? 1 : 0;
+            hits += ok ? 1 : 0;
+        }
+        return hits;
+    }
+
+    // Lookup over load cases in rows or columns, e.g. a mapped LoadCaseFile
+    size_t Lookup(const LoadCaseView& loads, double* As2, uint8_t* valid) const {
+        if (loads.IsColumns()) return Lookup(loads.N, loads.M, loads.count, As2, valid);
+        size_t hits = 0;
+        for (size_t i = 0; i < loads.count; i++) {
+            const bool ok = Lookup(loads.rows[i].N, loads.rows[i].M, As2[i]);
+            valid[i] = ok ? 1 : 0;
+            hits += ok ? 1 : 0;
+        }
+        return hits;
+    }
+
+    // Allowed |grid - Design| in valid cells [m^2]
+    double Tolerance() const {
+        return tolerance;
+    }
+
+    const Stats& GetStats() const {
+        return stats;
+    }
+};
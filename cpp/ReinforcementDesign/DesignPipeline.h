@@ -0,0 +1,260 @@
+#pragma once
+#include "MaterialProperties.h"
+#include "ReinforcementDesigner.h"
+#include "LoadCaseStream.h"
+#include "LoadCaseFile.h"
+#include "CsvWriter.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Blocking FIFO with a fixed capacity: Push waits while the queue is full, Pop while it is
+// empty. Close() wakes everybody; Pop then drains what is left and returns false.
+template <typename T>
+class BoundedQueue {
+private:
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<T> items;
+    size_t capacity;
+    bool closed = false;
+
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(std::max<size_t>(1, capacity)) {}
+
+    // False if the queue was closed
+    bool Push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [&] { return closed || items.size() < capacity; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        lock.unlock();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // False once the queue is closed and empty
+    bool Pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [&] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        notFull.notify_one();
+        return true;
+    }
+
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+};
+
+// Streaming batch design: read -> design -> write as three pipeline stages.
+//
+// A fixed set of blocks (loads + results for blockSize cases each) circulates through the
+// stages: the reader thread parses load cases into a free block, the calling thread designs
+// it on the designer's worker pool (DesignBatch), and the writer thread appends its rows to
+// the results CSV and hands the block back. The queues between the stages hold at most
+// `blocks` entries, so a slow stage stalls the others (backpressure) and memory is
+// blocks x blockSize cases whatever the input size. Case order is preserved.
+// Input already in memory (a mapped LoadCaseFile) is not copied: the blocks then only
+// point into it and hold the results.
+class DesignPipeline {
+public:
+    struct Options {
+        size_t blockSize = 65536;  // load cases per block
+        unsigned blocks = 4;       // blocks in flight (3 keep every stage busy)
+        bool compress = false;     // gzip results, see CsvWriter
+    };
+
+    struct Stats {
+        bool ok = false;
+        std::string error;
+        uint64_t cases = 0;
+        uint64_t converged = 0;
+        uint64_t blocks = 0;
+        double seconds = 0.0;
+        double readSeconds = 0.0;    // busy time of each stage (without waiting for the others)
+        double designSeconds = 0.0;
+        double writeSeconds = 0.0;
+        size_t bufferBytes = 0;      // block memory, fixed for the whole run
+    };
+
+private:
+    struct Block {
+        std::vector<DesignLoads> storage;  // parsed load cases (streamed input only)
+        std::vector<DesignResult> results;
+        LoadCaseView loads;                // storage, or a slice of the input in memory
+        uint64_t firstCase = 1;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    static double Seconds(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    template <class Designer, class Fill>
+    static Stats RunBlocks(Designer& designer, const Fill& fill, bool streamed, const std::string& output,
+                           const Options& options) {
+        Stats stats;
+        const size_t blockSize = std::max<size_t>(1, options.blockSize);
+        const unsigned blockCount = std::max(1u, options.blocks);
+
+        CsvWriter out(output, options.compress);
+        if (!out.IsOpen()) {
+            stats.error = "cannot open " + output + " for writing";
+            return stats;
+        }
+        Designer::WriteResultsHeader(out);
+
+        std::vector<Block> storage(blockCount);
+        BoundedQueue<Block*> freeBlocks(blockCount), parsed(blockCount), designed(blockCount);
+        for (Block& b : storage) {
+            if (streamed) b.storage.resize(blockSize);
+            b.results.resize(blockSize);
+            freeBlocks.Push(&b);
+        }
+        stats.bufferBytes = blockCount * blockSize * ((streamed ? sizeof(DesignLoads) : 0) + sizeof(DesignResult));
+
+        std::atomic<bool> writeFailed{ false };
+        Clock::time_point start = Clock::now();
+
+        // Closes the queues and joins both stages on every way out, also when DesignBatch
+        // throws: a stage waiting on a queue wakes up, finishes and is joined before the
+        // blocks and the writer go away
+        std::thread readStage, writeStage;
+        struct StageGuard {
+            BoundedQueue<Block*>* queues[3];
+            std::thread* stages[2];
+
+            void Join() {
+                for (BoundedQueue<Block*>* q : queues) q->Close();
+                for (std::thread* t : stages) {
+                    if (t->joinable()) t->join();
+                }
+            }
+            ~StageGuard() {
+                Join();
+            }
+        } stageGuard{ { &freeBlocks, &parsed, &designed }, { &readStage, &writeStage } };
+
+        readStage = std::thread([&] {
+            uint64_t nextCase = 1;
+            Block* b;
+            while (!writeFailed.load(std::memory_order_relaxed) && freeBlocks.Pop(b)) {
+                Clock::time_point t = Clock::now();
+                bool more = fill(*b, nextCase - 1, blockSize);
+                stats.readSeconds += Seconds(t);
+                if (!more || b->loads.count == 0) break;
+                b->firstCase = nextCase;
+                nextCase += b->loads.count;
+                if (!parsed.Push(b)) break;  // closed: the design stage stopped
+            }
+            parsed.Close();
+        });
+
+        writeStage = std::thread([&] {
+            Block* b;
+            while (designed.Pop(b)) {
+                Clock::time_point t = Clock::now();
+                if (!writeFailed.load(std::memory_order_relaxed)) {
+                    const LoadCaseView& l = b->loads;
+                    if (l.IsColumns()) {
+                        Designer::WriteResultRows(out, l.N, l.M, b->results.data(), l.count, b->firstCase);
+                    } else {
+                        Designer::WriteResultRows(out, l.rows, b->results.data(), l.count, b->firstCase);
+                    }
+                    if (!out.IsOpen()) writeFailed.store(true, std::memory_order_relaxed);
+                }
+                stats.writeSeconds += Seconds(t);
+                freeBlocks.Push(b);  // never blocks: there are only blockCount blocks
+            }
+        });
+
+        Block* b;
+        while (parsed.Pop(b)) {
+            Clock::time_point t = Clock::now();
+            const LoadCaseView& l = b->loads;
+            if (l.IsColumns()) {
+                designer.DesignBatch(l.N, l.M, l.count, b->results.data());
+            } else {
+                designer.DesignBatch(l.rows, l.count, b->results.data());
+            }
+            for (size_t i = 0; i < l.count; i++) {
+                stats.converged += b->results[i].converged ? 1 : 0;
+            }
+            stats.designSeconds += Seconds(t);
+            stats.cases += l.count;
+            stats.blocks++;
+            designed.Push(b);
+        }
+        designed.Close();
+        stageGuard.Join();
+
+        bool closed = out.Close();
+        stats.seconds = Seconds(start);
+        if (writeFailed.load() || !closed) {
+            stats.error = "writing " + output + " failed";
+        }
+        return stats;
+    }
+
+public:
+    /// <summary>
+    /// Design every load case of reader and write the results CSV (same columns as
+    /// ReinforcementDesigner::ExportResultsToCSV) to output. Designer is any
+    /// ReinforcementDesignerT; its thread count and profiler settings apply.
+    /// </summary>
+    /// <returns>Counts, stage times and the error (ok = false) if reading or writing failed</returns>
+    template <class Designer>
+    static Stats Run(Designer& designer, LoadCaseReader& reader, const std::string& output,
+                     const Options& options = Options()) {
+        auto fill = [&](Block& b, uint64_t, size_t blockSize) {
+            b.loads = LoadCaseView();
+            b.loads.rows = b.storage.data();
+            b.loads.count = reader.Read(b.storage.data(), blockSize);
+            return b.loads.count > 0;
+        };
+        Stats stats = RunBlocks(designer, fill, true, output, options);
+        if (reader.Failed()) stats.error = reader.Error();
+        stats.ok = stats.error.empty();
+        return stats;
+    }
+
+    /// <summary>
+    /// Design load cases that are already in memory (e.g. LoadCaseFile::View()), in place:
+    /// blocks are slices of the view, only the results are buffered
+    /// </summary>
+    template <class Designer>
+    static Stats Run(Designer& designer, const LoadCaseView& loads, const std::string& output,
+                     const Options& options = Options()) {
+        auto fill = [&](Block& b, uint64_t done, size_t blockSize) {
+            b.loads = LoadCaseView();
+            b.loads.count = size_t(std::min<uint64_t>(blockSize, loads.count - done));
+            if (loads.IsColumns()) {
+                b.loads.N = loads.N + done;
+                b.loads.M = loads.M + done;
+            } else {
+                b.loads.rows = loads.rows + done;
+            }
+            return b.loads.count > 0;
+        };
+        Stats stats = RunBlocks(designer, fill, false, output, options);
+        stats.ok = stats.error.empty();
+        return stats;
+    }
+};
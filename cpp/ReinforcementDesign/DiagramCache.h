@@ -0,0 +1,202 @@
+#pragma once
+#include "MaterialProperties.h"
+#include "InteractionDiagram.h"
+#include "DiagramFile.h"
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+// Two-tier cache of generated interaction diagrams, keyed by a content hash of everything the
+// diagram depends on (section, materials and their laws, reinforcement, density).
+//
+// - Memory tier: LRU of shared, immutable diagrams (thread-safe).
+// - Disk tier (optional): one DiagramFile per key, "<key>.diag" in the cache directory, mapped
+//   in place on a hit. Files are written to a unique temporary name and renamed into place, so
+//   readers in other threads or processes only ever see complete files; every file carries
+//   its key and a checksum and is regenerated if either does not match.
+class DiagramCache {
+public:
+    // Bump when diagram generation changes, so stale disk entries stop matching
+    static constexpr uint32_t GENERATOR_VERSION = 3;
+
+    struct Stats {
+        uint64_t memoryHits = 0;
+        uint64_t diskHits = 0;
+        uint64_t misses = 0;
+    };
+
+private:
+    using Entry = std::pair<uint64_t, SharedDiagram>;
+
+    size_t capacity;
+    std::filesystem::path directory;  // empty = memory tier only
+
+    mutable std::mutex mutex;
+    std::list<Entry> lru;  // most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    Stats stats;
+
+    template<class ConcreteLaw, class SteelLaw>
+    static uint64_t BaseKey(const SectionGeometry& geom, const ConcreteProperties& concrete,
+                            const SteelProperties& steel, double as1, double as2, Fnv1a& hasher) {
+        hasher.Add(uint64_t(GENERATOR_VERSION));
+        hasher.Add(uint64_t(ConcreteLaw::Id));
+        hasher.Add(uint64_t(SteelLaw::Id));
+        for (double v : { geom.b, geom.h, geom.d1, geom.d2,
+                          concrete.fcd, concrete.epsC2, concrete.epsCu, concrete.n,
+                          steel.fyd, steel.Es, steel.epsUd, steel.k, as1, as2 }) {
+            hasher.Add(v);
+        }
+        return hasher.h;
+    }
+
+    bool FindInMemory(uint64_t key, SharedDiagram& diagram) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) return false;
+        lru.splice(lru.begin(), lru, it->second);
+        stats.memoryHits++;
+        diagram = it->second->second;
+        return true;
+    }
+
+    void InsertInMemory(uint64_t key, const SharedDiagram& diagram) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            return;  // another thread inserted the same diagram meanwhile
+        }
+        lru.emplace_front(key, diagram);
+        index[key] = lru.begin();
+        while (lru.size() > capacity) {
+            index.erase(lru.back().first);
+            lru.pop_back();
+        }
+    }
+
+    std::filesystem::path FilePath(uint64_t key) const {
+        std::ostringstream name;
+        name << std::hex;
+        name.width(16);
+        name.fill('0');
+        name << key;
+        return directory / (name.str() + ".diag");
+    }
+
+    template<class ConcreteLaw, class SteelLaw, typename GenerateFn>
+    SharedDiagram GetOrGenerate(uint64_t key, const SectionGeometry& geom, const ConcreteProperties& concrete,
+                                const SteelProperties& steel, GenerateFn&& generate) {
+        SharedDiagram diagram;
+        if (FindInMemory(key, diagram)) return diagram;
+
+        // Disk tier: map the file in place; the stored key and law Ids guard against hash-named
+        // collisions
+        std::shared_ptr<const DiagramFile> file;
+        if (!directory.empty()) {
+            file = DiagramFile::Open(FilePath(key).string(), true);
+            if (file && (file->Key() != key || file->ConcreteLawId() != ConcreteLaw::Id ||
+                         file->SteelLawId() != SteelLaw::Id)) {
+                file.reset();
+            }
+        }
+
+        if (file) {
+            diagram = DiagramFile::Share(file);
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.diskHits++;
+        } else {
+            auto generated = std::make_shared<const CompactDiagram>(generate());
+            diagram = SharedDiagram::FromCompact(generated);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stats.misses++;
+            }
+            if (!directory.empty()) {
+                std::error_code ec;
+                std::filesystem::create_directories(directory, ec);
+                DiagramFile::Write<ConcreteLaw, SteelLaw>(FilePath(key).string(), diagram.view, geom, concrete, steel, key);
+            }
+        }
+
+        InsertInMemory(key, diagram);
+        return diagram;
+    }
+
+public:
+    // capacity = maximum number of diagrams kept in memory;
+    // cacheDirectory = directory for the disk tier (empty = memory only)
+    explicit DiagramCache(size_t capacity = 16, const std::string& cacheDirectory = "")
+        : capacity(capacity > 0 ? capacity : 1), directory(cacheDirectory) {}
+
+    DiagramCache(const DiagramCache&) = delete;
+    DiagramCache& operator=(const DiagramCache&) = delete;
+
+    // Cache key of a uniformly densified diagram (InteractionDiagramT::GenerateCompact)
+    template<class ConcreteLaw = MaterialLaws::ParabolaRectangle, class SteelLaw = MaterialLaws::BilinearSteel>
+    static uint64_t Key(const SectionGeometry& geom, const ConcreteProperties& concrete,
+                        const SteelProperties& steel, double as1, double as2, int pointsBetween) {
+        Fnv1a hasher;
+        BaseKey<ConcreteLaw, SteelLaw>(geom, concrete, steel, as1, as2, hasher);
+        hasher.Add(uint64_t(1));  // uniform
+        hasher.Add(uint64_t(pointsBetween));
+        return hasher.h;
+    }
+
+    // Cache key of an adaptively densified diagram (InteractionDiagramT::GenerateAdaptiveCompact)
+    template<class ConcreteLaw = MaterialLaws::ParabolaRectangle, class SteelLaw = MaterialLaws::BilinearSteel>
+    static uint64_t Key(const SectionGeometry& geom, const ConcreteProperties& concrete,
+                        const SteelProperties& steel, double as1, double as2,
+                        const AdaptiveDensification& opts) {
+        Fnv1a hasher;
+        BaseKey<ConcreteLaw, SteelLaw>(geom, concrete, steel, as1, as2, hasher);
+        hasher.Add(uint64_t(2));  // adaptive
+        hasher.Add(opts.tolN);
+        hasher.Add(opts.tolM);
+        hasher.Add(uint64_t(opts.maxDepth));
+        hasher.Add(uint64_t(opts.minDepth));
+        return hasher.h;
+    }
+
+    // Diagram for the given inputs and material laws; as1, as2 in [m^2].
+    // Generated only if neither tier has it.
+    template<class ConcreteLaw = MaterialLaws::ParabolaRectangle, class SteelLaw = MaterialLaws::BilinearSteel>
+    SharedDiagram Get(const SectionGeometry& geom, const ConcreteProperties& concrete,
+                      const SteelProperties& steel, double as1, double as2, int pointsBetween = 10) {
+        return GetOrGenerate<ConcreteLaw, SteelLaw>(Key<ConcreteLaw, SteelLaw>(geom, concrete, steel, as1, as2, pointsBetween),
+                             geom, concrete, steel, [&] {
+            return InteractionDiagramT<ConcreteLaw, SteelLaw>(geom, concrete, steel, as1, as2).GenerateCompact(pointsBetween);
+        });
+    }
+
+    template<class ConcreteLaw = MaterialLaws::ParabolaRectangle, class SteelLaw = MaterialLaws::BilinearSteel>
+    SharedDiagram Get(const SectionGeometry& geom, const ConcreteProperties& concrete,
+                      const SteelProperties& steel, double as1, double as2, const AdaptiveDensification& opts) {
+        return GetOrGenerate<ConcreteLaw, SteelLaw>(Key<ConcreteLaw, SteelLaw>(geom, concrete, steel, as1, as2, opts),
+                             geom, concrete, steel, [&] {
+            return InteractionDiagramT<ConcreteLaw, SteelLaw>(geom, concrete, steel, as1, as2).GenerateAdaptiveCompact(opts);
+        });
+    }
+
+    // Drop the memory tier (disk files are kept)
+    void Clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        lru.clear();
+        index.clear();
+    }
+
+    size_t Size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lru.size();
+    }
+
+    Stats GetStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+};
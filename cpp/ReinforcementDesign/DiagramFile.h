@@ -0,0 +1,314 @@
+#pragma once
+#include "MaterialProperties.h"
+#include "InteractionDiagram.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+
+// FNV-1a 64-bit hash, used for diagram file checksums and cache keys
+struct Fnv1a {
+    uint64_t h = 14695981039346656037ull;
+
+    void Bytes(const void* data, size_t size) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    }
+    void Add(double v) {
+        v += 0.0;  // -0.0 and 0.0 hash alike
+        Bytes(&v, sizeof(v));
+    }
+    void Add(uint64_t v) {
+        Bytes(&v, sizeof(v));
+    }
+};
+
+// Binary interaction diagram file: versioned, little-endian, columnar.
+//
+// Layout (all values little-endian):
+//   [0, 320)  header: magic "RCNMDIAG", version, header size, point count, user key,
+//             FNV-1a checksum of everything after the header, section/material parameters
+//             (b, h, d1, d2, fcd, epsC2, epsCu, fyd, Es, epsUd in SI units, As1, As2 in cm^2,
+//             concrete n, steel k), the byte offset of each column,
+//             and the concrete and steel law Ids (MaterialLaws.h) as uint32
+//   columns   epsTop ... Fs2, t as double; kind, segment as uint8; index as uint32;
+//             each column starts on a 64-byte boundary
+//
+// Open() maps the file read-only and exposes the columns in place as a DiagramView, so a
+// diagram library loads without parsing or copying. Write() goes through a temporary file
+// and an atomic rename, so concurrent readers never see a partially written file.
+class DiagramFile {
+public:
+    static constexpr uint32_t VERSION = 3;
+
+private:
+    static constexpr char MAGIC[8] = { 'R', 'C', 'N', 'M', 'D', 'I', 'A', 'G' };
+    static constexpr size_t HEADER_SIZE = 320;
+    static constexpr size_t COLUMN_ALIGN = 64;
+    static constexpr int COLUMN_COUNT = 16;
+    static constexpr int DOUBLE_COLUMNS = 13;
+    static constexpr int PARAM_COUNT = 14;
+
+    // Header field offsets
+    static constexpr size_t OFS_VERSION = 8;
+    static constexpr size_t OFS_HEADER_SIZE = 12;
+    static constexpr size_t OFS_COUNT = 16;
+    static constexpr size_t OFS_KEY = 24;
+    static constexpr size_t OFS_CHECKSUM = 32;
+    static constexpr size_t OFS_PARAMS = 40;
+    static constexpr size_t OFS_COLUMNS = OFS_PARAMS + PARAM_COUNT * sizeof(double);
+    static constexpr size_t OFS_LAWS = OFS_COLUMNS + COLUMN_COUNT * sizeof(uint64_t);
+
+    static constexpr size_t ElementSize(int column) {
+        return column < DOUBLE_COLUMNS ? sizeof(double) : (column == COLUMN_COUNT - 1 ? sizeof(uint32_t) : sizeof(uint8_t));
+    }
+
+    template<typename T>
+    static void StoreLE(char* dst, T value) {
+        std::memcpy(dst, &value, sizeof(T));
+        if (!MappedFile::HostIsLittleEndian()) {
+            std::reverse(dst, dst + sizeof(T));
+        }
+    }
+
+    template<typename T>
+    static T LoadLE(const char* src) {
+        T value;
+        std::memcpy(&value, src, sizeof(T));
+        return value;  // only called on little-endian hosts (see Open)
+    }
+
+    static const void* ColumnData(const DiagramView& d, int column) {
+        const double* doubles[DOUBLE_COLUMNS] = { d.epsTop, d.epsBot, d.epsS1, d.epsS2, d.sigS1, d.sigS2,
+                                                  d.N, d.M, d.Fc, d.Mc, d.Fs1, d.Fs2, d.t };
+        if (column < DOUBLE_COLUMNS) return doubles[column];
+        if (column == DOUBLE_COLUMNS) return d.kind;
+        if (column == DOUBLE_COLUMNS + 1) return d.segment;
+        return d.index;
+    }
+
+    // Mapping of the whole file
+    MappedFile mapping;
+    const char* base = nullptr;  // mapping.Data(), mapping.Size()
+    size_t size = 0;
+
+    DiagramView view;
+    SectionGeometry geom = {};
+    ConcreteProperties concrete = {};
+    SteelProperties steel = {};
+    uint64_t key = 0;
+    uint32_t concreteLawId = 0;
+    uint32_t steelLawId = 0;
+
+    DiagramFile() = default;
+
+    bool Map(const std::string& filename) {
+        if (!mapping.Open(filename) || mapping.Size() == 0) return false;
+        base = mapping.Data();
+        size = mapping.Size();
+        return true;
+    }
+
+    bool Parse(bool verifyChecksum) {
+        if (!MappedFile::HostIsLittleEndian()) return false;  // columns are used in place
+        if (size < HEADER_SIZE || std::memcmp(base, MAGIC, sizeof(MAGIC)) != 0) return false;
+        if (LoadLE<uint32_t>(base + OFS_VERSION) != VERSION) return false;
+
+        size_t headerSize = LoadLE<uint32_t>(base + OFS_HEADER_SIZE);
+        uint64_t count = LoadLE<uint64_t>(base + OFS_COUNT);
+        if (headerSize < HEADER_SIZE || headerSize > size) return false;
+
+        if (verifyChecksum) {
+            Fnv1a checksum;
+            checksum.Bytes(base + headerSize, size - headerSize);
+            if (checksum.h != LoadLE<uint64_t>(base + OFS_CHECKSUM)) return false;
+        }
+
+        const void* columns[COLUMN_COUNT];
+        for (int c = 0; c < COLUMN_COUNT; c++) {
+            uint64_t offset = LoadLE<uint64_t>(base + OFS_COLUMNS + c * sizeof(uint64_t));
+            if (offset < headerSize || offset % ElementSize(c) != 0) return false;
+            if (count > (size - std::min<uint64_t>(offset, size)) / ElementSize(c)) return false;
+            columns[c] = base + offset;
+        }
+
+        double params[PARAM_COUNT];
+        for (int i = 0; i < PARAM_COUNT; i++) {
+            params[i] = LoadLE<double>(base + OFS_PARAMS + i * sizeof(double));
+        }
+        geom = { params[0], params[1], params[2], params[3] };
+        concrete = { params[4], params[5], params[6], params[12] };
+        steel = { params[7], params[8], params[9], params[13] };
+        key = LoadLE<uint64_t>(base + OFS_KEY);
+        concreteLawId = LoadLE<uint32_t>(base + OFS_LAWS);
+        steelLawId = LoadLE<uint32_t>(base + OFS_LAWS + sizeof(uint32_t));
+
+        auto col = [&](int c) { return static_cast<const double*>(columns[c]); };
+        view.count = (size_t)count;
+        view.epsTop = col(0);
+        view.epsBot = col(1);
+        view.epsS1 = col(2);
+        view.epsS2 = col(3);
+        view.sigS1 = col(4);
+        view.sigS2 = col(5);
+        view.N = col(6);
+        view.M = col(7);
+        view.Fc = col(8);
+        view.Mc = col(9);
+        view.Fs1 = col(10);
+        view.Fs2 = col(11);
+        view.t = col(12);
+        view.kind = static_cast<const DiagramPointKind*>(columns[DOUBLE_COLUMNS]);
+        view.segment = static_cast<const uint8_t*>(columns[DOUBLE_COLUMNS + 1]);
+        view.index = static_cast<const uint32_t*>(columns[DOUBLE_COLUMNS + 2]);
+
+        // DiagramView::Name indexes the point names with segment (and segment + 1 for points
+        // between characteristic points), so these are checked even without the checksum
+        for (size_t i = 0; i < view.count; i++) {
+            DiagramPointKind k = view.kind[i];
+            int lastSegment = (k == DiagramPointKind::Characteristic) ? CHARACTERISTIC_POINT_COUNT - 1
+                                                                       : CHARACTERISTIC_POINT_COUNT - 2;
+            if (k > DiagramPointKind::Adaptive || view.segment[i] > lastSegment) return false;
+        }
+        view.As1 = params[10];
+        view.As2 = params[11];
+        return true;
+    }
+
+public:
+    DiagramFile(const DiagramFile&) = delete;
+    DiagramFile& operator=(const DiagramFile&) = delete;
+
+    // Write diagram d of the given section, generated with ConcreteLaw / SteelLaw, to filename.
+    // key is an arbitrary user tag stored in the header (DiagramCache stores its cache key
+    // there). Returns false on I/O failure.
+    template <class ConcreteLaw = MaterialLaws::ParabolaRectangle, class SteelLaw = MaterialLaws::BilinearSteel>
+    static bool Write(const std::string& filename, const DiagramView& d,
+                      const SectionGeometry& geom, const ConcreteProperties& concrete,
+                      const SteelProperties& steel, uint64_t key = 0) {
+        // Column offsets
+        uint64_t offsets[COLUMN_COUNT];
+        size_t end = HEADER_SIZE;
+        for (int c = 0; c < COLUMN_COUNT; c++) {
+            end = (end + COLUMN_ALIGN - 1) / COLUMN_ALIGN * COLUMN_ALIGN;
+            offsets[c] = end;
+            end += d.count * ElementSize(c);
+        }
+
+        std::string buffer(end, '\0');
+        char* out = &buffer[0];
+
+        // Columns
+        for (int c = 0; c < COLUMN_COUNT; c++) {
+            const char* src = static_cast<const char*>(ColumnData(d, c));
+            size_t elem = ElementSize(c);
+            if (d.count == 0) continue;
+            std::memcpy(out + offsets[c], src, d.count * elem);
+            if (!MappedFile::HostIsLittleEndian() && elem > 1) {
+                for (size_t i = 0; i < d.count; i++) {
+                    std::reverse(out + offsets[c] + i * elem, out + offsets[c] + (i + 1) * elem);
+                }
+            }
+        }
+
+        // Header
+        Fnv1a checksum;
+        checksum.Bytes(out + HEADER_SIZE, end - HEADER_SIZE);
+
+        const double params[PARAM_COUNT] = { geom.b, geom.h, geom.d1, geom.d2,
+                                             concrete.fcd, concrete.epsC2, concrete.epsCu,
+                                             steel.fyd, steel.Es, steel.epsUd, d.As1, d.As2,
+                                             concrete.n, steel.k };
+        std::memcpy(out, MAGIC, sizeof(MAGIC));
+        StoreLE<uint32_t>(out + OFS_VERSION, VERSION);
+        StoreLE<uint32_t>(out + OFS_HEADER_SIZE, (uint32_t)HEADER_SIZE);
+        StoreLE<uint64_t>(out + OFS_COUNT, d.count);
+        StoreLE<uint64_t>(out + OFS_KEY, key);
+        StoreLE<uint64_t>(out + OFS_CHECKSUM, checksum.h);
+        for (int i = 0; i < PARAM_COUNT; i++) {
+            StoreLE<double>(out + OFS_PARAMS + i * sizeof(double), params[i]);
+        }
+        for (int c = 0; c < COLUMN_COUNT; c++) {
+            StoreLE<uint64_t>(out + OFS_COLUMNS + c * sizeof(uint64_t), offsets[c]);
+        }
+        StoreLE<uint32_t>(out + OFS_LAWS, ConcreteLaw::Id);
+        StoreLE<uint32_t>(out + OFS_LAWS + sizeof(uint32_t), SteelLaw::Id);
+
+        // Unique temporary name, then atomic rename into place
+        std::random_device rd;
+        std::filesystem::path target(filename);
+        std::filesystem::path temp = target;
+        temp += ".tmp" + std::to_string(rd()) + std::to_string(rd());
+        std::error_code ec;
+        {
+            std::ofstream file(temp, std::ios::binary);
+            if (!file.is_open()) return false;
+            file.write(buffer.data(), (std::streamsize)buffer.size());
+            if (!file) {
+                file.close();
+                std::filesystem::remove(temp, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(temp, target, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    // Map filename read-only. Returns nullptr if the file is missing, truncated, of another
+    // version, has point kinds or segments out of range, or (with verifyChecksum) is corrupted.
+    static std::shared_ptr<const DiagramFile> Open(const std::string& filename, bool verifyChecksum = false) {
+        std::shared_ptr<DiagramFile> file(new DiagramFile());
+        if (!file->Map(filename) || !file->Parse(verifyChecksum)) return nullptr;
+        return file;
+    }
+
+    // Columns in place; valid while the DiagramFile is alive
+    const DiagramView& View() const {
+        return view;
+    }
+
+    // View that keeps the mapping alive, for ReinforcementDesigner and DiagramCache
+    static SharedDiagram Share(const std::shared_ptr<const DiagramFile>& file) {
+        SharedDiagram shared;
+        shared.view = file->view;
+        shared.storage = file;
+        return shared;
+    }
+
+    const SectionGeometry& Geometry() const {
+        return geom;
+    }
+
+    const ConcreteProperties& Concrete() const {
+        return concrete;
+    }
+
+    const SteelProperties& Steel() const {
+        return steel;
+    }
+
+    uint64_t Key() const {
+        return key;
+    }
+
+    // Ids of the laws the diagram was generated with (ConcreteLaw::Id, SteelLaw::Id)
+    uint32_t ConcreteLawId() const {
+        return concreteLawId;
+    }
+
+    uint32_t SteelLawId() const {
+        return steelLawId;
+    }
+};
@@ -3,11 +3,17 @@
 #include "ConcreteIntegration.h"
 #include "ConcreteIntegrationFast.h"  // Use analytical integration
 #include "SteelStress.h"
+#include "CsvWriter.h"
 #include <vector>
 #include <string>
 #include <cmath>
 #include <fstream>
+#include <initializer_list>
+#include <algorithm>
 #include <iostream>
+#include <utility>
+#include <cstdint>
+#include <memory>
 
 // Single point on interaction diagram
 struct DiagramPoint {
@@ -28,26 +34,349 @@ struct DiagramPoint {
     double As2;          // [cm^2] bottom reinforcement area
 };
 
-// Interaction diagram generator
-class InteractionDiagram {
+// Names of the characteristic points P1, P2, P2b, P3 ... P8 in diagram order
+constexpr int CHARACTERISTIC_POINT_COUNT = 9;
+inline constexpr const char* CHARACTERISTIC_POINT_NAMES[CHARACTERISTIC_POINT_COUNT] = {
+    "P1_PureCompression",
+    "P2_Top_epsCu_Bot_epsC2",
+    "P2b_Top_epsCu_Bot_0",
+    "P3_Top_epsCu_S2_yield",
+    "P4_Top_epsCu_S2_ultimate",
+    "P5_Top_epsC2_S2_ultimate",
+    "P6_Top_0_S2_ultimate",
+    "P7_S1_yield_S2_ultimate",
+    "P8_PureTension"
+};
+
+// Origin of a diagram point, used to rebuild its name on export
+enum class DiagramPointKind : uint8_t {
+    Characteristic,  // P1 ... P8
+    Interpolated,    // uniform densification (Generate)
+    Adaptive         // adaptive densification (GenerateAdaptive)
+};
+
+// Read-only view of diagram columns. Points at the storage of a CompactDiagram or of a
+// memory-mapped diagram file (DiagramFile.h); does not own it.
+struct DiagramView {
+    size_t count = 0;
+    const double* epsTop = nullptr;
+    const double* epsBot = nullptr;
+    const double* epsS1 = nullptr;
+    const double* epsS2 = nullptr;
+    const double* sigS1 = nullptr;
+    const double* sigS2 = nullptr;
+    const double* N = nullptr;
+    const double* M = nullptr;
+    const double* Fc = nullptr;
+    const double* Mc = nullptr;
+    const double* Fs1 = nullptr;
+    const double* Fs2 = nullptr;
+    const DiagramPointKind* kind = nullptr;
+    const uint8_t* segment = nullptr;
+    const uint32_t* index = nullptr;
+    const double* t = nullptr;
+    double As1 = 0.0;  // [cm^2]
+    double As2 = 0.0;  // [cm^2]
+
+    size_t Size() const {
+        return count;
+    }
+
+    // Human-readable name, identical to the names DiagramPoint carried before
+    std::string Name(size_t i) const {
+        int seg = segment[i];
+        switch (kind[i]) {
+        case DiagramPointKind::Characteristic:
+            return CHARACTERISTIC_POINT_NAMES[seg];
+        case DiagramPointKind::Interpolated:
+            return std::string("Interp_") + CHARACTERISTIC_POINT_NAMES[seg] + "_to_" +
+                   CHARACTERISTIC_POINT_NAMES[seg + 1] + "_" + std::to_string(index[i]);
+        case DiagramPointKind::Adaptive:
+            return std::string("Adapt_") + CHARACTERISTIC_POINT_NAMES[seg] + "_to_" +
+                   CHARACTERISTIC_POINT_NAMES[seg + 1] + "_" + std::to_string(index[i]);
+        }
+        return std::string();
+    }
+
+    DiagramPoint Point(size_t i) const {
+        DiagramPoint pt;
+        pt.name = Name(i);
+        pt.epsTop = epsTop[i];
+        pt.epsBot = epsBot[i];
+        pt.epsS1 = epsS1[i];
+        pt.epsS2 = epsS2[i];
+        pt.sigS1 = sigS1[i];
+        pt.sigS2 = sigS2[i];
+        pt.N = N[i];
+        pt.M = M[i];
+        pt.Fc = Fc[i];
+        pt.Mc = Mc[i];
+        pt.Fs1 = Fs1[i];
+        pt.Fs2 = Fs2[i];
+        pt.As1 = As1;
+        pt.As2 = As2;
+        return pt;
+    }
+
+    std::vector<DiagramPoint> ToPoints() const {
+        std::vector<DiagramPoint> points;
+        points.reserve(Size());
+        for (size_t i = 0; i < Size(); i++) {
+            points.push_back(Point(i));
+        }
+        return points;
+    }
+};
+
+// Compact structure-of-arrays interaction diagram.
+// One column per DiagramPoint field, so lookups stream only the columns they read (N, M,
+// strains) and generation appends doubles without per-point heap allocations.
+// Names are not stored; Name() rebuilds them from (kind, segment, index) on export.
+struct CompactDiagram {
+    std::vector<double> epsTop, epsBot;   // [per mille]
+    std::vector<double> epsS1, epsS2;     // [per mille]
+    std::vector<double> sigS1, sigS2;     // [MPa]
+    std::vector<double> N, M;             // [kN], [kNm]
+    std::vector<double> Fc, Mc;           // [kN], [kNm]
+    std::vector<double> Fs1, Fs2;         // [kN]
+    std::vector<DiagramPointKind> kind;
+    std::vector<uint8_t> segment;         // characteristic point index, or segment Pi -> Pi+1
+    std::vector<uint32_t> index;          // 1-based index within the segment (densified points)
+    std::vector<double> t;                // strain-line parameter within the segment [0, 1]
+    double As1 = 0.0;                     // [cm^2] top reinforcement area (whole diagram)
+    double As2 = 0.0;                     // [cm^2] bottom reinforcement area (whole diagram)
+
+    size_t Size() const {
+        return N.size();
+    }
+
+    void Reserve(size_t n) {
+        for (auto* col : { &epsTop, &epsBot, &epsS1, &epsS2, &sigS1, &sigS2, &N, &M, &Fc, &Mc, &Fs1, &Fs2, &t }) {
+            col->reserve(n);
+        }
+        kind.reserve(n);
+        segment.reserve(n);
+        index.reserve(n);
+    }
+
+    void Append(const DiagramPoint& pt, DiagramPointKind k, int seg, uint32_t idx, double param) {
+        epsTop.push_back(pt.epsTop);
+        epsBot.push_back(pt.epsBot);
+        epsS1.push_back(pt.epsS1);
+        epsS2.push_back(pt.epsS2);
+        sigS1.push_back(pt.sigS1);
+        sigS2.push_back(pt.sigS2);
+        N.push_back(pt.N);
+        M.push_back(pt.M);
+        Fc.push_back(pt.Fc);
+        Mc.push_back(pt.Mc);
+        Fs1.push_back(pt.Fs1);
+        Fs2.push_back(pt.Fs2);
+        kind.push_back(k);
+        segment.push_back(static_cast<uint8_t>(seg));
+        index.push_back(idx);
+        t.push_back(param);
+    }
+
+    DiagramView View() const {
+        DiagramView v;
+        v.count = Size();
+        v.epsTop = epsTop.data();
+        v.epsBot = epsBot.data();
+        v.epsS1 = epsS1.data();
+        v.epsS2 = epsS2.data();
+        v.sigS1 = sigS1.data();
+        v.sigS2 = sigS2.data();
+        v.N = N.data();
+        v.M = M.data();
+        v.Fc = Fc.data();
+        v.Mc = Mc.data();
+        v.Fs1 = Fs1.data();
+        v.Fs2 = Fs2.data();
+        v.kind = kind.data();
+        v.segment = segment.data();
+        v.index = index.data();
+        v.t = t.data();
+        v.As1 = As1;
+        v.As2 = As2;
+        return v;
+    }
+
+    // Human-readable name, identical to the names DiagramPoint carried before
+    std::string Name(size_t i) const {
+        return View().Name(i);
+    }
+
+    DiagramPoint Point(size_t i) const {
+        return View().Point(i);
+    }
+
+    std::vector<DiagramPoint> ToPoints() const {
+        return View().ToPoints();
+    }
+};
+
+// Diagram columns together with whatever keeps them alive (a CompactDiagram, a mapped file)
+struct SharedDiagram {
+    DiagramView view;
+    std::shared_ptr<const void> storage;
+
+    static SharedDiagram FromCompact(std::shared_ptr<const CompactDiagram> diagram) {
+        SharedDiagram shared;
+        shared.view = diagram->View();
+        shared.storage = std::move(diagram);
+        return shared;
+    }
+};
+
+// Add steel forces for reinforcement areas as1, as2 [m^2] to a point whose strains,
+// steel stresses and concrete forces are already set (fills Fs1, Fs2, N, M, As1, As2)
+inline void ApplyReinforcement(DiagramPoint& pt, const SectionGeometry& geom, double as1, double as2) {
+    // Steel forces
+    pt.Fs1 = as1 * pt.sigS1 * 1e6 / 1000.0;  // kN
+    pt.Fs2 = as2 * pt.sigS2 * 1e6 / 1000.0;  // kN
+
+    // Total forces
+    pt.N = pt.Fc + pt.Fs1 + pt.Fs2;
+
+    // Moments from steel (about centroid)
+    double y1_center = geom.d1 - geom.h / 2.0;  // distance from centroid
+    double y2_center = geom.d2 - geom.h / 2.0;
+    double Ms1 = pt.Fs1 * y1_center;     // kNm (top bar above the centroid)
+    double Ms2 = pt.Fs2 * (-y2_center);  // bottom bar below the centroid
+    pt.M = pt.Mc + Ms1 + Ms2;
+
+    // Reinforcement areas
+    pt.As1 = as1 * 10000.0;  // m^2 to cm^2
+    pt.As2 = as2 * 10000.0;
+}
+
+// Reinforcement-independent form of an interaction diagram.
+// The strain states of Generate() do not depend on As1/As2, and for a fixed strain state
+// N and M are affine in As1 and As2. The basis stores the concrete contribution and the
+// steel stresses per strain state once; a diagram for any reinforcement pair then costs
+// no integrations, only a few multiply-adds per point.
+class DiagramBasis {
 private:
+    SectionGeometry geom;
+    std::vector<DiagramPoint> concretePoints;  // As1 = As2 = 0
+
+    // Per-point contributions of a unit steel area (1 m^2), SoA for MaterializeNM
+    std::vector<double> fc, mc;        // [kN], [kNm]
+    std::vector<double> n1, n2;        // [kN/m^2]
+    std::vector<double> m1, m2;        // [kNm/m^2]
+
+public:
+    DiagramBasis(const SectionGeometry& g, std::vector<DiagramPoint> points)
+        : geom(g), concretePoints(std::move(points)) {
+        size_t n = concretePoints.size();
+        fc.resize(n); mc.resize(n);
+        n1.resize(n); n2.resize(n);
+        m1.resize(n); m2.resize(n);
+
+        double y1_center = geom.d1 - geom.h / 2.0;
+        double y2_center = geom.d2 - geom.h / 2.0;
+        for (size_t i = 0; i < n; i++) {
+            const DiagramPoint& pt = concretePoints[i];
+            fc[i] = pt.Fc;
+            mc[i] = pt.Mc;
+            n1[i] = pt.sigS1 * 1e6 / 1000.0;
+            n2[i] = pt.sigS2 * 1e6 / 1000.0;
+            m1[i] = n1[i] * y1_center;
+            m2[i] = n2[i] * (-y2_center);
+        }
+    }
+
+    size_t Size() const {
+        return concretePoints.size();
+    }
+
+    // The basis itself is the concrete-only diagram
+    const std::vector<DiagramPoint>& ConcreteOnly() const {
+        return concretePoints;
+    }
+
+    // Full diagram for reinforcement as1, as2 [m^2]; bit-identical to
+    // InteractionDiagram(geom, concrete, steel, as1, as2).Generate() with the same density
+    std::vector<DiagramPoint> Materialize(double as1, double as2) const {
+        std::vector<DiagramPoint> points = concretePoints;
+        for (auto& pt : points) {
+            ApplyReinforcement(pt, geom, as1, as2);
+        }
+        return points;
+    }
+
+    // Only N [kN] and M [kNm] for reinforcement as1, as2 [m^2], into arrays of Size() elements.
+    // Intended for optimization loops; equal to Materialize up to rounding.
+    void MaterializeNM(double as1, double as2, double* N, double* M) const {
+        size_t n = concretePoints.size();
+        for (size_t i = 0; i < n; i++) {
+            N[i] = fc[i] + as1 * n1[i] + as2 * n2[i];
+            M[i] = mc[i] + as1 * m1[i] + as2 * m2[i];
+        }
+    }
+};
+
+// Options for InteractionDiagram::GenerateAdaptive
+struct AdaptiveDensification {
+    double tolN = 1.0;     // [kN] chord error tolerance in N
+    double tolM = 0.5;     // [kNm] chord error tolerance in M
+    int maxDepth = 8;      // max bisection depth per segment (at most 2^maxDepth - 1 interior points)
+    int minDepth = 1;      // always bisect this deep, so a curved segment with a flat chord is not missed
+};
+
+// Interaction diagram generator, templated on the concrete and steel laws (MaterialLaws.h).
+// InteractionDiagram is the EC2 parabola-rectangle / bilinear steel instance.
+template <class ConcreteLaw = MaterialLaws::ParabolaRectangle, class SteelLaw = MaterialLaws::BilinearSteel>
+class InteractionDiagramT {
+private:
+    static constexpr const char* CSV_HEADER =
+        "Name,epsTop[o/oo],epsBot[o/oo],epsS1[o/oo],epsS2[o/oo],"
+        "sigS1[MPa],sigS2[MPa],N[kN],M[kNm],Fc[kN],Mc[kNm],"
+        "Fs1[kN],Fs2[kN],As1[cm^2],As2[cm^2]\n";
+
+    // Name followed by the numeric columns, shortest round-trip formatting
+    static void WriteCSVRow(CsvWriter& out, const std::string& name, std::initializer_list<double> values) {
+        out.Text(name);
+        for (double v : values) {
+            out.Char(',');
+            out.Number(v);
+        }
+        out.Char('\n');
+    }
+
+    static void FinishCSV(CsvWriter& out, const std::string& filename, size_t count) {
+        if (!out.Close()) {
+            std::cerr << "Error: Writing " << filename << " failed\n";
+            return;
+        }
+        std::cout << "Diagram exported to: " << filename << "\n";
+        std::cout << "Total points: " << count << "\n";
+    }
+
     SectionGeometry geom;
     ConcreteProperties concrete;
     SteelProperties steel;
+    ConcreteLaw concreteLaw;  // built once from concrete
+    SteelLaw steelLaw;        // built once from steel
     double As1_input;  // [m^2] top reinforcement (for diagram with reinforcement)
     double As2_input;  // [m^2] bottom reinforcement (for diagram with reinforcement)
 
+    // Bar layers / individual bars (see the ReinforcementBar constructor), split at the centroid
+    SteelLayout layersTop;     // reported as Fs1 / As1
+    SteelLayout layersBottom;  // reported as Fs2 / As2
+
     // Calculate single point given strain distribution parameters
     // Using strain model: eps(y) = k*y + q, where y is from bottom (y=0 at bottom, y=h at top)
-    DiagramPoint CalculatePoint(const std::string& name, double epsTop, double epsBot) {
+    // (name is left empty; see CompactDiagram::Name)
+    DiagramPoint CalculatePoint(double epsTop, double epsBot) {
         DiagramPoint pt;
-        pt.name = name;
         pt.epsTop = epsTop * 1000.0;  // convert to per mille
         pt.epsBot = epsBot * 1000.0;
 
         // Concrete forces - USE FAST ANALYTICAL METHOD
         ConcreteForces cf = ConcreteIntegrationFast::CalculateForce(
-            epsTop, epsBot, geom.b, geom.h, concrete
+            epsTop, epsBot, geom.b, geom.h, concreteLaw
         );
         pt.Fc = cf.Fc / 1000.0;  // N to kN
         pt.Mc = cf.Mc / 1000.0;  // Nm to kNm
@@ -62,110 +391,80 @@ private:
         // Stress in reinforcement
         double epsS1_abs = pt.epsS1 / 1000.0;
         double epsS2_abs = pt.epsS2 / 1000.0;
-        pt.sigS1 = SteelStress::CalculateStress(epsS1_abs, steel) / 1e6;  // Pa to MPa
-        pt.sigS2 = SteelStress::CalculateStress(epsS2_abs, steel) / 1e6;
-
-        // Steel forces
-        pt.Fs1 = As1_input * pt.sigS1 * 1e6 / 1000.0;  // kN
-        pt.Fs2 = As2_input * pt.sigS2 * 1e6 / 1000.0;  // kN
-
-        // Total forces
-        pt.N = pt.Fc + pt.Fs1 + pt.Fs2;
-
-        // Moments from steel (about centroid)
-        double y1_center = geom.d1 - geom.h / 2.0;  // distance from centroid
-        double y2_center = geom.d2 - geom.h / 2.0;
-        double Ms1 = pt.Fs1 * (-y1_center);  // kNm
-        double Ms2 = pt.Fs2 * (-y2_center);
-        pt.M = pt.Mc + Ms1 + Ms2;
-
-        // Reinforcement areas
-        pt.As1 = As1_input * 10000.0;  // m^2 to cm^2
-        pt.As2 = As2_input * 10000.0;
+        pt.sigS1 = steelLaw.Stress(epsS1_abs) / 1e6;  // Pa to MPa
+        pt.sigS2 = steelLaw.Stress(epsS2_abs) / 1e6;
+
+        ApplyReinforcement(pt, geom, As1_input, As2_input);
+
+        // Bar layers: one SoA pass per group
+        if (layersTop.Size() + layersBottom.Size() > 0) {
+            double k = (epsTop - epsBot) / geom.h;
+            double q = 0.5 * (epsTop + epsBot);
+            SteelForces top = SteelStress::LayoutForces(layersTop, k, q, steelLaw);
+            SteelForces bottom = SteelStress::LayoutForces(layersBottom, k, q, steelLaw);
+            pt.Fs1 += top.Fs / 1000.0;  // N to kN
+            pt.Fs2 += bottom.Fs / 1000.0;
+            pt.N += (top.Fs + bottom.Fs) / 1000.0;
+            pt.M -= (top.Ms + bottom.Ms) / 1000.0;  // local Σ F·y, negated as Mc
+            pt.As1 = (As1_input + layersTop.TotalArea()) * 10000.0;
+            pt.As2 = (As2_input + layersBottom.TotalArea()) * 10000.0;
+        }
 
         return pt;
     }
 
-    // Linear interpolation between two points
-    std::vector<DiagramPoint> InterpolateBetween(const DiagramPoint& p1, const DiagramPoint& p2, int numPoints) {
-        std::vector<DiagramPoint> points;
-
-        for (int i = 1; i < numPoints; i++) {
-            double t = static_cast<double>(i) / numPoints;
-
-            // Interpolate strain values
-            double epsTop = p1.epsTop / 1000.0 + t * (p2.epsTop / 1000.0 - p1.epsTop / 1000.0);
-            double epsBot = p1.epsBot / 1000.0 + t * (p2.epsBot / 1000.0 - p1.epsBot / 1000.0);
-
-            std::string interpName = "Interp_" + p1.name + "_to_" + p2.name + "_" + std::to_string(i);
-            points.push_back(CalculatePoint(interpName, epsTop, epsBot));
-        }
-
-        return points;
+    // Strains at parameter t on the strain line between p1 and p2 (absolute, not per mille)
+    static void StrainsAt(const DiagramPoint& p1, const DiagramPoint& p2, double t, double& epsTop, double& epsBot) {
+        epsTop = p1.epsTop / 1000.0 + t * (p2.epsTop / 1000.0 - p1.epsTop / 1000.0);
+        epsBot = p1.epsBot / 1000.0 + t * (p2.epsBot / 1000.0 - p1.epsBot / 1000.0);
     }
 
-public:
-    InteractionDiagram(const SectionGeometry& g, const ConcreteProperties& c,
-                      const SteelProperties& s, double as1 = 0.0, double as2 = 0.0)
-        : geom(g), concrete(c), steel(s), As1_input(as1), As2_input(as2) {}
-
-    // Generate interaction diagram with characteristic points and densification
-    std::vector<DiagramPoint> Generate(int pointsBetween = 10) {
-        std::vector<DiagramPoint> allPoints;
+    // Characteristic points P1, P2, P2b, P3 ... P8 in diagram order
+    std::vector<DiagramPoint> CharacteristicPoints() {
+        std::vector<DiagramPoint> points;
+        points.reserve(9);
 
         // Calculate yield strain
-        double epsYd = steel.fyd / steel.Es;
-        double epsCu = concrete.epsCu;
-        double epsC2 = concrete.epsC2;
-        double epsUd = steel.epsUd;
+        double epsYd = steelLaw.EpsY();
+        double epsCu = concreteLaw.EpsCu();
+        double epsC2 = concreteLaw.EpsC2();
+        double epsUd = steelLaw.EpsUd();
 
         // CHARACTERISTIC POINTS (following C# implementation)
 
         // POINT 1: Pure compression (epsTop = epsBottom = epsCu)
-        DiagramPoint p1 = CalculatePoint("P1_PureCompression", epsCu, epsCu);
-        allPoints.push_back(p1);
+        DiagramPoint p1 = CalculatePoint(epsCu, epsCu);
+        points.push_back(p1);
 
         // POINT 2: Top = epsCu, Bottom = epsC2
-        DiagramPoint p2 = CalculatePoint("P2_Top_epsCu_Bot_epsC2", epsCu, epsC2);
-        auto interp12 = InterpolateBetween(p1, p2, pointsBetween);
-        allPoints.insert(allPoints.end(), interp12.begin(), interp12.end());
-        allPoints.push_back(p2);
+        DiagramPoint p2 = CalculatePoint(epsCu, epsC2);
+        points.push_back(p2);
 
         // POINT 2b: Top = epsCu, Bottom = 0
-        DiagramPoint p2b = CalculatePoint("P2b_Top_epsCu_Bot_0", epsCu, 0.0);
-        auto interp2_2b = InterpolateBetween(p2, p2b, pointsBetween);
-        allPoints.insert(allPoints.end(), interp2_2b.begin(), interp2_2b.end());
-        allPoints.push_back(p2b);
+        DiagramPoint p2b = CalculatePoint(epsCu, 0.0);
+        points.push_back(p2b);
 
         // POINT 3: Top = epsCu, Bottom steel yields (epsS2 = epsYd)
         // Calculate epsBot such that epsS2 = epsYd
         double y2_from_top = geom.h - geom.d2;
         double epsBot_p3 = epsYd - (epsYd - epsCu) * (geom.h - y2_from_top) / y2_from_top;
-        DiagramPoint p3 = CalculatePoint("P3_Top_epsCu_S2_yield", epsCu, epsBot_p3);
-        auto interp2b_3 = InterpolateBetween(p2b, p3, pointsBetween);
-        allPoints.insert(allPoints.end(), interp2b_3.begin(), interp2b_3.end());
-        allPoints.push_back(p3);
+        DiagramPoint p3 = CalculatePoint(epsCu, epsBot_p3);
+        points.push_back(p3);
 
         // POINT 4: Top = epsCu, Bottom steel ultimate (epsS2 = epsUd)
         double epsBot_p4 = epsUd - (epsUd - epsCu) * (geom.h - y2_from_top) / y2_from_top;
-        DiagramPoint p4 = CalculatePoint("P4_Top_epsCu_S2_ultimate", epsCu, epsBot_p4);
-        auto interp3_4 = InterpolateBetween(p3, p4, pointsBetween);
-        allPoints.insert(allPoints.end(), interp3_4.begin(), interp3_4.end());
-        allPoints.push_back(p4);
+        DiagramPoint p4 = CalculatePoint(epsCu, epsBot_p4);
+        points.push_back(p4);
 
         // POINT 5: Top = epsC2, Bottom steel ultimate (epsS2 = epsUd)
         double epsBot_p5 = epsUd - (epsUd - epsC2) * (geom.h - y2_from_top) / y2_from_top;
-        DiagramPoint p5 = CalculatePoint("P5_Top_epsC2_S2_ultimate", epsC2, epsBot_p5);
-        auto interp4_5 = InterpolateBetween(p4, p5, pointsBetween);
-        allPoints.insert(allPoints.end(), interp4_5.begin(), interp4_5.end());
-        allPoints.push_back(p5);
+        DiagramPoint p5 = CalculatePoint(epsC2, epsBot_p5);
+        points.push_back(p5);
 
         // POINT 6: Top = 0, Bottom steel ultimate (epsS2 = epsUd)
         double epsBot_p6 = epsUd - (epsUd - 0.0) * (geom.h - y2_from_top) / y2_from_top;
-        DiagramPoint p6 = CalculatePoint("P6_Top_0_S2_ultimate", 0.0, epsBot_p6);
-        auto interp5_6 = InterpolateBetween(p5, p6, pointsBetween);
-        allPoints.insert(allPoints.end(), interp5_6.begin(), interp5_6.end());
-        allPoints.push_back(p6);
+        DiagramPoint p6 = CalculatePoint(0.0, epsBot_p6);
+        points.push_back(p6);
 
         // POINT 7: Both reinforcement layers yield/ultimate
         // Top steel yields (epsS1 = epsYd), Bottom steel ultimate (epsS2 = epsUd)
@@ -173,47 +472,192 @@ public:
         double k_p7 = (epsYd - epsUd) / (y1_from_top - y2_from_top);
         double epsTop_p7 = epsYd - k_p7 * y1_from_top;
         double epsBot_p7 = epsTop_p7 + k_p7 * geom.h;
-        DiagramPoint p7 = CalculatePoint("P7_S1_yield_S2_ultimate", epsTop_p7, epsBot_p7);
-        auto interp6_7 = InterpolateBetween(p6, p7, pointsBetween);
-        allPoints.insert(allPoints.end(), interp6_7.begin(), interp6_7.end());
-        allPoints.push_back(p7);
+        DiagramPoint p7 = CalculatePoint(epsTop_p7, epsBot_p7);
+        points.push_back(p7);
 
         // POINT 8: Pure tension (epsTop = epsBottom = epsUd)
-        DiagramPoint p8 = CalculatePoint("P8_PureTension", epsUd, epsUd);
-        auto interp7_8 = InterpolateBetween(p7, p8, pointsBetween);
-        allPoints.insert(allPoints.end(), interp7_8.begin(), interp7_8.end());
-        allPoints.push_back(p8);
+        DiagramPoint p8 = CalculatePoint(epsUd, epsUd);
+        points.push_back(p8);
+
+        for (int i = 0; i < CHARACTERISTIC_POINT_COUNT; i++) {
+            points[i].name = CHARACTERISTIC_POINT_NAMES[i];
+        }
+
+        return points;
+    }
 
-        return allPoints;
+    // Chord error of mid against segment a-b in (N/tolN, M/tolM) space; <= 1 means within tolerance
+    static double ChordError(const DiagramPoint& a, const DiagramPoint& mid, const DiagramPoint& b,
+                             const AdaptiveDensification& opts) {
+        double ax = a.N / opts.tolN, ay = a.M / opts.tolM;
+        double bx = b.N / opts.tolN, by = b.M / opts.tolM;
+        double mx = mid.N / opts.tolN, my = mid.M / opts.tolM;
+
+        double dx = bx - ax, dy = by - ay;
+        double len2 = dx * dx + dy * dy;
+        double s = (len2 > 0.0) ? std::max(0.0, std::min(1.0, ((mx - ax) * dx + (my - ay) * dy) / len2)) : 0.0;
+        double ex = mx - (ax + s * dx);
+        double ey = my - (ay + s * dy);
+        return std::sqrt(ex * ex + ey * ey);
     }
 
-    // Export diagram to CSV file
-    static void ExportToCSV(const std::vector<DiagramPoint>& points, const std::string& filename) {
-        std::ofstream file(filename);
-        if (!file.is_open()) {
+    // Recursive bisection of the strain line of segment seg (p1 -> p2) on [ta, tb].
+    // Appends accepted interior points in order, numbering them with counter.
+    void RefineBetween(const DiagramPoint& p1, const DiagramPoint& p2, int seg,
+                       double ta, double tb, const DiagramPoint& a, const DiagramPoint& b,
+                       int depth, const AdaptiveDensification& opts,
+                       CompactDiagram& out, uint32_t& counter) {
+        if (depth >= opts.maxDepth) return;
+
+        double t = 0.5 * (ta + tb);
+        double epsTop, epsBot;
+        StrainsAt(p1, p2, t, epsTop, epsBot);
+        DiagramPoint mid = CalculatePoint(epsTop, epsBot);
+
+        if (depth >= opts.minDepth && ChordError(a, mid, b, opts) <= 1.0) return;
+
+        RefineBetween(p1, p2, seg, ta, t, a, mid, depth + 1, opts, out, counter);
+        out.Append(mid, DiagramPointKind::Adaptive, seg, ++counter, t);
+        RefineBetween(p1, p2, seg, t, tb, mid, b, depth + 1, opts, out, counter);
+    }
+
+public:
+    InteractionDiagramT(const SectionGeometry& g, const ConcreteProperties& c,
+                       const SteelProperties& s, double as1 = 0.0, double as2 = 0.0)
+        : geom(g), concrete(c), steel(s), concreteLaw(c), steelLaw(s), As1_input(as1), As2_input(as2) {}
+
+    // Diagram for any number of bar layers or individual bars (positions from the bottom-left
+    // corner, see ReinforcementBar). The outermost bars replace d1 / d2 for the characteristic
+    // points and epsS1 / epsS2; Fs1 / As1 sum the bars above the centroid, Fs2 / As2 those below.
+    // A side without bars keeps the d1 / d2 of the geometry, and the two fibers are kept 0.1·h
+    // apart (as InteractionSurface), so P7 stays finite for a single bar layer.
+    InteractionDiagramT(const SectionGeometry& g, const ConcreteProperties& c,
+                       const SteelProperties& s, const std::vector<ReinforcementBar>& bars)
+        : geom(g), concrete(c), steel(s), concreteLaw(c), steelLaw(s), As1_input(0.0), As2_input(0.0) {
+        if (bars.empty()) return;
+        double yMin = geom.h, yMax = 0.0;
+        for (const ReinforcementBar& bar : bars) {
+            bool top = bar.y > geom.h / 2.0;
+            if (top) yMax = std::max(yMax, bar.y);
+            else yMin = std::min(yMin, bar.y);
+            SteelLayout& group = top ? layersTop : layersBottom;
+            group.Add(bar.y - geom.h / 2.0, bar.area, bar.x - geom.b / 2.0);
+        }
+        if (layersTop.Size() > 0) geom.d1 = geom.h - yMax;
+        if (layersBottom.Size() > 0) geom.d2 = yMin;
+        geom.d2 = std::min(geom.d2, 0.9 * geom.h);
+        geom.d1 = std::min(geom.d1, geom.h - geom.d2 - 0.1 * geom.h);
+    }
+
+    // Generate interaction diagram with characteristic points and densification
+    std::vector<DiagramPoint> Generate(int pointsBetween = 10) {
+        return GenerateCompact(pointsBetween).ToPoints();
+    }
+
+    // Generate into compact SoA storage (no per-point names or allocations)
+    CompactDiagram GenerateCompact(int pointsBetween = 10) {
+        std::vector<DiagramPoint> characteristic = CharacteristicPoints();
+
+        CompactDiagram out;
+        out.As1 = (As1_input + layersTop.TotalArea()) * 10000.0;  // m^2 to cm^2
+        out.As2 = (As2_input + layersBottom.TotalArea()) * 10000.0;
+        out.Reserve(characteristic.size() + (characteristic.size() - 1) * std::max(0, pointsBetween - 1));
+        out.Append(characteristic[0], DiagramPointKind::Characteristic, 0, 0, 0.0);
+
+        for (int seg = 0; seg + 1 < (int)characteristic.size(); seg++) {
+            const DiagramPoint& p1 = characteristic[seg];
+            const DiagramPoint& p2 = characteristic[seg + 1];
+
+            // Linear interpolation of strains between characteristic points
+            for (int i = 1; i < pointsBetween; i++) {
+                double t = static_cast<double>(i) / pointsBetween;
+                double epsTop, epsBot;
+                StrainsAt(p1, p2, t, epsTop, epsBot);
+                out.Append(CalculatePoint(epsTop, epsBot), DiagramPointKind::Interpolated, seg, i, t);
+            }
+
+            out.Append(p2, DiagramPointKind::Characteristic, seg + 1, 0, 0.0);
+        }
+
+        return out;
+    }
+
+    // Generate interaction diagram with adaptive densification: each segment between
+    // characteristic points is bisected in strain space until the chord error in (N, M)
+    // meets the tolerance, so nearly straight segments get few points and the curved
+    // region around P2-P4 gets more
+    std::vector<DiagramPoint> GenerateAdaptive(const AdaptiveDensification& opts = AdaptiveDensification()) {
+        return GenerateAdaptiveCompact(opts).ToPoints();
+    }
+
+    CompactDiagram GenerateAdaptiveCompact(const AdaptiveDensification& opts = AdaptiveDensification()) {
+        std::vector<DiagramPoint> characteristic = CharacteristicPoints();
+
+        CompactDiagram out;
+        out.As1 = (As1_input + layersTop.TotalArea()) * 10000.0;
+        out.As2 = (As2_input + layersBottom.TotalArea()) * 10000.0;
+        out.Append(characteristic[0], DiagramPointKind::Characteristic, 0, 0, 0.0);
+
+        for (int seg = 0; seg + 1 < (int)characteristic.size(); seg++) {
+            const DiagramPoint& p1 = characteristic[seg];
+            const DiagramPoint& p2 = characteristic[seg + 1];
+
+            uint32_t counter = 0;
+            RefineBetween(p1, p2, seg, 0.0, 1.0, p1, p2, 0, opts, out, counter);
+            out.Append(p2, DiagramPointKind::Characteristic, seg + 1, 0, 0.0);
+        }
+
+        return out;
+    }
+
+    // Generate the reinforcement-independent basis (As1_input / As2_input and bar layers are ignored).
+    // Use DiagramBasis::Materialize to obtain diagrams for any reinforcement pair.
+    DiagramBasis GenerateBasis(int pointsBetween = 10) const {
+        InteractionDiagramT concreteOnly(geom, concrete, steel, 0.0, 0.0);
+        return DiagramBasis(geom, concreteOnly.Generate(pointsBetween));
+    }
+
+    // Export diagram to CSV file (compress = gzip, see CsvWriter)
+    static void ExportToCSV(const std::vector<DiagramPoint>& points, const std::string& filename, bool compress = false) {
+        CsvWriter out(filename, compress);
+        if (!out.IsOpen()) {
             std::cerr << "Error: Could not open file " << filename << " for writing\n";
             return;
         }
 
         // Header
-        file << "Name,epsTop[o/oo],epsBot[o/oo],epsS1[o/oo],epsS2[o/oo],"
-             << "sigS1[MPa],sigS2[MPa],N[kN],M[kNm],Fc[kN],Mc[kNm],"
-             << "Fs1[kN],Fs2[kN],As1[cm^2],As2[cm^2]\n";
+        out.Text(CSV_HEADER);
 
         // Data rows
         for (const auto& pt : points) {
-            file << pt.name << ","
-                 << pt.epsTop << "," << pt.epsBot << ","
-                 << pt.epsS1 << "," << pt.epsS2 << ","
-                 << pt.sigS1 << "," << pt.sigS2 << ","
-                 << pt.N << "," << pt.M << ","
-                 << pt.Fc << "," << pt.Mc << ","
-                 << pt.Fs1 << "," << pt.Fs2 << ","
-                 << pt.As1 << "," << pt.As2 << "\n";
+            WriteCSVRow(out, pt.name, { pt.epsTop, pt.epsBot, pt.epsS1, pt.epsS2, pt.sigS1, pt.sigS2,
+                                        pt.N, pt.M, pt.Fc, pt.Mc, pt.Fs1, pt.Fs2, pt.As1, pt.As2 });
         }
 
-        file.close();
-        std::cout << "Diagram exported to: " << filename << "\n";
-        std::cout << "Total points: " << points.size() << "\n";
+        FinishCSV(out, filename, points.size());
+    }
+
+    // Export compact diagram to CSV file (same format; names are generated here)
+    static void ExportToCSV(const CompactDiagram& d, const std::string& filename, bool compress = false) {
+        ExportToCSV(d.View(), filename, compress);
+    }
+
+    static void ExportToCSV(const DiagramView& d, const std::string& filename, bool compress = false) {
+        CsvWriter out(filename, compress);
+        if (!out.IsOpen()) {
+            std::cerr << "Error: Could not open file " << filename << " for writing\n";
+            return;
+        }
+
+        out.Text(CSV_HEADER);
+
+        for (size_t i = 0; i < d.Size(); i++) {
+            WriteCSVRow(out, d.Name(i), { d.epsTop[i], d.epsBot[i], d.epsS1[i], d.epsS2[i], d.sigS1[i], d.sigS2[i],
+                                          d.N[i], d.M[i], d.Fc[i], d.Mc[i], d.Fs1[i], d.Fs2[i], d.As1, d.As2 });
+        }
+
+        FinishCSV(out, filename, d.Size());
     }
 };
+
+using InteractionDiagram = InteractionDiagramT<>;
@@ -0,0 +1,467 @@
+#pragma once
+#include "MaterialProperties.h"
+#include "ConcreteIntegrationPolygon.h"
+#include "SteelStress.h"
+#include "WorkStealingPool.h"
+#include "CsvWriter.h"
+#include "PerformanceTimer.h"
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <algorithm>
+#include <iostream>
+
+// N-My-Mz interaction surface for biaxial bending.
+//
+// A meridian fixes the direction of the neutral axis: the section is rotated by theta so that the
+// fiber direction (sin theta, cos theta) points up, and the strain states of the uniaxial diagram
+// (P1 ... P8 with densification, see InteractionDiagram) are applied in that frame. Meridians are
+// independent and are generated in parallel. Neighbouring meridians are joined into a closed
+// triangle mesh whose two poles are the pure compression and pure tension states.
+//
+// Sign convention (My plays the role of M in the uniaxial diagram):
+//   N  [kN]  + tension
+//   My [kNm] + compression at the top (+y) fiber
+//   Mz [kNm] + compression at the +x fiber
+//
+// Templated on the material laws like InteractionDiagramT; the concrete law must be polynomial
+// (see ConcreteIntegrationPolygon). InteractionSurface is the default instance.
+template <class ConcreteLaw = MaterialLaws::ParabolaRectangle, class SteelLaw = MaterialLaws::BilinearSteel>
+class InteractionSurfaceT {
+public:
+    // Triangle of vertex indices, counter-clockwise seen from outside
+    struct Triangle {
+        uint32_t a, b, c;
+    };
+
+private:
+    // Direction index: triangles binned by the azimuth (in the My-Mz plane) and elevation (towards N)
+    // they cover, seen from the origin in normalized (My/scaleM, Mz/scaleM, N/scaleN) space
+    static constexpr int AZIMUTH_BINS = 64;
+    static constexpr int ELEVATION_BINS = 32;
+
+    PolygonSection section;
+    SteelLayout steelLayout;  // bars relative to the centroid
+    ConcreteLaw concreteLaw;
+    SteelLaw steelLaw;
+
+    // Vertices (SoA): 0 = pure compression, 1 = pure tension, then the meridians without their poles
+    std::vector<double> vN, vMy, vMz;
+    std::vector<Triangle> triangles;
+    std::vector<double> thetas;  // [rad] meridian angles
+    int pointsPerMeridian = 0;   // including both poles
+    PerformanceTimer* profiler = nullptr;  // "Meridian" / "Mesh" scopes in Generate (optional)
+
+    double scaleN = 1.0, scaleM = 1.0;
+    std::vector<uint32_t> cellStart;      // CSR offsets per cell, AZIMUTH_BINS * ELEVATION_BINS + 1
+    std::vector<uint32_t> cellTriangles;
+
+    // N, My, Mz of the strain states of one meridian, in diagram order
+    void GenerateMeridian(double theta, int pointsBetween, double* N, double* My, double* Mz) const {
+        PolygonSection rotated = section.Rotated(theta);
+        double c = std::cos(theta), s = std::sin(theta);
+        double vTop = rotated.Top(), vBot = rotated.Bottom(), ht = vTop - vBot;
+
+        // Height of the outermost bars in the rotated frame (extreme fibers without bars)
+        double vS1 = vTop, vS2 = vBot;
+        for (size_t i = 0; i < steelLayout.Size(); i++) {
+            double v = steelLayout.X(i) * s + steelLayout.Y(i) * c;
+            vS1 = (i == 0) ? v : std::max(vS1, v);
+            vS2 = (i == 0) ? v : std::min(vS2, v);
+        }
+
+        // Depths of the outer bars below the top fiber. For directions where all bars sit near the
+        // compressed edge they are kept apart, so the strain limits below stay finite.
+        double y2_from_top = std::max(vTop - vS2, 0.1 * ht);
+        double y1_from_top = std::min(vTop - vS1, y2_from_top - 0.1 * ht);
+
+        // Characteristic strains (as InteractionDiagram::CharacteristicPoints)
+        double epsYd = steelLaw.EpsY();
+        double epsCu = concreteLaw.EpsCu();
+        double epsC2 = concreteLaw.EpsC2();
+        double epsUd = steelLaw.EpsUd();
+        double r2 = (ht - y2_from_top) / y2_from_top;
+        double k7 = (epsYd - epsUd) / (y1_from_top - y2_from_top);
+        double epsTop7 = epsYd - k7 * y1_from_top;
+        const double top[9] = { epsCu, epsCu, epsCu, epsCu, epsCu, epsC2, 0.0, epsTop7, epsUd };
+        const double bot[9] = { epsCu, epsC2, 0.0,
+                                epsYd - (epsYd - epsCu) * r2,
+                                epsUd - (epsUd - epsCu) * r2,
+                                epsUd - (epsUd - epsC2) * r2,
+                                epsUd - epsUd * r2,
+                                epsTop7 + k7 * ht,
+                                epsUd };
+
+        size_t idx = 0;
+        auto point = [&](double epsTop, double epsBot) {
+            double k = (epsTop - epsBot) / ht;
+            double q = epsBot - k * vBot;
+            BiaxialConcreteForces cf = ConcreteIntegrationPolygon::PolygonConcreteNMM(rotated, k, q, concreteLaw);
+
+            // First moments back in section axes: x = u·cos + v·sin, y = -u·sin + v·cos
+            double n = cf.Fc;
+            double sx = cf.McX * c + cf.Mc * s;
+            double sy = -cf.McX * s + cf.Mc * c;
+            // Bars in section axes: ε = k·v + q with v = x·sin + y·cos
+            SteelForces sf = SteelStress::LayoutForces(steelLayout, k * c, q, steelLaw, k * s);
+            n += sf.Fs;
+            sx += sf.MsX;
+            sy += sf.Ms;
+            N[idx] = n / 1000.0;     // N to kN
+            My[idx] = -sy / 1000.0;  // Nm to kNm
+            Mz[idx] = -sx / 1000.0;
+            idx++;
+        };
+
+        for (int seg = 0; seg < 8; seg++) {
+            point(top[seg], bot[seg]);
+            for (int i = 1; i < pointsBetween; i++) {
+                double t = static_cast<double>(i) / pointsBetween;
+                point(top[seg] + t * (top[seg + 1] - top[seg]), bot[seg] + t * (bot[seg + 1] - bot[seg]));
+            }
+        }
+        point(top[8], bot[8]);
+    }
+
+    void Normalized(uint32_t v, double& a, double& b, double& n) const {
+        a = vMy[v] / scaleM;
+        b = vMz[v] / scaleM;
+        n = vN[v] / scaleN;
+    }
+
+    static int AzimuthBin(double az) {
+        const double pi = 3.14159265358979323846;
+        int bin = (int)std::floor((az + pi) / (2.0 * pi) * AZIMUTH_BINS);
+        return ((bin % AZIMUTH_BINS) + AZIMUTH_BINS) % AZIMUTH_BINS;
+    }
+
+    static int ElevationBin(double el) {
+        const double pi = 3.14159265358979323846;
+        int bin = (int)std::floor((el + 0.5 * pi) / pi * ELEVATION_BINS);
+        return std::clamp(bin, 0, ELEVATION_BINS - 1);
+    }
+
+    // Conservative cell range of a triangle: azimuth bins az0 .. az0 + azCount - 1 (wrapping),
+    // elevation bins el0 .. el1
+    void TriangleCells(const Triangle& t, int& az0, int& azCount, int& el0, int& el1) const {
+        const double pi = 3.14159265358979323846;
+        const double pad = 1e-9;
+        double a[3], b[3], n[3];
+        Normalized(t.a, a[0], b[0], n[0]);
+        Normalized(t.b, a[1], b[1], n[1]);
+        Normalized(t.c, a[2], b[2], n[2]);
+
+        // Does the projection onto the My-Mz plane contain the N axis?
+        double cross[3];
+        for (int i = 0; i < 3; i++) {
+            int j = (i + 1) % 3;
+            cross[i] = a[i] * b[j] - b[i] * a[j];
+        }
+        const double tol = 1e-12;
+        bool containsAxis = (cross[0] >= -tol && cross[1] >= -tol && cross[2] >= -tol) ||
+                            (cross[0] <= tol && cross[1] <= tol && cross[2] <= tol);
+
+        // Horizontal distance range: max at a vertex, min on an edge (0 if the axis is inside)
+        double rMin = containsAxis ? 0.0 : std::numeric_limits<double>::infinity();
+        double rMax = 0.0, nMin = n[0], nMax = n[0];
+        for (int i = 0; i < 3; i++) {
+            int j = (i + 1) % 3;
+            rMax = std::max(rMax, std::hypot(a[i], b[i]));
+            nMin = std::min(nMin, n[i]);
+            nMax = std::max(nMax, n[i]);
+            if (!containsAxis) {
+                double ea = a[j] - a[i], eb = b[j] - b[i];
+                double len2 = ea * ea + eb * eb;
+                double u = len2 > 0.0 ? std::clamp(-(a[i] * ea + b[i] * eb) / len2, 0.0, 1.0) : 0.0;
+                rMin = std::min(rMin, std::hypot(a[i] + u * ea, b[i] + u * eb));
+            }
+        }
+        double elMax = std::atan2(nMax, nMax > 0.0 ? rMin : rMax);
+        double elMin = std::atan2(nMin, nMin < 0.0 ? rMin : rMax);
+        el0 = ElevationBin(elMin - pad);
+        el1 = ElevationBin(elMax + pad);
+
+        if (containsAxis) {
+            az0 = 0;
+            azCount = AZIMUTH_BINS;
+            return;
+        }
+
+        // Smallest arc holding the three vertex azimuths: the complement of the largest gap
+        double az[3] = { std::atan2(b[0], a[0]), std::atan2(b[1], a[1]), std::atan2(b[2], a[2]) };
+        std::sort(az, az + 3);
+        double gaps[3] = { az[1] - az[0], az[2] - az[1], az[0] + 2.0 * pi - az[2] };
+        int g = (int)(std::max_element(gaps, gaps + 3) - gaps);
+        double start = az[(g + 1) % 3];
+        double arc = 2.0 * pi - gaps[g];
+        az0 = AzimuthBin(start - pad);
+        int azEnd = (int)std::floor((start + arc + pad + pi) / (2.0 * pi) * AZIMUTH_BINS);
+        int azStart = (int)std::floor((start - pad + pi) / (2.0 * pi) * AZIMUTH_BINS);
+        azCount = std::min(azEnd - azStart + 1, AZIMUTH_BINS);
+    }
+
+    void BuildIndex() {
+        scaleN = scaleM = 0.0;
+        for (size_t i = 0; i < vN.size(); i++) {
+            scaleN = std::max(scaleN, std::abs(vN[i]));
+            scaleM = std::max(scaleM, std::hypot(vMy[i], vMz[i]));
+        }
+        if (scaleN == 0.0) scaleN = 1.0;
+        if (scaleM == 0.0) scaleM = 1.0;
+
+        // Strain states on the yield plateaus (e.g. P1-P2, P7-P8 with yielded steel) repeat the same
+        // point, leaving zero-area triangles; their rounding noise would give spurious ray hits
+        triangles.erase(std::remove_if(triangles.begin(), triangles.end(), [&](const Triangle& t) {
+            double v0[3], v1[3], v2[3];
+            Normalized(t.a, v0[0], v0[1], v0[2]);
+            Normalized(t.b, v1[0], v1[1], v1[2]);
+            Normalized(t.c, v2[0], v2[1], v2[2]);
+            double e1[3] = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+            double e2[3] = { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2] };
+            double cx = e1[1] * e2[2] - e1[2] * e2[1];
+            double cy = e1[2] * e2[0] - e1[0] * e2[2];
+            double cz = e1[0] * e2[1] - e1[1] * e2[0];
+            return std::sqrt(cx * cx + cy * cy + cz * cz) < 1e-12;
+        }), triangles.end());
+
+        // Counting pass, then fill (CSR)
+        const int cells = AZIMUTH_BINS * ELEVATION_BINS;
+        cellStart.assign(cells + 1, 0);
+        std::vector<int> range(4 * triangles.size());
+        for (size_t t = 0; t < triangles.size(); t++) {
+            int* r = &range[4 * t];
+            TriangleCells(triangles[t], r[0], r[1], r[2], r[3]);
+            for (int e = r[2]; e <= r[3]; e++) {
+                for (int i = 0; i < r[1]; i++) {
+                    cellStart[e * AZIMUTH_BINS + (r[0] + i) % AZIMUTH_BINS + 1]++;
+                }
+            }
+        }
+        for (int c = 0; c < cells; c++) {
+            cellStart[c + 1] += cellStart[c];
+        }
+        cellTriangles.resize(cellStart[cells]);
+        std::vector<uint32_t> fill(cellStart.begin(), cellStart.end() - 1);
+        for (size_t t = 0; t < triangles.size(); t++) {
+            const int* r = &range[4 * t];
+            for (int e = r[2]; e <= r[3]; e++) {
+                for (int i = 0; i < r[1]; i++) {
+                    cellTriangles[fill[e * AZIMUTH_BINS + (r[0] + i) % AZIMUTH_BINS]++] = (uint32_t)t;
+                }
+            }
+        }
+    }
+
+public:
+    InteractionSurfaceT(const PolygonSection& s, const std::vector<ReinforcementBar>& reinforcement,
+                        const ConcreteProperties& c, const SteelProperties& st)
+        : section(s), steelLayout(SteelLayout::FromBars(reinforcement, s.CentroidX(), s.CentroidY())),
+          concreteLaw(c), steelLaw(st) {
+    }
+
+    // Rectangular section b x h with one bar in each corner: As1/2 per top bar (d1 from the top
+    // and the sides), As2/2 per bottom bar (d2 from the bottom and the sides); areas [m^2]
+    static InteractionSurfaceT RectangularColumn(const SectionGeometry& geom, const ConcreteProperties& c,
+                                                 const SteelProperties& st, double as1, double as2) {
+        std::vector<ReinforcementBar> corners = {
+            { geom.d2, geom.d2, 0.5 * as2 },
+            { geom.b - geom.d2, geom.d2, 0.5 * as2 },
+            { geom.b - geom.d1, geom.h - geom.d1, 0.5 * as1 },
+            { geom.d1, geom.h - geom.d1, 0.5 * as1 },
+        };
+        return InteractionSurfaceT(PolygonSection::Rectangle(geom.b, geom.h), corners, c, st);
+    }
+
+    /// <summary>
+    /// Generate the surface mesh and its direction index
+    /// </summary>
+    /// <param name="meridians">Number of neutral-axis directions over 360° (at least 3)</param>
+    /// <param name="pointsBetween">Densification between characteristic points, as InteractionDiagram::Generate</param>
+    /// <param name="pool">Pool for the meridians; nullptr uses a temporary pool of all hardware threads</param>
+    void Generate(int meridians = 36, int pointsBetween = 10, WorkStealingPool* pool = nullptr) {
+        const double pi = 3.14159265358979323846;
+        meridians = std::max(meridians, 3);
+        pointsBetween = std::max(pointsBetween, 1);
+        int P = 9 + 8 * (pointsBetween - 1);
+        pointsPerMeridian = P;
+
+        thetas.resize(meridians);
+        for (int m = 0; m < meridians; m++) {
+            thetas[m] = 2.0 * pi * m / meridians;
+        }
+
+        std::vector<double> N((size_t)meridians * P), My(N.size()), Mz(N.size());
+        std::unique_ptr<WorkStealingPool> ownPool;
+        if (!pool) {
+            ownPool = std::make_unique<WorkStealingPool>();
+            pool = ownPool.get();
+        }
+        pool->ParallelFor(meridians, 1, [&](size_t begin, size_t end) {
+            for (size_t m = begin; m < end; m++) {
+                if (profiler) profiler->Enter("Meridian");
+                GenerateMeridian(thetas[m], pointsBetween, &N[m * P], &My[m * P], &Mz[m * P]);
+                if (profiler) profiler->Leave();
+            }
+        });
+
+        // Serial part: mesh and direction index
+        if (profiler) profiler->Enter("Mesh");
+
+        // Vertices: poles (uniform strain, equal on all meridians) once, then the meridian interiors
+        int ring = P - 2;
+        size_t vertexCount = 2 + (size_t)meridians * ring;
+        vN.resize(vertexCount);
+        vMy.resize(vertexCount);
+        vMz.resize(vertexCount);
+        vN[0] = N[0];         vMy[0] = My[0];         vMz[0] = Mz[0];
+        vN[1] = N[P - 1];     vMy[1] = My[P - 1];     vMz[1] = Mz[P - 1];
+        for (int m = 0; m < meridians; m++) {
+            for (int r = 1; r <= ring; r++) {
+                size_t v = MeridianVertex(m, r), src = (size_t)m * P + r;
+                vN[v] = N[src];
+                vMy[v] = My[src];
+                vMz[v] = Mz[src];
+            }
+        }
+
+        // Quads between neighbouring meridians, fans at the poles (consistent orientation)
+        triangles.clear();
+        triangles.reserve((size_t)meridians * 2 * (ring - 1) + 2 * meridians);
+        for (int m = 0; m < meridians; m++) {
+            int m2 = (m + 1) % meridians;
+            triangles.push_back({ 0, MeridianVertex(m2, 1), MeridianVertex(m, 1) });
+            for (int r = 1; r < ring; r++) {
+                uint32_t a = MeridianVertex(m, r), b = MeridianVertex(m2, r);
+                uint32_t c = MeridianVertex(m2, r + 1), d = MeridianVertex(m, r + 1);
+                triangles.push_back({ a, b, c });
+                triangles.push_back({ a, c, d });
+            }
+            triangles.push_back({ 1, MeridianVertex(m, ring), MeridianVertex(m2, ring) });
+        }
+
+        // Outward normals: positive enclosed volume
+        if (Volume() < 0.0) {
+            for (Triangle& t : triangles) std::swap(t.b, t.c);
+        }
+
+        BuildIndex();
+        if (profiler) profiler->Leave();
+    }
+
+    // Record each meridian (on the pool threads) and the serial meshing of Generate as scopes of
+    // the given timer; nullptr switches it off
+    void SetProfiler(PerformanceTimer* timer) {
+        profiler = timer;
+    }
+
+    // Vertex of point p (0 ... PointsPerMeridian() - 1, diagram order) on meridian m
+    uint32_t MeridianVertex(int m, int p) const {
+        if (p == 0) return 0;
+        if (p == pointsPerMeridian - 1) return 1;
+        return (uint32_t)(2 + (size_t)m * (pointsPerMeridian - 2) + (p - 1));
+    }
+
+    size_t VertexCount() const { return vN.size(); }
+    const std::vector<Triangle>& Triangles() const { return triangles; }
+    int MeridianCount() const { return (int)thetas.size(); }
+    int PointsPerMeridian() const { return pointsPerMeridian; }
+    double Theta(int m) const { return thetas[m]; }  // [rad], 0 = top fiber compressed
+    double N(size_t v) const { return vN[v]; }       // [kN]
+    double My(size_t v) const { return vMy[v]; }     // [kNm]
+    double Mz(size_t v) const { return vMz[v]; }     // [kNm]
+
+    // Enclosed volume in kN·kNm² (positive for the generated orientation)
+    double Volume() const {
+        double vol = 0.0;
+        for (const Triangle& t : triangles) {
+            vol += vN[t.a] * (vMy[t.b] * vMz[t.c] - vMz[t.b] * vMy[t.c])
+                 - vMy[t.a] * (vN[t.b] * vMz[t.c] - vMz[t.b] * vN[t.c])
+                 + vMz[t.a] * (vN[t.b] * vMy[t.c] - vMy[t.b] * vN[t.c]);
+        }
+        return vol / 6.0;
+    }
+
+    /// <summary>
+    /// Utilization of a load: the factor by which the surface point in the load's direction
+    /// (seen from the origin) must be scaled to reach the load, so 1 is on the surface and values
+    /// above 1 are outside. Requires the origin inside the surface (any section with tension steel).
+    /// </summary>
+    /// <param name="N">Axial force [kN] (+ tension)</param>
+    /// <param name="My">Moment [kNm] (+ top compressed)</param>
+    /// <param name="Mz">Moment [kNm] (+ compression at +x)</param>
+    /// <returns>Utilization [-]; infinity if the ray misses the surface</returns>
+    double Utilization(double N, double My, double Mz) const {
+        double d[3] = { My / scaleM, Mz / scaleM, N / scaleN };
+        double dh = std::hypot(d[0], d[1]);
+        if (dh == 0.0 && d[2] == 0.0) return 0.0;
+        if (cellStart.empty()) return std::numeric_limits<double>::infinity();
+
+        int cell = ElevationBin(std::atan2(d[2], dh)) * AZIMUTH_BINS + AzimuthBin(std::atan2(d[1], d[0]));
+
+        // Ray t·d against the triangles of the cell (Möller-Trumbore, origin at 0)
+        const double tol = 1e-9;
+        double tMin = std::numeric_limits<double>::infinity();
+        for (uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+            const Triangle& tri = triangles[cellTriangles[i]];
+            double v0[3], v1[3], v2[3];
+            Normalized(tri.a, v0[0], v0[1], v0[2]);
+            Normalized(tri.b, v1[0], v1[1], v1[2]);
+            Normalized(tri.c, v2[0], v2[1], v2[2]);
+            double e1[3] = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+            double e2[3] = { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2] };
+            double p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+            double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+            if (std::abs(det) < 1e-300) continue;
+            double inv = 1.0 / det;
+            double s[3] = { -v0[0], -v0[1], -v0[2] };
+            double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv;
+            if (u < -tol || u > 1.0 + tol) continue;
+            double qv[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+            double v = (d[0] * qv[0] + d[1] * qv[1] + d[2] * qv[2]) * inv;
+            if (v < -tol || u + v > 1.0 + tol) continue;
+            double t = (e2[0] * qv[0] + e2[1] * qv[1] + e2[2] * qv[2]) * inv;
+            if (t > 0.0) tMin = std::min(tMin, t);
+        }
+        return 1.0 / tMin;
+    }
+
+    // Load inside (or on) the surface
+    bool Contains(double N, double My, double Mz) const {
+        return Utilization(N, My, Mz) <= 1.0;
+    }
+
+    // Vertices as CSV (poles have meridian -1)
+    void ExportToCSV(const std::string& filename, bool compress = false) const {
+        CsvWriter out(filename, compress);
+        if (!out.IsOpen()) {
+            std::cerr << "Error: Cannot open file " << filename << "\n";
+            return;
+        }
+        const double pi = 3.14159265358979323846;
+        out.Text("Vertex,Meridian,theta[deg],N[kN],My[kNm],Mz[kNm]\n");
+        for (size_t v = 0; v < vN.size(); v++) {
+            int m = v < 2 ? -1 : (int)((v - 2) / (pointsPerMeridian - 2));
+            out.Integer((int64_t)v);
+            out.Char(',');
+            out.Integer(m);
+            out.Char(',');
+            out.Number(m < 0 ? 0.0 : thetas[m] * 180.0 / pi);
+            for (double value : { vN[v], vMy[v], vMz[v] }) {
+                out.Char(',');
+                out.Number(value);
+            }
+            out.Char('\n');
+        }
+        if (!out.Close()) {
+            std::cerr << "Error: Writing " << filename << " failed\n";
+            return;
+        }
+        std::cout << "Interaction surface exported to: " << filename << "\n";
+        std::cout << "Vertices: " << vN.size() << ", triangles: " << triangles.size() << "\n";
+    }
+};
+
+using InteractionSurface = InteractionSurfaceT<>;
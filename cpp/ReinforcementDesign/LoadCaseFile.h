@@ -0,0 +1,211 @@
+#pragma once
+#include "MaterialProperties.h"
+#include "LoadCaseStream.h"
+#include "MappedFile.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Load cases in memory, in one of two layouts: rows (DesignLoads, for Design / DesignBatch)
+// or columns (N[] and M[], for loops over one quantity). Exactly one of them is set.
+struct LoadCaseView {
+    size_t count = 0;
+    const DesignLoads* rows = nullptr;
+    const double* N = nullptr;  // [N]
+    const double* M = nullptr;  // [Nm]
+
+    bool IsColumns() const { return rows == nullptr; }
+
+    DesignLoads operator[](size_t i) const {
+        return rows ? rows[i] : DesignLoads{ N[i], M[i] };
+    }
+};
+
+// Load-case file mapped into memory.
+// Binary load-case files (LoadCaseStream.h) are used in place: View() points into the
+// read-only mapping, in the layout of the file, without parsing or copying. Several processes
+// opening the same file share its pages in the page cache. CSV text is parsed from the
+// mapping in parallel chunks with std::from_chars into the requested layout.
+class LoadCaseFile {
+private:
+    MappedFile mapping;
+    const char* base = nullptr;  // mapping.Data(), mapping.Size()
+    size_t size = 0;
+
+    LoadCaseView view;
+    bool binary = false;
+    std::vector<DesignLoads> parsedRows;  // CSV input only
+    std::vector<double> parsedN, parsedM;
+    std::string error;
+
+    LoadCaseFile() = default;
+
+    bool ParseBinary() {
+        uint64_t count;
+        LoadCaseFormat::Layout layout;
+        if (size < LoadCaseFormat::HEADER_SIZE || !LoadCaseFormat::ParseHeader(base, count, layout)) {
+            error = "unsupported binary load-case file";
+            return false;
+        }
+
+        const size_t payload = size - LoadCaseFormat::HEADER_SIZE;
+        if (layout == LoadCaseFormat::Rows) {
+            if (count == LoadCaseFormat::UNKNOWN_COUNT) count = payload / sizeof(DesignLoads);
+            if (count > payload / sizeof(DesignLoads)) {
+                error = "binary load-case file is truncated";
+                return false;
+            }
+            view.rows = reinterpret_cast<const DesignLoads*>(base + LoadCaseFormat::HEADER_SIZE);
+        } else {
+            if (count > payload / sizeof(double) || LoadCaseFormat::ColumnMOffset(count) + count * sizeof(double) > size) {
+                error = "binary load-case file is truncated";
+                return false;
+            }
+            view.N = reinterpret_cast<const double*>(base + LoadCaseFormat::HEADER_SIZE);
+            view.M = reinterpret_cast<const double*>(base + LoadCaseFormat::ColumnMOffset(count));
+        }
+        view.count = (size_t)count;
+        return true;
+    }
+
+    // Result of one parsed chunk of CSV text
+    struct ParsedChunk {
+        std::vector<DesignLoads> loads;
+        uint64_t lines = 0;
+        uint64_t errorLine = 0;  // 1-based within the chunk, 0 = no error
+    };
+
+    bool ParseText(LoadCaseFormat::Layout layout, unsigned threads, size_t chunkBytes) {
+        // Chunk boundaries just after a line break, so that no line is split
+        std::vector<size_t> bounds = { 0 };
+        while (bounds.back() < size) {
+            size_t next = std::min(size, bounds.back() + std::max<size_t>(1, chunkBytes));
+            if (next < size) {
+                const char* nl = static_cast<const char*>(std::memchr(base + next, '\n', size - next));
+                next = nl ? size_t(nl - base) + 1 : size;
+            }
+            bounds.push_back(next);
+        }
+        const size_t chunkCount = bounds.size() - 1;
+        std::vector<ParsedChunk> chunks(chunkCount);
+
+        WorkStealingPool pool(threads);
+        pool.ParallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                ParsedChunk& chunk = chunks[c];
+                const char* p = base + bounds[c];
+                const char* last = base + bounds[c + 1];
+                chunk.loads.reserve(size_t(last - p) / 16);
+                while (p < last) {
+                    const char* nl = static_cast<const char*>(std::memchr(p, '\n', size_t(last - p)));
+                    const char* lineEnd = nl ? nl : last;
+                    chunk.lines++;
+                    DesignLoads l;
+                    int parsed = LoadCaseFormat::ParseCsvLine(p, lineEnd, c == 0 && chunk.lines == 1, l);
+                    if (parsed < 0) {
+                        chunk.errorLine = chunk.lines;
+                        break;
+                    }
+                    if (parsed > 0) chunk.loads.push_back(l);
+                    p = nl ? nl + 1 : last;
+                }
+            }
+        });
+
+        // First error in file order, with its global line number
+        uint64_t linesBefore = 0;
+        size_t total = 0;
+        std::vector<size_t> offsets(chunkCount);
+        for (size_t c = 0; c < chunkCount; c++) {
+            if (chunks[c].errorLine > 0) {
+                error = "line " + std::to_string(linesBefore + chunks[c].errorLine) + ": " +
+                        LoadCaseFormat::CSV_LINE_ERROR;
+                return false;
+            }
+            linesBefore += chunks[c].lines;
+            offsets[c] = total;
+            total += chunks[c].loads.size();
+        }
+
+        // Gather the chunks into the requested layout, also in parallel
+        if (layout == LoadCaseFormat::Rows) {
+            parsedRows.resize(total);
+        } else {
+            parsedN.resize(total);
+            parsedM.resize(total);
+        }
+        pool.ParallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++) {
+                const std::vector<DesignLoads>& loads = chunks[c].loads;
+                if (layout == LoadCaseFormat::Rows) {
+                    std::copy(loads.begin(), loads.end(), parsedRows.begin() + offsets[c]);
+                    continue;
+                }
+                for (size_t i = 0; i < loads.size(); i++) {
+                    parsedN[offsets[c] + i] = loads[i].N;
+                    parsedM[offsets[c] + i] = loads[i].M;
+                }
+            }
+        });
+
+        view.count = total;
+        if (layout == LoadCaseFormat::Rows) {
+            view.rows = parsedRows.data();
+        } else {
+            view.N = parsedN.data();
+            view.M = parsedM.data();
+        }
+        return true;
+    }
+
+public:
+    LoadCaseFile(const LoadCaseFile&) = delete;
+    LoadCaseFile& operator=(const LoadCaseFile&) = delete;
+
+    /// <summary>
+    /// Map a load-case file. Binary files are used in place, in their own layout; CSV text is
+    /// parsed on `threads` threads (0 = all hardware threads) in chunks of about chunkBytes
+    /// into textLayout. On failure the returned file has Ok() == false and Error() says why
+    /// (with the line of a malformed row).
+    /// </summary>
+    static std::shared_ptr<const LoadCaseFile> Open(const std::string& filename,
+                                                    LoadCaseFormat::Layout textLayout = LoadCaseFormat::Rows,
+                                                    unsigned threads = 0, size_t chunkBytes = 1 << 20) {
+        std::shared_ptr<LoadCaseFile> file(new LoadCaseFile());
+        if (!file->mapping.Open(filename, true)) {
+            file->error = "cannot open " + filename;
+            return file;
+        }
+        file->base = file->mapping.Data();
+        file->size = file->mapping.Size();
+        file->binary = file->size >= sizeof(LoadCaseFormat::MAGIC) &&
+                       std::memcmp(file->base, LoadCaseFormat::MAGIC, sizeof(LoadCaseFormat::MAGIC)) == 0;
+        if (file->binary) {
+            file->ParseBinary();
+        } else if (file->size > 0) {
+            file->ParseText(textLayout, threads, chunkBytes);
+        }
+        return file;
+    }
+
+    // Load cases; valid while the LoadCaseFile is alive
+    const LoadCaseView& View() const {
+        return view;
+    }
+
+    bool IsBinary() const {
+        return binary;
+    }
+
+    bool Ok() const {
+        return error.empty();
+    }
+
+    const std::string& Error() const {
+        return error;
+    }
+};
@@ -0,0 +1,369 @@
+#pragma once
+#include "MaterialProperties.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// Binary load-case file: little-endian, SI units, in one of two layouts.
+//
+// Layout:
+//   [0, 64)   header: magic "RCLOADS\0", version, header size, case count
+//             (UNKNOWN_COUNT when written to a pipe: read until end of input), layout
+//   Rows      [64, ...) count x { double N [N], double M [Nm] }, the in-memory layout of DesignLoads
+//   Columns   N column at 64, M column at the next 64-byte boundary after it (count doubles each)
+//
+// Rows files can be streamed (LoadCaseReader, stdin); both layouts can be mapped in place
+// (LoadCaseFile).
+struct LoadCaseFormat {
+    enum Layout : uint32_t { Rows = 0, Columns = 1 };
+
+    static constexpr char MAGIC[8] = { 'R', 'C', 'L', 'O', 'A', 'D', 'S', '\0' };
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr size_t COLUMN_ALIGN = 64;
+    static constexpr uint64_t UNKNOWN_COUNT = ~0ull;
+
+    static constexpr size_t OFS_VERSION = 8;
+    static constexpr size_t OFS_HEADER_SIZE = 12;
+    static constexpr size_t OFS_COUNT = 16;
+    static constexpr size_t OFS_LAYOUT = 24;
+
+    // Byte offset of the M column of a Columns file
+    static uint64_t ColumnMOffset(uint64_t count) {
+        return (HEADER_SIZE + count * sizeof(double) + COLUMN_ALIGN - 1) / COLUMN_ALIGN * COLUMN_ALIGN;
+    }
+
+    static void MakeHeader(char* header, uint64_t count, Layout layout) {
+        uint32_t version = VERSION, headerSize = uint32_t(HEADER_SIZE), layoutValue = layout;
+        std::memset(header, 0, HEADER_SIZE);
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        std::memcpy(header + OFS_VERSION, &version, sizeof(version));
+        std::memcpy(header + OFS_HEADER_SIZE, &headerSize, sizeof(headerSize));
+        std::memcpy(header + OFS_COUNT, &count, sizeof(count));
+        std::memcpy(header + OFS_LAYOUT, &layoutValue, sizeof(layoutValue));
+    }
+
+    // Check a header; count and layout are returned. False for other versions or big-endian hosts.
+    static bool ParseHeader(const char* header, uint64_t& count, Layout& layout) {
+        uint32_t version, headerSize, layoutValue;
+        std::memcpy(&version, header + OFS_VERSION, sizeof(version));
+        std::memcpy(&headerSize, header + OFS_HEADER_SIZE, sizeof(headerSize));
+        std::memcpy(&count, header + OFS_COUNT, sizeof(count));
+        std::memcpy(&layoutValue, header + OFS_LAYOUT, sizeof(layoutValue));
+        layout = Layout(layoutValue);
+        return MappedFile::HostIsLittleEndian() && std::memcmp(header, MAGIC, sizeof(MAGIC)) == 0 &&
+               version == VERSION && headerSize == HEADER_SIZE && layoutValue <= Columns;
+    }
+
+    static const char* SkipSpaces(const char* p, const char* last) {
+        while (p < last && (*p == ' ' || *p == '\t')) p++;
+        return p;
+    }
+
+    // One CSV field as a number; false if it is not a finite number (from_chars also reads
+    // "nan" and "inf")
+    static bool ParseField(const char*& p, const char* last, double& value) {
+        p = SkipSpaces(p, last);
+        if (p < last && *p == '+') p++;
+        auto result = std::from_chars(p, last, value);
+        if (result.ec != std::errc() || !std::isfinite(value)) return false;
+        p = SkipSpaces(result.ptr, last);
+        if (p < last) {
+            if (*p != ',' && *p != ';') return false;
+            p++;
+        }
+        return true;
+    }
+
+    // Header line [p, last): two or three fields, none of them empty or starting like a number
+    // (digit, sign, '.', or a whole field read as nan / inf), e.g. Case;N[kN];M[kNm]
+    static bool IsHeaderLine(const char* p, const char* last) {
+        int count = 0;
+        while (p <= last) {
+            const char* end = p;
+            while (end < last && *end != ',' && *end != ';') end++;
+            const char* first = SkipSpaces(p, end);
+            const char* fieldEnd = end;
+            while (fieldEnd > first && (fieldEnd[-1] == ' ' || fieldEnd[-1] == '\t')) fieldEnd--;
+            if (first == fieldEnd || std::strchr("0123456789+-.", *first)) return false;
+            double value;
+            if (std::from_chars(first, fieldEnd, value).ptr == fieldEnd) return false;
+            if (++count > 3) return false;
+            p = end + 1;
+        }
+        return count >= 2;
+    }
+
+    // One CSV line [p, last) without its line break: N[kN],M[kNm] or Case,N[kN],M[kNm].
+    // Returns 1 for a load case (out, in SI units), 0 for a skipped line (empty, '#' comment,
+    // header if firstLine) and -1 for a malformed line, also a field that is nan or inf.
+    static int ParseCsvLine(const char* p, const char* last, bool firstLine, DesignLoads& out) {
+        if (last > p && last[-1] == '\r') last--;
+        p = SkipSpaces(p, last);
+        if (p == last || *p == '#') return 0;
+        if (firstLine && IsHeaderLine(p, last)) return 0;
+
+        double fields[3];
+        int count = 0;
+        while (p < last && count < 3) {
+            if (!ParseField(p, last, fields[count])) return -1;
+            count++;
+        }
+        if (p < last || count < 2) return -1;
+
+        const double* nm = fields + (count - 2);  // Case,N,M or N,M
+        out.N = nm[0] * 1000.0;
+        out.M = nm[1] * 1000.0;
+        return 1;
+    }
+
+    static constexpr const char* CSV_LINE_ERROR = "expected N[kN],M[kNm] or Case,N[kN],M[kNm] (finite numbers)";
+};
+
+static_assert(sizeof(DesignLoads) == 2 * sizeof(double), "binary load cases are read straight into DesignLoads");
+
+// Streaming reader of load cases from a file or stdin ("-").
+// The format is detected from the first bytes: the binary format above, or CSV text with
+// the columns N[kN],M[kNm] or Case,N[kN],M[kNm] (a first line of non-numeric fields is the
+// header; empty lines and lines starting with '#' are skipped; ',' or ';' separate fields;
+// any other line, also one with nan or inf, is an error with its line number). Input is read in blocks of
+// bufferSize bytes, so memory does not depend on the input size.
+class LoadCaseReader {
+private:
+    FILE* file = nullptr;
+    bool ownsFile = false;
+    bool binary = false;
+    uint64_t remaining = 0;  // binary: cases left to read (UNKNOWN_COUNT = until end of input)
+    uint64_t lineNumber = 0;
+    std::vector<char> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+    bool eof = false;
+    std::string error;
+
+    // Keep the unread bytes, append as many new ones as fit
+    bool Fill() {
+        if (eof) return false;
+        if (begin > 0) {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+        size_t n = std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+        end += n;
+        if (n == 0) {
+            eof = true;
+            if (std::ferror(file)) error = "read error";
+        }
+        return n > 0;
+    }
+
+    size_t ReadCsv(DesignLoads* out, size_t max) {
+        size_t n = 0;
+        while (n < max) {
+            const char* first = buffer.data() + begin;
+            const char* last = buffer.data() + end;
+            const char* newline = static_cast<const char*>(std::memchr(first, '\n', size_t(last - first)));
+            if (!newline) {
+                if (end - begin == buffer.size()) {
+                    error = "line " + std::to_string(lineNumber + 1) + " is too long";
+                    return n;
+                }
+                if (Fill()) continue;
+                if (begin == end) return n;  // end of input
+                newline = last;              // last line without line break
+            }
+
+            lineNumber++;
+            int parsed = LoadCaseFormat::ParseCsvLine(first, newline, lineNumber == 1, out[n]);
+            begin = size_t(newline - buffer.data()) + (newline < last ? 1 : 0);
+            if (parsed < 0) {
+                error = "line " + std::to_string(lineNumber) + ": " + LoadCaseFormat::CSV_LINE_ERROR;
+                return n;
+            }
+            n += size_t(parsed);
+        }
+        return n;
+    }
+
+    size_t ReadBinary(DesignLoads* out, size_t max) {
+        size_t n = 0;
+        while (n < max && remaining > 0) {
+            size_t available = (end - begin) / sizeof(DesignLoads);
+            if (available == 0) {
+                if (Fill()) continue;
+                if (remaining != LoadCaseFormat::UNKNOWN_COUNT || begin != end) {
+                    error = "binary load-case file is truncated";
+                }
+                return n;
+            }
+            size_t take = std::min<uint64_t>({ uint64_t(max - n), uint64_t(available), remaining });
+            std::memcpy(out + n, buffer.data() + begin, take * sizeof(DesignLoads));
+            begin += take * sizeof(DesignLoads);
+            n += take;
+            if (remaining != LoadCaseFormat::UNKNOWN_COUNT) remaining -= take;
+        }
+        return n;
+    }
+
+public:
+    explicit LoadCaseReader(size_t bufferSize = 1 << 20)
+        : buffer(std::max<size_t>(bufferSize, LoadCaseFormat::HEADER_SIZE)) {}
+
+    ~LoadCaseReader() {
+        if (ownsFile && file) std::fclose(file);
+    }
+
+    LoadCaseReader(const LoadCaseReader&) = delete;
+    LoadCaseReader& operator=(const LoadCaseReader&) = delete;
+
+    // Open a file, or stdin for "-", and detect its format. Returns false (see Error) if the
+    // file cannot be opened or has an unsupported binary header.
+    bool Open(const std::string& path) {
+        if (path == "-") {
+#ifdef _WIN32
+            _setmode(_fileno(stdin), _O_BINARY);
+#endif
+            file = stdin;
+        } else {
+            file = std::fopen(path.c_str(), "rb");
+            ownsFile = file != nullptr;
+            if (!file) {
+                error = "cannot open " + path;
+                return false;
+            }
+        }
+
+        while (end < LoadCaseFormat::HEADER_SIZE && Fill()) {}
+        binary = end >= sizeof(LoadCaseFormat::MAGIC) &&
+                 std::memcmp(buffer.data(), LoadCaseFormat::MAGIC, sizeof(LoadCaseFormat::MAGIC)) == 0;
+        if (!binary) return error.empty();
+
+        LoadCaseFormat::Layout layout;
+        if (end < LoadCaseFormat::HEADER_SIZE || !LoadCaseFormat::ParseHeader(buffer.data(), remaining, layout)) {
+            error = "unsupported binary load-case file";
+            return false;
+        }
+        if (layout != LoadCaseFormat::Rows) {
+            error = "column-layout load-case files cannot be streamed, map them (LoadCaseFile)";
+            return false;
+        }
+        begin = LoadCaseFormat::HEADER_SIZE;
+        return true;
+    }
+
+    // Read up to max load cases into out. Returns the number read; 0 at the end of the
+    // input or on an error (Failed).
+    size_t Read(DesignLoads* out, size_t max) {
+        if (!file || Failed()) return 0;
+        return binary ? ReadBinary(out, max) : ReadCsv(out, max);
+    }
+
+    bool IsBinary() const {
+        return binary;
+    }
+
+    bool Failed() const {
+        return !error.empty();
+    }
+
+    const std::string& Error() const {
+        return error;
+    }
+};
+
+// Streaming writer of binary load-case files. The case count in the header is filled in by
+// Close(); on a pipe (stdout, "-") it stays UNKNOWN_COUNT and readers stop at end of input.
+class LoadCaseWriter {
+private:
+    FILE* file = nullptr;
+    bool ownsFile = false;
+    bool ok = false;
+    uint64_t count = 0;
+
+public:
+    LoadCaseWriter() = default;
+
+    ~LoadCaseWriter() {
+        Close();
+    }
+
+    LoadCaseWriter(const LoadCaseWriter&) = delete;
+    LoadCaseWriter& operator=(const LoadCaseWriter&) = delete;
+
+    bool Open(const std::string& path) {
+        if (!MappedFile::HostIsLittleEndian()) return false;
+        if (path == "-") {
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            file = stdout;
+        } else {
+            file = std::fopen(path.c_str(), "wb");
+            ownsFile = file != nullptr;
+        }
+        if (!file) return false;
+
+        char header[LoadCaseFormat::HEADER_SIZE];
+        LoadCaseFormat::MakeHeader(header, LoadCaseFormat::UNKNOWN_COUNT, LoadCaseFormat::Rows);
+        ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+        return ok;
+    }
+
+    bool Write(const DesignLoads* loads, size_t n) {
+        if (!ok) return false;
+        ok = std::fwrite(loads, sizeof(DesignLoads), n, file) == n;
+        count += n;
+        return ok;
+    }
+
+    // Patch the case count into the header (seekable files only) and close.
+    // Returns false if any write failed.
+    bool Close() {
+        if (!file) return ok;
+        if (ok && ownsFile && std::fseek(file, long(LoadCaseFormat::OFS_COUNT), SEEK_SET) == 0) {
+            ok = std::fwrite(&count, sizeof(count), 1, file) == 1;
+        }
+        ok = (ownsFile ? std::fclose(file) == 0 : std::fflush(file) == 0) && ok;
+        file = nullptr;
+        return ok;
+    }
+
+    uint64_t Count() const {
+        return count;
+    }
+
+    // Whole array in one go
+    static bool WriteFile(const std::string& path, const DesignLoads* loads, size_t n) {
+        LoadCaseWriter writer;
+        return writer.Open(path) && writer.Write(loads, n) && writer.Close();
+    }
+
+    // Column layout (N and M arrays), for LoadCaseFile::Open without conversion
+    static bool WriteColumns(const std::string& path, const double* N, const double* M, size_t n) {
+        if (!MappedFile::HostIsLittleEndian()) return false;
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) return false;
+
+        char header[LoadCaseFormat::HEADER_SIZE];
+        LoadCaseFormat::MakeHeader(header, n, LoadCaseFormat::Columns);
+        static const char padding[LoadCaseFormat::COLUMN_ALIGN] = {};
+        size_t pad = size_t(LoadCaseFormat::ColumnMOffset(n) - LoadCaseFormat::HEADER_SIZE - n * sizeof(double));
+        bool ok = std::fwrite(header, 1, sizeof(header), f) == sizeof(header) &&
+                  std::fwrite(N, sizeof(double), n, f) == n &&
+                  std::fwrite(padding, 1, pad, f) == pad &&
+                  std::fwrite(M, sizeof(double), n, f) == n;
+        return (std::fclose(f) == 0) && ok;
+    }
+};
@@ -0,0 +1,204 @@
+#pragma once
+#include "MaterialProperties.h"
+#include "InteractionDiagram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Governing subset of the load cases of one member (envelope pruning before design).
+//
+// ReinforcementDesigner finds the strain state from the moment about the As2 layer,
+// g = M - z2*N, alone, and then As2 = (N - Fc(g)) / sigmaS2(g). Where the steel has yielded
+// (sigmaS2 = fyd, a range of g read off the concrete-only diagram) Fc(g) is concave, so the
+// load cases that need at most As2 = A form a convex region of the (N, M) plane, and that
+// region contains the concrete-only diagram (cases inside it need no As2). A reinforcement
+// that covers some load cases therefore covers every case inside the convex hull of those
+// cases and the diagram: only the load cases at vertices of that hull govern, whatever the
+// number of combinations. Cases outside the yield range (compression failure, no bracket)
+// are not pruned.
+//
+// Build is O(n): a pre-pass keeps the cases with the largest and smallest M in each N band,
+// the hull is taken over these candidates and the diagram, and a final pass checks every case
+// against the hull. Cases the band pre-pass missed (outside the hull) are added as candidates
+// and the hull is rebuilt, so the result does not depend on the band count.
+class LoadEnvelope {
+private:
+    struct Point {
+        double x, y;   // N and M scaled to the unit square of the load cases
+        int64_t tag;   // load case index, -1 for diagram points
+    };
+
+    std::vector<size_t> governing;  // ascending
+    size_t candidates = 0;          // cases in the hull after the band pre-pass
+    size_t escaped = 0;             // cases outside that hull, added by the final check
+
+    static double Cross(const Point& o, const Point& a, const Point& b) {
+        return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    }
+
+    // Convex hull (Andrew's monotone chain), counter-clockwise, without collinear points
+    static std::vector<Point> Hull(std::vector<Point> points) {
+        std::sort(points.begin(), points.end(), [](const Point& a, const Point& b) {
+            return a.x < b.x || (a.x == b.x && (a.y < b.y || (a.y == b.y && a.tag > b.tag)));
+        });
+        // Duplicates keep the load case (sorted first), so equal loads govern as a case
+        points.erase(std::unique(points.begin(), points.end(), [](const Point& a, const Point& b) {
+            return a.x == b.x && a.y == b.y;
+        }), points.end());
+        if (points.size() < 3) return points;
+
+        std::vector<Point> hull(2 * points.size());
+        size_t k = 0;
+        for (size_t i = 0; i < points.size(); i++) {
+            while (k >= 2 && Cross(hull[k - 2], hull[k - 1], points[i]) <= 0.0) k--;
+            hull[k++] = points[i];
+        }
+        for (size_t i = points.size() - 1, lower = k + 1; i-- > 0;) {
+            while (k >= lower && Cross(hull[k - 2], hull[k - 1], points[i]) <= 0.0) k--;
+            hull[k++] = points[i];
+        }
+        hull.resize(k - 1);  // last point repeats the first
+        return hull;
+    }
+
+    // Point in a counter-clockwise convex polygon (boundary within tol counts as inside),
+    // O(log n) by bisecting the fan of triangles around hull[0]
+    static bool Inside(const std::vector<Point>& hull, const Point& p, double tol) {
+        const size_t n = hull.size();
+        if (Cross(hull[0], hull[1], p) < -tol || Cross(hull[0], hull[n - 1], p) > tol) return false;
+        size_t lo = 1, hi = n - 1;
+        while (hi - lo > 1) {
+            size_t mid = (lo + hi) / 2;
+            if (Cross(hull[0], hull[mid], p) >= 0.0) lo = mid; else hi = mid;
+        }
+        return Cross(hull[lo], hull[lo + 1], p) >= -tol;
+    }
+
+public:
+    /// <summary>
+    /// Governing load cases of loads[0..count) for the concrete-only diagram of the section
+    /// (As1 = 0, As2 = 0, as used by ReinforcementDesigner); z2 [m] = lever arm of As2 from
+    /// the centroid, fyd [Pa] = yield strength of As2. bands = N bands of the pre-pass,
+    /// 0 takes the hull of all cases.
+    /// </summary>
+    static LoadEnvelope Build(const DesignLoads* loads, size_t count, const DiagramView& diagram,
+                              double z2, double fyd, unsigned bands = 256) {
+        LoadEnvelope envelope;
+        if (count == 0) return envelope;
+
+        // Yield range [gMin, gMax] of the key: every diagram point up to gMax has yielded, and
+        // so has every strain state between them (strains are linear between diagram points)
+        auto key = [&](double N, double M) { return M - z2 * N; };
+        double gMin = HUGE_VAL, gMax = -HUGE_VAL, gElastic = HUGE_VAL;
+        for (size_t i = 0; i < diagram.Size(); i++) {
+            double g = key(diagram.N[i] * 1000.0, diagram.M[i] * 1000.0);  // kN, kNm -> N, Nm
+            if (std::abs(diagram.sigS2[i] * 1e6 - fyd) > 1e-9 * fyd) gElastic = std::min(gElastic, g);
+        }
+        for (size_t i = 0; i < diagram.Size(); i++) {
+            double g = key(diagram.N[i] * 1000.0, diagram.M[i] * 1000.0);
+            if (g >= gElastic) continue;
+            gMin = std::min(gMin, g);
+            gMax = std::max(gMax, g);
+        }
+        auto prunable = [&](const DesignLoads& l) {
+            double g = key(l.N, l.M);
+            return g >= gMin && g <= gMax;
+        };
+
+        // Cases outside the yield range always govern; the rest is pruned below
+        std::vector<size_t> inRange;
+        inRange.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            if (prunable(loads[i])) {
+                inRange.push_back(i);
+            } else {
+                envelope.governing.push_back(i);
+            }
+        }
+        if (inRange.empty()) return envelope;
+
+        // Unit square of the load cases, so that N [N] and M [Nm] weigh alike in the tolerance
+        const DesignLoads& first = loads[inRange[0]];
+        double nMin = first.N, nMax = first.N, mMin = first.M, mMax = first.M;
+        for (size_t i : inRange) {
+            nMin = std::min(nMin, loads[i].N);
+            nMax = std::max(nMax, loads[i].N);
+            mMin = std::min(mMin, loads[i].M);
+            mMax = std::max(mMax, loads[i].M);
+        }
+        const double sx = nMax > nMin ? 1.0 / (nMax - nMin) : 1.0;
+        const double sy = mMax > mMin ? 1.0 / (mMax - mMin) : 1.0;
+        auto point = [&](double N, double M, int64_t tag) { return Point{ (N - nMin) * sx, (M - mMin) * sy, tag }; };
+
+        std::vector<Point> points;
+        points.reserve(diagram.Size() + 2 * size_t(bands) + 8);
+        for (size_t i = 0; i < diagram.Size(); i++) {
+            DesignLoads d = { diagram.N[i] * 1000.0, diagram.M[i] * 1000.0 };
+            if (prunable(d)) points.push_back(point(d.N, d.M, -1));
+        }
+        const size_t diagramPoints = points.size();
+
+        // Pre-pass: largest and smallest M per N band
+        if (bands == 0 || inRange.size() <= 2 * size_t(bands)) {
+            for (size_t i : inRange) points.push_back(point(loads[i].N, loads[i].M, int64_t(i)));
+        } else {
+            std::vector<size_t> top(bands, SIZE_MAX), bottom(bands, SIZE_MAX);
+            const double perBand = bands * sx;
+            for (size_t i : inRange) {
+                size_t b = std::min<size_t>(bands - 1, size_t((loads[i].N - nMin) * perBand));
+                if (top[b] == SIZE_MAX || loads[i].M > loads[top[b]].M) top[b] = i;
+                if (bottom[b] == SIZE_MAX || loads[i].M < loads[bottom[b]].M) bottom[b] = i;
+            }
+            for (unsigned b = 0; b < bands; b++) {
+                if (top[b] == SIZE_MAX) continue;
+                points.push_back(point(loads[top[b]].N, loads[top[b]].M, int64_t(top[b])));
+                if (bottom[b] != top[b]) points.push_back(point(loads[bottom[b]].N, loads[bottom[b]].M, int64_t(bottom[b])));
+            }
+        }
+        envelope.candidates = points.size() - diagramPoints;
+
+        std::vector<Point> hull = Hull(points);
+        if (hull.size() < 3) {
+            // Degenerate (collinear cases, no diagram in range): nothing can be pruned
+            envelope.governing.insert(envelope.governing.end(), inRange.begin(), inRange.end());
+            std::sort(envelope.governing.begin(), envelope.governing.end());
+            return envelope;
+        }
+
+        // Final check of every case; the ones outside become candidates of a second hull,
+        // which then contains all cases
+        const double tol = 1e-12;
+        std::vector<Point> outside;
+        for (size_t i : inRange) {
+            Point p = point(loads[i].N, loads[i].M, int64_t(i));
+            if (!Inside(hull, p, tol)) outside.push_back(p);
+        }
+        envelope.escaped = outside.size();
+        if (!outside.empty()) {
+            hull.insert(hull.end(), outside.begin(), outside.end());
+            hull = Hull(hull);
+        }
+
+        for (const Point& p : hull) {
+            if (p.tag >= 0) envelope.governing.push_back(size_t(p.tag));
+        }
+        std::sort(envelope.governing.begin(), envelope.governing.end());
+        return envelope;
+    }
+
+    // Indices of the governing load cases, ascending
+    const std::vector<size_t>& Governing() const {
+        return governing;
+    }
+
+    // Cases kept by the band pre-pass (hull input)
+    size_t Candidates() const {
+        return candidates;
+    }
+
+    // Cases the pre-pass missed and the final check added
+    size_t Escaped() const {
+        return escaped;
+    }
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Whole file mapped read-only into memory, shared by the binary file formats (DiagramFile,
+// LoadCaseFile). Their fields are little-endian and used in place, so they also check the
+// host byte order here.
+class MappedFile {
+private:
+    const char* base = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mappingHandle) CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+#else
+        if (base) ::munmap(const_cast<char*>(base), size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    static bool HostIsLittleEndian() {
+        const uint16_t one = 1;
+        return *reinterpret_cast<const uint8_t*>(&one) == 1;
+    }
+
+    // Map filename; sequential = hint that it is read front to back once. An empty file maps
+    // to Data() == nullptr, Size() == 0. Call once per MappedFile.
+    bool Open(const std::string& filename, bool sequential = false) {
+#ifdef _WIN32
+        fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                 OPEN_EXISTING, sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize)) return false;
+        size = (size_t)fileSize.QuadPart;
+        if (size == 0) return true;  // an empty file cannot be mapped
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr) return false;
+        base = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        return base != nullptr;
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size = (size_t)st.st_size;
+        if (size == 0) {
+            ::close(fd);
+            return true;
+        }
+        void* p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);  // the mapping stays valid
+        if (p == MAP_FAILED) {
+            size = 0;
+            return false;
+        }
+        if (sequential) ::madvise(p, size, MADV_SEQUENTIAL);
+        base = static_cast<const char*>(p);
+        return true;
+#endif
+    }
+
+    // Mapped bytes; valid while the MappedFile is alive
+    const char* Data() const {
+        return base;
+    }
+
+    size_t Size() const {
+        return size;
+    }
+};
@@ -0,0 +1,340 @@
+#pragma once
+#include "MaterialProperties.h"
+#include "SimdLanes.h"
+#include <cmath>
+#include <cstdint>
+
+// Stress-strain laws as compile-time policies.
+//
+// InteractionDiagramT, ReinforcementDesignerT, InteractionSurfaceT and the integrators are
+// templated on one concrete and one steel law, so every combination gets its own inlined
+// kernels without runtime dispatch. A law is built once from the material properties and
+// precomputes its derived constants (1/εc2, εyd, hardening modulus, ...).
+//
+// Concrete laws (compression negative) share the shape: σ = 0 for ε ≥ 0, a curved branch for
+// εc2 < ε < 0 and the plateau σ = fcd for ε ≤ εc2. They provide
+//   Fcd(), EpsC2(), EpsCu(), Stress(ε), Tangent(ε) = dσ/dε,
+//   Curve<WithJacobian>(k, q, xa, xb): integrals of the curved branch over x ∈ [xa, xb]
+//     for ε(x) = k·x + q (the caller guarantees εc2 ≤ ε ≤ 0 there),
+//   Id (cache key) and Polynomial; polynomial laws also provide
+//   CurvePolynomial(e0, k, c0, c1, c2): σ(e0 + k·w) = c0 + c1·w + c2·w² on the curved branch.
+//
+// Steel laws (tension positive) provide Fyd(), EpsY(), EpsUd(), Stress(ε), the branchless
+// Stress<Lane>(ε) for the SIMD layout kernel, and Id.
+namespace MaterialLaws {
+
+    // Curved-branch integrals, normalized by fcd (multiply by fcd·b for a rectangle)
+    struct CurveIntegrals {
+        double n;   // ∫σ/fcd dx
+        double m;   // ∫σ/fcd·x dx
+        double t0;  // ∫σ'/fcd dx       (σ' = dσ/dε; only with WithJacobian)
+        double t1;  // ∫σ'/fcd·x dx
+        double t2;  // ∫σ'/fcd·x² dx
+    };
+
+    /// <summary>
+    /// EC2 parabola-rectangle (EC2 3.1.7(1), n = 2): σ = fcd·(1 - (1 - ε/εc2)²).
+    /// Integrated exactly; the default law.
+    /// </summary>
+    class ParabolaRectangle {
+    private:
+        double fcd, epsC2, epsCu;
+        double inv;  // 1/εc2
+
+    public:
+        static constexpr uint32_t Id = 1;
+        static constexpr bool Polynomial = true;
+
+        explicit ParabolaRectangle(const ConcreteProperties& props)
+            : fcd(props.fcd), epsC2(props.epsC2), epsCu(props.epsCu), inv(1.0 / props.epsC2) {}
+
+        double Fcd() const { return fcd; }
+        double EpsC2() const { return epsC2; }
+        double EpsCu() const { return epsCu; }
+        double InvEpsC2() const { return inv; }
+
+        double Stress(double eps) const {
+            if (eps >= 0.0) return 0.0;
+            if (eps <= epsC2) return fcd;
+            double u = 1.0 - eps * inv;
+            return fcd * (1.0 - u * u);
+        }
+
+        double Tangent(double eps) const {
+            if (eps >= 0.0 || eps <= epsC2) return 0.0;
+            return 2.0 * fcd * (1.0 - eps * inv) * inv;
+        }
+
+        template <bool WithJacobian>
+        CurveIntegrals Curve(double k, double q, double xa, double xb) const {
+            CurveIntegrals r = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+            // σ/fcd = 2u - u² with u = ε/εc2 = a·x + c
+            double a = k * inv;
+            double c = q * inv;
+
+            double dx = xb - xa;
+            double dx2 = xb * xb - xa * xa;
+            double dx3 = (xb * xb * xb - xa * xa * xa) / 3.0;
+
+            double xa2 = xa * xa;
+            double xb2 = xb * xb;
+            double dx4 = 0.25 * (xb2 * xb2 - xa2 * xa2);
+
+            r.n = (2.0 * a - 2.0 * a * c) * dx2 * 0.5 + (2.0 * c - c * c) * dx - a * a * dx3;
+            r.m = (2.0 * a - 2.0 * a * c) * dx3 + (2.0 * c - c * c) * dx2 * 0.5 - a * a * dx4;
+
+            if constexpr (WithJacobian) {
+                // σ'/fcd = 2·(1 - u)/εc2
+                double fac = 2.0 * inv;
+                r.t0 = fac * ((1.0 - c) * dx - a * dx2 * 0.5);
+                r.t1 = fac * ((1.0 - c) * dx2 * 0.5 - a * dx3);
+                r.t2 = fac * ((1.0 - c) * dx3 - a * dx4);
+            }
+            return r;
+        }
+
+        void CurvePolynomial(double e0, double k, double& c0, double& c1, double& c2) const {
+            c0 = fcd * e0 * inv * (2.0 - e0 * inv);
+            c1 = 2.0 * fcd * k * inv * (1.0 - e0 * inv);
+            c2 = -fcd * k * k * inv * inv;
+        }
+    };
+
+    /// <summary>
+    /// EC2 parabola-rectangle with a general exponent (EC2 Table 3.1: n = 2 up to C50/60,
+    /// n = 1.4 + 23.4·((90 - fck)/100)^4 above): σ = fcd·(1 - (1 - ε/εc2)^n).
+    /// The curved branch is integrated in closed form in u = 1 - ε/εc2, or by 6-point
+    /// Gauss-Legendre where u varies by less than a quarter over the zone (where the closed
+    /// form would cancel); both are accurate to about 1e-13 relative.
+    /// </summary>
+    class ParabolaRectangleN {
+    private:
+        double fcd, epsC2, epsCu, n;
+        double inv;  // 1/εc2
+
+        // ∫u^p·x^j dx over [xa, xb] for j = 0, 1, 2, with u = ua + α·(x - xa) ≥ 0
+        static void PowerMoments(double p, double xa, double xb, double ua, double alpha,
+                                 double& i0, double& i1, double& i2) {
+            double dx = xb - xa;
+            double ub = std::max(0.0, ua + alpha * dx);
+            double uMax = std::max(ua, ub);
+
+            if (std::abs(ub - ua) >= 0.25 * uMax) {
+                // x = xa + s, u - ua = α·s
+                auto d = [&](double m) { return (std::pow(ub, m) - std::pow(ua, m)) / m; };
+                double d1 = d(p + 1.0), d2 = d(p + 2.0), d3 = d(p + 3.0);
+                double j0 = d1 / alpha;
+                double j1 = (d2 - ua * d1) / (alpha * alpha);
+                double j2 = (d3 - 2.0 * ua * d2 + ua * ua * d1) / (alpha * alpha * alpha);
+                i0 = j0;
+                i1 = xa * j0 + j1;
+                i2 = xa * xa * j0 + 2.0 * xa * j1 + j2;
+                return;
+            }
+
+            static const double gt[6] = { 0.033765242898423987, 0.16939530676686776, 0.38069040695840156,
+                                          0.61930959304159845, 0.83060469323313224, 0.96623475710157601 };
+            static const double gw[6] = { 0.085662246189585173, 0.18038078652406930, 0.23395696728634552,
+                                          0.23395696728634552, 0.18038078652406930, 0.085662246189585173 };
+            i0 = i1 = i2 = 0.0;
+            for (int g = 0; g < 6; g++) {
+                double s = gt[g] * dx;
+                double x = xa + s;
+                double f = gw[g] * std::pow(ua + alpha * s, p);
+                i0 += f;
+                i1 += f * x;
+                i2 += f * x * x;
+            }
+            i0 *= dx;
+            i1 *= dx;
+            i2 *= dx;
+        }
+
+    public:
+        static constexpr uint32_t Id = 2;
+        static constexpr bool Polynomial = false;
+
+        explicit ParabolaRectangleN(const ConcreteProperties& props)
+            : fcd(props.fcd), epsC2(props.epsC2), epsCu(props.epsCu), n(props.n), inv(1.0 / props.epsC2) {}
+
+        double Fcd() const { return fcd; }
+        double EpsC2() const { return epsC2; }
+        double EpsCu() const { return epsCu; }
+        double Exponent() const { return n; }
+
+        double Stress(double eps) const {
+            if (eps >= 0.0) return 0.0;
+            if (eps <= epsC2) return fcd;
+            return fcd * (1.0 - std::pow(1.0 - eps * inv, n));
+        }
+
+        double Tangent(double eps) const {
+            if (eps >= 0.0 || eps <= epsC2) return 0.0;
+            return fcd * n * inv * std::pow(1.0 - eps * inv, n - 1.0);
+        }
+
+        template <bool WithJacobian>
+        CurveIntegrals Curve(double k, double q, double xa, double xb) const {
+            CurveIntegrals r = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+            // u = 1 - ε/εc2 = ua + α·(x - xa), clamped against rounding at the zone ends
+            double alpha = -k * inv;
+            double ua = std::max(0.0, 1.0 - (k * xa + q) * inv);
+
+            double i0, i1, i2;
+            PowerMoments(n, xa, xb, ua, alpha, i0, i1, i2);
+            r.n = (xb - xa) - i0;
+            r.m = 0.5 * (xb * xb - xa * xa) - i1;
+
+            if constexpr (WithJacobian) {
+                // σ'/fcd = n·u^(n-1)/εc2
+                PowerMoments(n - 1.0, xa, xb, ua, alpha, i0, i1, i2);
+                double fac = n * inv;
+                r.t0 = fac * i0;
+                r.t1 = fac * i1;
+                r.t2 = fac * i2;
+            }
+            return r;
+        }
+    };
+
+    /// <summary>
+    /// EC2 bilinear concrete law (EC2 3.1.7(2), Figure 3.4): linear up to fcd at εc3, then
+    /// constant. εc3 is taken from ConcreteProperties::epsC2.
+    /// </summary>
+    class BilinearConcrete {
+    private:
+        double fcd, epsC2, epsCu;
+        double inv;  // 1/εc3
+
+    public:
+        static constexpr uint32_t Id = 3;
+        static constexpr bool Polynomial = true;
+
+        explicit BilinearConcrete(const ConcreteProperties& props)
+            : fcd(props.fcd), epsC2(props.epsC2), epsCu(props.epsCu), inv(1.0 / props.epsC2) {}
+
+        double Fcd() const { return fcd; }
+        double EpsC2() const { return epsC2; }
+        double EpsCu() const { return epsCu; }
+
+        double Stress(double eps) const {
+            if (eps >= 0.0) return 0.0;
+            if (eps <= epsC2) return fcd;
+            return fcd * eps * inv;
+        }
+
+        double Tangent(double eps) const {
+            if (eps >= 0.0 || eps <= epsC2) return 0.0;
+            return fcd * inv;
+        }
+
+        template <bool WithJacobian>
+        CurveIntegrals Curve(double k, double q, double xa, double xb) const {
+            CurveIntegrals r = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+            double dx = xb - xa;
+            double dx2 = 0.5 * (xb * xb - xa * xa);
+            double dx3 = (xb * xb * xb - xa * xa * xa) / 3.0;
+
+            r.n = inv * (k * dx2 + q * dx);
+            r.m = inv * (k * dx3 + q * dx2);
+
+            if constexpr (WithJacobian) {
+                r.t0 = inv * dx;
+                r.t1 = inv * dx2;
+                r.t2 = inv * dx3;
+            }
+            return r;
+        }
+
+        void CurvePolynomial(double e0, double k, double& c0, double& c1, double& c2) const {
+            c0 = fcd * e0 * inv;
+            c1 = fcd * k * inv;
+            c2 = 0.0;
+        }
+    };
+
+    /// <summary>
+    /// Bilinear steel with a horizontal top branch (EC2 3.2.7(2) b): σ = Es·ε up to ±fyd.
+    /// The default law.
+    /// </summary>
+    class BilinearSteel {
+    private:
+        double fyd, Es, epsY, epsUd;
+
+    public:
+        static constexpr uint32_t Id = 1;
+
+        explicit BilinearSteel(const SteelProperties& props)
+            : fyd(props.fyd), Es(props.Es), epsY(props.fyd / props.Es), epsUd(props.epsUd) {}
+
+        double Fyd() const { return fyd; }
+        double EpsY() const { return epsY; }
+        double EpsUd() const { return epsUd; }
+
+        double Stress(double eps) const {
+            if (eps >= epsY) {
+                return fyd;
+            }
+            else if (eps <= -epsY) {
+                return -fyd;
+            }
+            else {
+                return eps * Es;
+            }
+        }
+
+        // Branchless Stress (same comparisons, so every lane gets the scalar result)
+        template <typename L>
+        typename L::Vec Stress(typename L::Vec eps) const {
+            return L::Select(L::GreaterEq(eps, L::Set1(epsY)), L::Set1(fyd),
+                             L::Select(L::GreaterEq(L::Set1(-epsY), eps), L::Set1(-fyd),
+                                       L::Mul(eps, L::Set1(Es))));
+        }
+    };
+
+    /// <summary>
+    /// Bilinear steel with an inclined top branch (EC2 3.2.7(2) a): beyond ±εyd the stress grows
+    /// from fyd to k·fyd at εuk, with εuk = εud/0.9 (EC2 recommended εud = 0.9·εuk).
+    /// </summary>
+    class HardeningSteel {
+    private:
+        double fyd, Es, epsY, epsUd;
+        double Eh;  // hardening modulus (k - 1)·fyd / (εuk - εyd)
+
+    public:
+        static constexpr uint32_t Id = 2;
+
+        explicit HardeningSteel(const SteelProperties& props)
+            : fyd(props.fyd), Es(props.Es), epsY(props.fyd / props.Es), epsUd(props.epsUd),
+              Eh((props.k - 1.0) * props.fyd / (props.epsUd / 0.9 - props.fyd / props.Es)) {}
+
+        double Fyd() const { return fyd; }
+        double EpsY() const { return epsY; }
+        double EpsUd() const { return epsUd; }
+        double HardeningModulus() const { return Eh; }
+
+        double Stress(double eps) const {
+            if (eps >= epsY) {
+                return fyd + Eh * (eps - epsY);
+            }
+            else if (eps <= -epsY) {
+                return -fyd + Eh * (eps + epsY);
+            }
+            else {
+                return eps * Es;
+            }
+        }
+
+        template <typename L>
+        typename L::Vec Stress(typename L::Vec eps) const {
+            const typename L::Vec vEpsY = L::Set1(epsY), vEh = L::Set1(Eh);
+            return L::Select(L::GreaterEq(eps, vEpsY), L::Add(L::Set1(fyd), L::Mul(vEh, L::Sub(eps, vEpsY))),
+                             L::Select(L::GreaterEq(L::Neg(vEpsY), eps),
+                                       L::Add(L::Set1(-fyd), L::Mul(vEh, L::Add(eps, vEpsY))),
+                                       L::Mul(eps, L::Set1(Es))));
+        }
+    };
+}
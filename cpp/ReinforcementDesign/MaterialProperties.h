@@ -5,6 +5,7 @@ struct ConcreteProperties {
     double fcd;      // [Pa] design compressive strength (negative)
     double epsC2;    // [-] strain at peak stress
     double epsCu;    // [-] ultimate compressive strain
+    double n = 2.0;  // [-] parabola exponent (MaterialLaws::ParabolaRectangleN only)
 };
 
 // Steel properties
@@ -12,6 +13,7 @@ struct SteelProperties {
     double fyd;      // [Pa] design yield strength
     double Es;       // [Pa] elastic modulus
     double epsUd;    // [-] ultimate tensile strain
+    double k = 1.0;  // [-] ratio ftd/fyd at εuk (MaterialLaws::HardeningSteel only)
 };
 
 // Section geometry
@@ -22,6 +24,15 @@ struct SectionGeometry {
     double d2;       // [m] bottom reinforcement cover from bottom edge
 };
 
+// Reinforcing bar or bar layer: position [m] and area [m^2].
+// For rectangular sections x is from the left edge and y from the bottom edge;
+// for polygonal sections both are in the coordinates of the polygon rings.
+struct ReinforcementBar {
+    double x;
+    double y;
+    double area;
+};
+
 // Design loads
 struct DesignLoads {
     double N;        // [N] axial force (+ tension, - compression)
@@ -0,0 +1,118 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware performance counters of the calling thread (Linux perf_event_open).
+// Counts user-space cycles, instructions, branch misses and last-level cache misses of the
+// thread that created the object. Where the counters cannot be opened (other platforms,
+// containers without PMU access, perf_event_paranoid too strict) Available() is false and
+// Reason() says why; nothing else changes.
+class PerfCounters {
+public:
+    static constexpr int COUNT = 4;
+
+    enum Event { Cycles = 0, Instructions = 1, BranchMisses = 2, CacheMisses = 3 };
+
+    struct Values {
+        uint64_t value[COUNT] = {};
+        bool valid[COUNT] = {};  // event could be opened (LLC misses are missing on some CPUs)
+    };
+
+    static const char* Name(int event) {
+        static const char* const names[COUNT] = { "Cycles", "Instructions", "BranchMisses", "LLCMisses" };
+        return names[event];
+    }
+
+private:
+    int fds[COUNT] = { -1, -1, -1, -1 };
+    int slot[COUNT] = { -1, -1, -1, -1 };  // position of each event in the group read
+    int opened = 0;
+    std::string reason;
+
+#if defined(__linux__)
+    static int Open(uint64_t config, int groupFd) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = groupFd < 0 ? 1 : 0;  // the group starts when the leader is enabled
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return int(syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0));
+    }
+#endif
+
+public:
+    PerfCounters() {
+#if defined(__linux__)
+        static const uint64_t configs[COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES
+        };
+
+        fds[Cycles] = Open(configs[Cycles], -1);
+        if (fds[Cycles] < 0) {
+            reason = std::string("perf_event_open: ") + std::strerror(errno) +
+                     (errno == EACCES || errno == EPERM ? " (check /proc/sys/kernel/perf_event_paranoid)"
+                                                        : " (no hardware PMU access)");
+            return;
+        }
+        slot[Cycles] = opened++;
+        for (int e = Instructions; e < COUNT; e++) {
+            fds[e] = Open(configs[e], fds[Cycles]);
+            if (fds[e] >= 0) slot[e] = opened++;
+        }
+        ioctl(fds[Cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[Cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+        reason = "hardware counters need Linux perf_event_open";
+#endif
+    }
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool Available() const { return opened > 0; }
+    const std::string& Reason() const { return reason; }
+
+    // Current counts (one read() of the whole group), scaled if the kernel multiplexed the
+    // counters. Must be called on the thread that created the object.
+    bool Read(Values& out) const {
+#if defined(__linux__)
+        if (!Available()) return false;
+        uint64_t buffer[3 + COUNT];  // nr, time_enabled, time_running, values
+        ssize_t n = read(fds[Cycles], buffer, sizeof(buffer));
+        if (n < ssize_t(3 * sizeof(uint64_t)) || buffer[0] != uint64_t(opened)) return false;
+
+        double scale = (buffer[2] > 0 && buffer[2] < buffer[1]) ? double(buffer[1]) / double(buffer[2]) : 1.0;
+        for (int e = 0; e < COUNT; e++) {
+            out.valid[e] = slot[e] >= 0;
+            uint64_t raw = out.valid[e] ? buffer[3 + slot[e]] : 0;
+            out.value[e] = scale == 1.0 ? raw : uint64_t(double(raw) * scale);
+        }
+        return true;
+#else
+        (void)out;
+        return false;
+#endif
+    }
+};
@@ -1,49 +1,508 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <iostream>
 #include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
 #include <vector>
 #include <fstream>
-
-// Performance measurement result
+#include "CsvWriter.h"
+#include "PerfCounters.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define PERF_TIMER_HAS_TSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define PERF_TIMER_HAS_TSC 1
+#endif
+
+// Performance measurement result (one Start/Stop pair)
 struct TimingResult {
     std::string operation;
     double time_ms;
     std::string details;
 };
 
-// Performance timer and logger
+// Aggregated statistics of one scope (all calls with the same path, merged over threads)
+struct ScopeStats {
+    std::string name;
+    std::string path;     // "Parent/Child/..."
+    int depth;            // 0 = top-level scope
+    uint64_t count;
+    double total_ms;
+    double self_ms;       // total minus time in child scopes
+    double mean_us;
+    double p50_us;
+    double p99_us;
+    double max_us;
+    bool has_counters;                      // hardware counters recorded (EnableHardwareCounters)
+    double counters[PerfCounters::COUNT];   // per call: cycles, instructions, branch misses,
+                                            // LLC misses (-1 = not recorded)
+    std::string details;  // details of the last Stop
+};
+
+// Hierarchical performance timer and logger.
+// Scopes nest (Start inside Start, ScopedTimer inside ScopedTimer) and are aggregated by path
+// into count / total / mean / p50 / p99 / max. Each thread records into its own buffer without
+// locking; the buffers are merged when a report is made, so reports should be taken while no
+// instrumented work is running (e.g. after DesignBatch returns).
+// Timing uses the invariant TSC where available (a few ns per read), steady_clock otherwise.
+// Optionally every scope also records hardware counters (EnableHardwareCounters, Linux) and a
+// timeline event for trace viewers (EnableTrace, ExportTrace).
 class PerformanceTimer {
 private:
-    std::chrono::high_resolution_clock::time_point start_time;
-    std::string operation_name;
+    // Log-linear latency histogram: exact below 32 ns, then 32 sub-buckets per power of two
+    // (percentiles within 3 %)
+    static constexpr int SUB_BITS = 5;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+    static constexpr size_t THREAD_CACHE = 8;
+
+    static int Bucket(uint64_t ns) {
+        if (ns < SUB_BUCKETS) return int(ns);
+#if defined(__GNUC__) || defined(__clang__)
+        int e = 63 - __builtin_clzll(ns);
+#else
+        int e = 63;
+        while (!(ns >> e)) e--;
+#endif
+        return (e - SUB_BITS + 1) * SUB_BUCKETS + int((ns >> (e - SUB_BITS)) & (SUB_BUCKETS - 1));
+    }
+
+    // Midpoint of a bucket [ns]
+    static double BucketValue(int bucket) {
+        if (bucket < SUB_BUCKETS) return double(bucket);
+        int e = bucket / SUB_BUCKETS + SUB_BITS - 1;
+        double width = std::ldexp(1.0, e - SUB_BITS);
+        return std::ldexp(1.0, e) + (bucket % SUB_BUCKETS + 0.5) * width;
+    }
+
+    struct Node {
+        std::string name;
+        int parent = -1;
+        int firstChild = -1;
+        int nextSibling = -1;
+        uint64_t count = 0;
+        uint64_t totalNs = 0;
+        uint64_t minNs = UINT64_MAX;
+        uint64_t maxNs = 0;
+        std::vector<uint32_t> histogram;  // allocated on first sample
+        uint64_t counterCalls = 0;        // calls with hardware counters
+        uint64_t counterTotals[PerfCounters::COUNT] = {};
+        bool counterValid[PerfCounters::COUNT] = {};
+        std::string details;
+    };
+
+    // One closed scope on the timeline
+    struct TraceEvent {
+        int node;
+        uint64_t start;     // clock ticks
+        uint64_t duration;  // clock ticks
+    };
+
+    struct OpenScope {
+        int node;
+        uint64_t start;  // clock ticks
+        bool hasCounters;
+        PerfCounters::Values counters;
+    };
+
+    // Scope tree of one thread; node 0 is the root
+    struct ThreadBuffer {
+        std::thread::id thread;
+        std::vector<Node> nodes;
+        std::vector<OpenScope> open;
+        std::unique_ptr<PerfCounters> counters;  // opened on first use, for this thread only
+        std::vector<TraceEvent> trace;           // in order of closing
+        uint64_t traceDropped = 0;               // events beyond the trace limit
+
+        ThreadBuffer() : thread(std::this_thread::get_id()), nodes(1) {}
+
+        PerfCounters* Counters() {
+            if (!counters) counters = std::make_unique<PerfCounters>();
+            return counters->Available() ? counters.get() : nullptr;
+        }
+
+        int Child(int parent, std::string_view name) {
+            for (int c = nodes[parent].firstChild; c >= 0; c = nodes[c].nextSibling) {
+                if (nodes[c].name == name) return c;
+            }
+            Node n;
+            n.name = std::string(name);
+            n.parent = parent;
+            nodes.push_back(std::move(n));
+            int id = int(nodes.size()) - 1;
+            int* link = &nodes[parent].firstChild;
+            while (*link >= 0) link = &nodes[*link].nextSibling;
+            *link = id;
+            return id;
+        }
+    };
+
+    // Merged tree over all threads (report time only)
+    struct MergedNode {
+        std::string name;
+        std::vector<int> children;
+        uint64_t count = 0;
+        uint64_t totalNs = 0;
+        uint64_t minNs = UINT64_MAX;
+        uint64_t maxNs = 0;
+        std::vector<uint64_t> histogram;
+        uint64_t counterCalls = 0;
+        uint64_t counterTotals[PerfCounters::COUNT] = {};
+        bool counterValid[PerfCounters::COUNT] = {};
+        std::string details;
+    };
+
+    uint64_t id;
+    mutable std::mutex mutex;  // guards buffers and results (registration and reports only)
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
     std::vector<TimingResult> results;
     bool auto_log;
+    std::atomic<bool> hardwareCounters{ false };
+    std::string countersStatus;  // reason when the counters could not be opened
+    std::atomic<size_t> traceLimit{ 0 };  // max trace events per thread (0 = no trace)
+    uint64_t epoch;                       // clock ticks at construction (trace time 0)
+    std::thread::id owner;                // constructing thread ("Main thread" in the trace)
+
+    static uint64_t NextId() {
+        static std::atomic<uint64_t> counter{ 0 };
+        return ++counter;
+    }
+
+    static bool HasInvariantTsc() {
+#if defined(PERF_TIMER_HAS_TSC) && defined(_MSC_VER)
+        int regs[4];
+        __cpuid(regs, 0x80000000);
+        if (unsigned(regs[0]) < 0x80000007u) return false;
+        __cpuid(regs, 0x80000007);
+        return (regs[3] >> 8) & 1;
+#elif defined(PERF_TIMER_HAS_TSC)
+        unsigned a, b, c, d;
+        if (!__get_cpuid(0x80000007, &a, &b, &c, &d)) return false;
+        return (d >> 8) & 1;
+#else
+        return false;
+#endif
+    }
+
+    static uint64_t SteadyNs() {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Clock: TSC (if invariant) calibrated once against steady_clock, or steady_clock in ns
+    struct Clock {
+        bool tsc = false;
+        double nsPerTick = 1.0;
+
+        Clock() {
+#if defined(PERF_TIMER_HAS_TSC)
+            if (HasInvariantTsc()) {
+                uint64_t ns0 = SteadyNs(), t0 = __rdtsc();
+                uint64_t ns1 = ns0;
+                while (ns1 - ns0 < 2000000) ns1 = SteadyNs();  // 2 ms
+                uint64_t t1 = __rdtsc();
+                if (t1 > t0) {
+                    tsc = true;
+                    nsPerTick = double(ns1 - ns0) / double(t1 - t0);
+                }
+            }
+#endif
+        }
+    };
+
+    static const Clock& GetClock() {
+        static const Clock clock;
+        return clock;
+    }
+
+    static uint64_t Ticks() {
+#if defined(PERF_TIMER_HAS_TSC)
+        static const bool tsc = GetClock().tsc;
+        if (tsc) return __rdtsc();
+#endif
+        return SteadyNs();
+    }
+
+    static uint64_t TicksToNs(uint64_t ticks) {
+        static const double nsPerTick = GetClock().nsPerTick;
+        return uint64_t(double(ticks) * nsPerTick + 0.5);
+    }
+
+    // Buffer of the calling thread; the lock is taken only the first time a thread uses this timer.
+    // The per-thread cache is plain data (no TLS initialization guard on the hot path).
+    ThreadBuffer& Local() {
+        struct CacheEntry {
+            uint64_t timer;
+            ThreadBuffer* buffer;
+        };
+        thread_local CacheEntry cache[THREAD_CACHE];
+        thread_local size_t cacheNext;
+        for (const CacheEntry& entry : cache) {
+            if (entry.timer == id) return *entry.buffer;
+        }
+
+        ThreadBuffer* buffer = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& b : buffers) {
+                if (b->thread == std::this_thread::get_id()) buffer = b.get();
+            }
+            if (!buffer) {
+                buffers.push_back(std::make_unique<ThreadBuffer>());
+                buffer = buffers.back().get();
+            }
+        }
+        cache[cacheNext] = { id, buffer };
+        cacheNext = (cacheNext + 1) % THREAD_CACHE;
+        return *buffer;
+    }
+
+    // Close the innermost scope of the calling thread; returns its duration [ns]
+    uint64_t Leave(const std::string* details) {
+        uint64_t end = Ticks();
+        ThreadBuffer& buffer = Local();
+        if (buffer.open.empty()) return 0;
+
+        OpenScope scope = buffer.open.back();
+        buffer.open.pop_back();
+        uint64_t ns = TicksToNs(end - scope.start);
+
+        Node& node = buffer.nodes[scope.node];
+        if (node.histogram.empty()) node.histogram.assign(BUCKETS, 0);
+        node.count++;
+        node.totalNs += ns;
+        node.minNs = std::min(node.minNs, ns);
+        node.maxNs = std::max(node.maxNs, ns);
+        node.histogram[Bucket(ns)]++;
+        if (details && !details->empty()) node.details = *details;
+
+        size_t limit = traceLimit.load(std::memory_order_relaxed);
+        if (limit > 0) {
+            if (buffer.trace.size() < limit) buffer.trace.push_back({ scope.node, scope.start, end - scope.start });
+            else buffer.traceDropped++;
+        }
+
+        PerfCounters::Values now;
+        if (scope.hasCounters && buffer.counters->Read(now)) {
+            node.counterCalls++;
+            for (int e = 0; e < PerfCounters::COUNT; e++) {
+                node.counterValid[e] = now.valid[e];
+                node.counterTotals[e] += now.value[e] - scope.counters.value[e];
+            }
+        }
+        return ns;
+    }
+
+    static void MergeInto(std::vector<MergedNode>& merged, int target, const ThreadBuffer& buffer, int source) {
+        for (int c = buffer.nodes[source].firstChild; c >= 0; c = buffer.nodes[c].nextSibling) {
+            const Node& node = buffer.nodes[c];
+            int m = -1;
+            for (int child : merged[target].children) {
+                if (merged[child].name == node.name) m = child;
+            }
+            if (m < 0) {
+                merged.push_back(MergedNode());
+                m = int(merged.size()) - 1;
+                merged[m].name = node.name;
+                merged[m].histogram.assign(BUCKETS, 0);
+                merged[target].children.push_back(m);
+            }
+            MergedNode& dst = merged[m];
+            dst.count += node.count;
+            dst.totalNs += node.totalNs;
+            dst.minNs = std::min(dst.minNs, node.minNs);
+            dst.maxNs = std::max(dst.maxNs, node.maxNs);
+            for (size_t i = 0; i < node.histogram.size(); i++) dst.histogram[i] += node.histogram[i];
+            dst.counterCalls += node.counterCalls;
+            for (int e = 0; e < PerfCounters::COUNT; e++) {
+                dst.counterTotals[e] += node.counterTotals[e];
+                dst.counterValid[e] = dst.counterValid[e] || node.counterValid[e];
+            }
+            if (!node.details.empty()) dst.details = node.details;
+            MergeInto(merged, m, buffer, c);
+        }
+    }
+
+    // Percentile from the histogram, clamped to the exact [min, max] (exact for a single call)
+    static double Percentile(const MergedNode& node, double p) {
+        if (node.count == 0) return 0.0;
+        uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(p * double(node.count))));
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; b++) {
+            seen += node.histogram[b];
+            if (seen >= rank) return std::clamp(BucketValue(b), double(node.minNs), double(node.maxNs));
+        }
+        return double(node.maxNs);
+    }
+
+    static void Flatten(const std::vector<MergedNode>& merged, int index, int depth, const std::string& prefix,
+                        std::vector<ScopeStats>& out) {
+        for (int c : merged[index].children) {
+            const MergedNode& node = merged[c];
+            uint64_t childNs = 0;
+            for (int g : node.children) childNs += merged[g].totalNs;
+
+            ScopeStats s;
+            s.name = node.name;
+            s.path = prefix.empty() ? node.name : prefix + "/" + node.name;
+            s.depth = depth;
+            s.count = node.count;
+            s.total_ms = node.totalNs / 1e6;
+            s.self_ms = (node.totalNs > childNs ? node.totalNs - childNs : 0) / 1e6;
+            s.mean_us = node.count ? node.totalNs / 1e3 / double(node.count) : 0.0;
+            s.p50_us = Percentile(node, 0.50) / 1e3;
+            s.p99_us = Percentile(node, 0.99) / 1e3;
+            s.max_us = node.maxNs / 1e3;
+            s.has_counters = node.counterCalls > 0;
+            for (int e = 0; e < PerfCounters::COUNT; e++) {
+                s.counters[e] = (s.has_counters && node.counterValid[e])
+                    ? double(node.counterTotals[e]) / double(node.counterCalls) : -1.0;
+            }
+            s.details = node.details;
+            out.push_back(s);
+            Flatten(merged, c, depth + 1, s.path, out);
+        }
+    }
+
+    // Cost of one Enter/Leave pair [ns], measured once (with and without hardware counters)
+    static double MeasureOverheadNs(bool counters) {
+        PerformanceTimer probe(false);
+        if (counters) probe.EnableHardwareCounters();
+        const int n = counters ? 2000 : 20000;
+        uint64_t t0 = SteadyNs();
+        for (int i = 0; i < n; i++) {
+            probe.Enter("probe");
+            probe.Leave(nullptr);
+        }
+        return double(SteadyNs() - t0) / n;
+    }
+
+    double OverheadNs() const {
+        static const double plain = MeasureOverheadNs(false);
+        if (!hardwareCounters) return plain;
+        static const double withCounters = MeasureOverheadNs(true);
+        return withCounters;
+    }
+
+    static void WriteJsonString(CsvWriter& out, const std::string& text) {
+        out.Char('"');
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out.Char('\\');
+                out.Char(c);
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out.Char(' ');
+            } else {
+                out.Char(c);
+            }
+        }
+        out.Char('"');
+    }
+
+    static double TotalMs(const std::vector<ScopeStats>& stats) {
+        double total = 0.0;
+        for (const auto& s : stats) {
+            if (s.depth == 0) total += s.total_ms;
+        }
+        return total;
+    }
 
 public:
-    PerformanceTimer(bool enable_auto_log = true) : auto_log(enable_auto_log) {}
+    PerformanceTimer(bool enable_auto_log = true) : id(NextId()), auto_log(enable_auto_log), epoch(Ticks()),
+                                                      owner(std::this_thread::get_id()) {}
+
+    PerformanceTimer(const PerformanceTimer&) = delete;
+    PerformanceTimer& operator=(const PerformanceTimer&) = delete;
+
+    // Record cycles, instructions, branch misses and LLC misses for every scope (Linux
+    // perf_event_open, user space only, per thread). Returns false, and leaves timing as it
+    // is, if the counters cannot be opened (see HardwareCountersStatus). A counter read is a
+    // system call (about 1 us), so prefer coarse scopes while the counters are on.
+    bool EnableHardwareCounters() {
+        hardwareCounters = true;
+        ThreadBuffer& buffer = Local();
+        PerfCounters* counters = buffer.Counters();
+        std::lock_guard<std::mutex> lock(mutex);
+        countersStatus = counters ? "" : buffer.counters->Reason();
+        return counters != nullptr;
+    }
+
+    void DisableHardwareCounters() {
+        hardwareCounters = false;
+    }
+
+    // Record every closed scope as a timeline event for ExportTrace (at most maxEventsPerThread
+    // per thread, 24 bytes each; later events are counted and dropped)
+    void EnableTrace(size_t maxEventsPerThread = size_t(1) << 20) {
+        traceLimit = maxEventsPerThread;
+    }
+
+    void DisableTrace() {
+        traceLimit = 0;
+    }
+
+    // "on", "off" or the reason the counters are unavailable
+    std::string HardwareCountersStatus() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!hardwareCounters) return "off";
+        return countersStatus.empty() ? "on" : "unavailable: " + countersStatus;
+    }
+
+    // Open a scope on the calling thread, nested in the currently open one (hot path: no lock,
+    // no allocation once the scope has been seen)
+    void Enter(std::string_view name) {
+        ThreadBuffer& buffer = Local();
+        int parent = buffer.open.empty() ? 0 : buffer.open.back().node;
+        OpenScope scope;
+        scope.node = buffer.Child(parent, name);
+        scope.hasCounters = false;
+        if (hardwareCounters.load(std::memory_order_relaxed)) {
+            PerfCounters* counters = buffer.Counters();
+            scope.hasCounters = counters && counters->Read(scope.counters);
+        }
+        scope.start = Ticks();
+        buffer.open.push_back(scope);
+    }
+
+    // Close the innermost scope of the calling thread (aggregated only, not logged)
+    void Leave() {
+        Leave(nullptr);
+    }
 
-    // Start timing an operation
+    // Start timing an operation (nested in any operation still running on this thread)
     void Start(const std::string& op_name) {
-        operation_name = op_name;
-        start_time = std::chrono::high_resolution_clock::now();
+        Enter(op_name);
     }
 
-    // Stop timing and record result
+    // Stop the innermost operation, record and log the result; returns its time [ms]
     double Stop(const std::string& details = "") {
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-        double time_ms = duration.count() / 1000.0;
+        ThreadBuffer& buffer = Local();
+        if (buffer.open.empty()) return 0.0;
+        std::string operation = buffer.nodes[buffer.open.back().node].name;
+        double time_ms = Leave(&details) / 1e6;
 
         TimingResult result;
-        result.operation = operation_name;
+        result.operation = operation;
         result.time_ms = time_ms;
         result.details = details;
-        results.push_back(result);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back(result);
+        }
 
         if (auto_log) {
-            std::cout << "[PERF] " << operation_name << ": "
+            std::cout << "[PERF] " << operation << ": "
                      << std::fixed << std::setprecision(3) << time_ms << " ms";
             if (!details.empty()) {
                 std::cout << " (" << details << ")";
@@ -54,126 +513,283 @@ public:
         return time_ms;
     }
 
-    // Get all results
+    // Get all Start/Stop results in the order they finished
     const std::vector<TimingResult>& GetResults() const {
         return results;
     }
 
-    // Print summary
+    // Aggregated scope tree, depth-first, children in the order they were first entered
+    std::vector<ScopeStats> GetScopeStats() const {
+        std::vector<MergedNode> merged(1);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& buffer : buffers) {
+                MergeInto(merged, 0, *buffer, 0);
+            }
+        }
+        std::vector<ScopeStats> stats;
+        Flatten(merged, 0, 0, "", stats);
+        return stats;
+    }
+
+    // Print summary (scope tree with latency statistics)
     void PrintSummary() const {
+        std::vector<ScopeStats> stats = GetScopeStats();
+
         std::cout << "\n==========================================================\n";
         std::cout << "  PERFORMANCE SUMMARY\n";
         std::cout << "==========================================================\n\n";
 
-        double total_time = 0.0;
-        for (const auto& result : results) {
-            std::cout << std::setw(40) << std::left << result.operation << ": "
-                     << std::setw(10) << std::right << std::fixed << std::setprecision(3)
-                     << result.time_ms << " ms";
-            if (!result.details.empty()) {
-                std::cout << "  (" << result.details << ")";
+        std::cout << std::setw(40) << std::left << "Scope" << std::right
+                  << std::setw(9) << "Count" << std::setw(12) << "Total[ms]" << std::setw(11) << "Mean[us]"
+                  << std::setw(11) << "p50[us]" << std::setw(11) << "p99[us]" << std::setw(11) << "Max[us]" << "\n";
+        std::cout << std::string(105, '-') << "\n";
+
+        for (const auto& s : stats) {
+            std::string label = std::string(2 * s.depth, ' ') + s.name;
+            std::cout << std::setw(40) << std::left << label << std::right << std::fixed
+                      << std::setw(9) << s.count
+                      << std::setw(12) << std::setprecision(3) << s.total_ms
+                      << std::setw(11) << std::setprecision(2) << s.mean_us
+                      << std::setw(11) << s.p50_us << std::setw(11) << s.p99_us << std::setw(11) << s.max_us;
+            if (!s.details.empty()) {
+                std::cout << "  (" << s.details << ")";
             }
             std::cout << "\n";
-            total_time += result.time_ms;
         }
 
         std::cout << "\n" << std::string(60, '-') << "\n";
         std::cout << std::setw(40) << std::left << "TOTAL TIME" << ": "
                  << std::setw(10) << std::right << std::fixed << std::setprecision(3)
-                 << total_time << " ms\n";
+                 << TotalMs(stats) << " ms\n";
+
+        if (hardwareCounters || std::any_of(stats.begin(), stats.end(), [](const ScopeStats& s) { return s.has_counters; })) {
+            PrintCounters(stats);
+        }
         std::cout << "==========================================================\n";
     }
 
-    // Export to CSV
+    // Hardware counters per call (part of PrintSummary)
+    void PrintCounters(const std::vector<ScopeStats>& stats) const {
+        std::cout << "\nHardware counters per call (user space): " << HardwareCountersStatus() << "\n";
+        if (std::none_of(stats.begin(), stats.end(), [](const ScopeStats& s) { return s.has_counters; })) {
+            return;
+        }
+
+        std::cout << std::setw(40) << std::left << "Scope" << std::right
+                  << std::setw(13) << "Cycles" << std::setw(13) << "Instructions" << std::setw(7) << "IPC"
+                  << std::setw(13) << "BranchMisses" << std::setw(13) << "LLCMisses" << "\n";
+        std::cout << std::string(99, '-') << "\n";
+        for (const auto& s : stats) {
+            if (!s.has_counters) continue;
+            std::string label = std::string(2 * s.depth, ' ') + s.name;
+            std::cout << std::setw(40) << std::left << label << std::right << std::fixed << std::setprecision(1);
+            for (int e = 0; e < PerfCounters::COUNT; e++) {
+                if (e == PerfCounters::BranchMisses) {
+                    double ipc = s.counters[PerfCounters::Cycles] > 0.0 && s.counters[PerfCounters::Instructions] >= 0.0
+                        ? s.counters[PerfCounters::Instructions] / s.counters[PerfCounters::Cycles] : -1.0;
+                    std::cout << std::setw(7);
+                    if (ipc >= 0.0) std::cout << std::setprecision(2) << ipc << std::setprecision(1);
+                    else std::cout << "-";
+                }
+                std::cout << std::setw(13);
+                if (s.counters[e] >= 0.0) std::cout << s.counters[e];
+                else std::cout << "-";
+            }
+            std::cout << "\n";
+        }
+    }
+
+    // Export the scope tree to CSV
     void ExportToCSV(const std::string& filename) const {
-        std::ofstream file(filename);
-        if (!file.is_open()) {
+        CsvWriter out(filename);
+        if (!out.IsOpen()) {
             std::cerr << "Error: Could not open " << filename << "\n";
             return;
         }
 
         // Header
-        file << "Operation,Time_ms,Details\n";
+        // Hardware counters are per call and empty where they were not recorded
+        out.Text("Scope,Depth,Count,Total_ms,Self_ms,Mean_us,P50_us,P99_us,Max_us,"
+                 "Cycles,Instructions,BranchMisses,LLCMisses,Details\n");
 
         // Data
-        for (const auto& result : results) {
-            file << result.operation << ","
-                 << std::fixed << std::setprecision(6) << result.time_ms << ","
-                 << result.details << "\n";
+        for (const auto& s : GetScopeStats()) {
+            out.Text(s.path);
+            out.Char(',');
+            out.Integer(s.depth);
+            out.Char(',');
+            out.Integer(int64_t(s.count));
+            for (double v : { s.total_ms, s.self_ms, s.mean_us, s.p50_us, s.p99_us, s.max_us }) {
+                out.Char(',');
+                out.Fixed(v, 6);
+            }
+            for (double v : s.counters) {
+                out.Char(',');
+                if (v >= 0.0) out.Fixed(v, 1);
+            }
+            out.Char(',');
+            out.Text(s.details);
+            out.Char('\n');
         }
 
-        file.close();
+        out.Close();
         std::cout << "Performance data exported to: " << filename << "\n";
     }
 
-    // Analyze and suggest optimizations
+    // Export the timeline recorded since EnableTrace as Chrome trace-event JSON (chrome://tracing,
+    // https://ui.perfetto.dev): one complete event ("ph":"X", begin + duration) per scope call,
+    // one track per thread, so load imbalance, idle workers and serial sections are visible.
+    // Like the other reports, call it while no instrumented work is running.
+    void ExportTrace(const std::string& filename) const {
+        CsvWriter out(filename);
+        if (!out.IsOpen()) {
+            std::cerr << "Error: Could not open " << filename << "\n";
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        out.Text("{\"traceEvents\":[\n");
+        out.Text("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"PerformanceTimer\"}}");
+
+        size_t events = 0;
+        uint64_t dropped = 0;
+        int worker = 0;
+        for (size_t t = 0; t < buffers.size(); t++) {
+            const ThreadBuffer& buffer = *buffers[t];
+            int tid = int(t) + 1;
+            std::string threadName = buffer.thread == owner ? "Main thread" : "Thread " + std::to_string(++worker);
+            out.Text(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+            out.Integer(tid);
+            out.Text(",\"args\":{\"name\":");
+            WriteJsonString(out, threadName);
+            out.Text("}}");
+
+            // Parents before children: by start time, longer first
+            std::vector<TraceEvent> trace = buffer.trace;
+            std::sort(trace.begin(), trace.end(), [](const TraceEvent& a, const TraceEvent& b) {
+                return a.start != b.start ? a.start < b.start : a.duration > b.duration;
+            });
+            for (const TraceEvent& e : trace) {
+                double ts = double(int64_t(e.start - epoch)) * GetClock().nsPerTick / 1e3;
+                out.Text(",\n{\"name\":");
+                WriteJsonString(out, buffer.nodes[e.node].name);
+                out.Text(",\"ph\":\"X\",\"ts\":");
+                out.Fixed(ts, 3);
+                out.Text(",\"dur\":");
+                out.Fixed(TicksToNs(e.duration) / 1e3, 3);
+                out.Text(",\"pid\":1,\"tid\":");
+                out.Integer(tid);
+                out.Char('}');
+            }
+            events += trace.size();
+            dropped += buffer.traceDropped;
+        }
+        out.Text("\n],\"displayTimeUnit\":\"ns\"}\n");
+
+        if (!out.Close()) {
+            std::cerr << "Error: Writing " << filename << " failed\n";
+            return;
+        }
+        std::cout << "Trace exported to: " << filename << " (" << events << " events";
+        if (dropped > 0) {
+            std::cout << ", " << dropped << " dropped beyond the trace limit";
+        }
+        std::cout << ")\n";
+    }
+
+    // Analyze the measured scope tree: hot paths by self time, tail latency, timer overhead
     void Analyze() const {
+        std::vector<ScopeStats> stats = GetScopeStats();
+
         std::cout << "\n==========================================================\n";
         std::cout << "  PERFORMANCE ANALYSIS\n";
         std::cout << "==========================================================\n\n";
 
-        // Calculate statistics
-        double total_time = 0.0;
-        double max_time = 0.0;
-        std::string slowest_operation;
-
-        for (const auto& result : results) {
-            total_time += result.time_ms;
-            if (result.time_ms > max_time) {
-                max_time = result.time_ms;
-                slowest_operation = result.operation;
-            }
+        double total_time = TotalMs(stats);
+        uint64_t calls = 0;
+        for (const auto& s : stats) calls += s.count;
+        size_t threads;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads = buffers.size();
         }
 
-        std::cout << "Total operations: " << results.size() << "\n";
+        std::cout << "Scopes: " << stats.size() << " (" << calls << " calls on " << threads << " threads)\n";
         std::cout << "Total time: " << std::fixed << std::setprecision(3) << total_time << " ms\n";
-        std::cout << "Average time per operation: " << (total_time / results.size()) << " ms\n";
-        std::cout << "Slowest operation: " << slowest_operation << " (" << max_time << " ms)\n\n";
+        std::cout << "Timer overhead: " << std::setprecision(1) << OverheadNs() << " ns per scope ("
+                  << (GetClock().tsc ? "TSC" : "steady_clock") << ")\n";
+        std::cout << "Hardware counters: " << HardwareCountersStatus() << "\n\n";
 
-        // Percentage breakdown
-        std::cout << "Time breakdown by percentage:\n";
-        for (const auto& result : results) {
-            double percentage = (result.time_ms / total_time) * 100.0;
-            if (percentage > 1.0) {  // Only show operations > 1%
-                std::cout << "  " << std::setw(40) << std::left << result.operation
-                         << ": " << std::setw(6) << std::right << std::fixed
-                         << std::setprecision(2) << percentage << " %\n";
-            }
+        if (stats.empty() || total_time <= 0.0) {
+            std::cout << "\n";
+            return;
         }
 
+        // Hot paths: where the time is spent exclusive of nested scopes
+        std::vector<const ScopeStats*> hot;
+        for (const auto& s : stats) hot.push_back(&s);
+        std::sort(hot.begin(), hot.end(), [](const ScopeStats* a, const ScopeStats* b) { return a->self_ms > b->self_ms; });
+
+        std::cout << "Hot paths (self time):\n";
+        for (size_t i = 0; i < hot.size() && i < 5; i++) {
+            double percentage = hot[i]->self_ms / total_time * 100.0;
+            if (percentage < 1.0) break;
+            std::cout << "  " << std::setw(6) << std::right << std::setprecision(2) << percentage << " %  "
+                      << hot[i]->path << " (" << hot[i]->count << " x " << hot[i]->mean_us << " us)\n";
+        }
         std::cout << "\n";
 
-        // Optimization suggestions
+        // Optimization suggestions from the latency distributions
         std::cout << "OPTIMIZATION SUGGESTIONS:\n";
         std::cout << "-------------------------\n";
 
-        for (const auto& result : results) {
-            double percentage = (result.time_ms / total_time) * 100.0;
-
-            if (result.operation.find("ConcreteIntegration") != std::string::npos && percentage > 20) {
-                std::cout << "- Concrete integration takes " << percentage
-                         << "% of time. Consider:\n";
-                std::cout << "  * Use analytical formulas instead of numerical integration\n";
-                std::cout << "  * Reduce number of integration segments (currently 100)\n";
-                std::cout << "  * Use lookup tables for common strain states\n\n";
+        bool any = false;
+        for (const auto& s : stats) {
+            if (s.count >= 100 && s.p50_us > 0.0 && s.p99_us > 5.0 * s.p50_us) {
+                any = true;
+                std::cout << "- " << s.path << ": p99 is " << std::setprecision(1) << s.p99_us / s.p50_us
+                          << "x the median (" << std::setprecision(2) << s.p50_us << " / " << s.p99_us
+                          << " us). Look for slow paths (fallbacks, allocations, contention)\n";
             }
-
-            if (result.operation.find("InteractionDiagram") != std::string::npos && percentage > 30) {
-                std::cout << "- Diagram generation takes " << percentage
-                         << "% of time. Consider:\n";
-                std::cout << "  * Cache diagrams for common geometries\n";
-                std::cout << "  * Reduce interpolation density (fewer points)\n";
-                std::cout << "  * Generate diagram in parallel threads\n\n";
+            if (s.count >= 1000 && s.mean_us * 1e3 < 20.0 * OverheadNs()) {
+                any = true;
+                std::cout << "- " << s.path << ": timer overhead is about " << std::setprecision(0)
+                          << OverheadNs() / (s.mean_us * 1e3) * 100.0
+                          << " % of the measured time and adds to every enclosing scope; instrument at a coarser level\n";
             }
 
-            if (result.operation.find("Design") != std::string::npos && result.time_ms > 5.0) {
-                std::cout << "- Design operation is slow (" << result.time_ms
-                         << " ms). Consider:\n";
-                std::cout << "  * Better bracketing algorithm (binary search)\n";
-                std::cout << "  * Cache recent lookups\n";
-                std::cout << "  * Use spatial indexing (R-tree) for diagram points\n\n";
+            // Hardware counters: what bounds the scope (only scopes that matter for the total)
+            double cycles = s.counters[PerfCounters::Cycles];
+            double instructions = s.counters[PerfCounters::Instructions];
+            if (s.has_counters && s.total_ms >= 0.05 * total_time && cycles > 0.0 && instructions > 0.0) {
+                double ipc = instructions / cycles;
+                double branchMpki = s.counters[PerfCounters::BranchMisses] * 1000.0 / instructions;
+                double cacheMpki = s.counters[PerfCounters::CacheMisses] * 1000.0 / instructions;
+                if (branchMpki > 10.0) {
+                    any = true;
+                    std::cout << "- " << s.path << ": " << std::setprecision(1) << branchMpki
+                              << " branch misses per 1000 instructions (IPC " << std::setprecision(2) << ipc
+                              << "); branch-bound, make the hot branches predictable or branch-free\n";
+                }
+                if (cacheMpki > 1.0 && ipc < 1.0) {
+                    any = true;
+                    std::cout << "- " << s.path << ": " << std::setprecision(1) << cacheMpki
+                              << " LLC misses per 1000 instructions at IPC " << std::setprecision(2) << ipc
+                              << "; memory-bound, improve locality (smaller or columnar data)\n";
+                }
             }
         }
+        if (hot.front()->self_ms / total_time > 0.5 && hot.front()->count > 1) {
+            any = true;
+            std::cout << "- " << hot.front()->path << " dominates (" << std::setprecision(0)
+                      << hot.front()->self_ms / total_time * 100.0
+                      << " % self time); optimize it first or add nested scopes to split it\n";
+        }
+        if (!any) {
+            std::cout << "- No tail-latency or overhead issues detected\n";
+        }
+        std::cout << "\n";
 
         // General suggestions
         std::cout << "GENERAL RECOMMENDATIONS:\n";
@@ -194,20 +810,22 @@ public:
     }
 };
 
-// RAII-style timer for automatic start/stop
+// RAII scope: nests in the enclosing scope of the same thread and is aggregated into
+// count / mean / percentiles without logging, so it can be used inside hot loops
 class ScopedTimer {
 private:
     PerformanceTimer& timer;
-    std::string operation;
-    std::string details;
 
 public:
-    ScopedTimer(PerformanceTimer& t, const std::string& op, const std::string& det = "")
-        : timer(t), operation(op), details(det) {
-        timer.Start(operation);
+    ScopedTimer(PerformanceTimer& t, std::string_view op)
+        : timer(t) {
+        timer.Enter(op);
     }
 
     ~ScopedTimer() {
-        timer.Stop(details);
+        timer.Leave();
     }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
 };
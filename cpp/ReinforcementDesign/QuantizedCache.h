@@ -0,0 +1,296 @@
+#pragma once
+#include "MaterialProperties.h"
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+// Concurrent memo cache for (section, N, M) queries, e.g. designs (DesignCache in
+// ReinforcementDesigner.h).
+//
+// The key is the cell of the loads on a fixed grid: N rounded down to its step, M away from
+// zero (|M| up). The value is computed from the cell alone - the designer designs its corners
+// and keeps the most demanding one - so a result depends only on its key, never on which
+// query came first or on which thread. A cell whose corners do not cover the loads inside it
+// is stored as a pass: its queries are computed exactly every time (see
+// ReinforcementDesignerT::SetCache).
+// Memory is fixed at construction: a power-of-two table of cache-line slots, 4-way set
+// associative (a key lives in one of four neighbouring slots); a new key takes an empty slot
+// of its set, or else replaces one picked by its hash.
+//
+// No locks: every slot carries a version counter (a seqlock). Readers copy the slot and retry
+// nothing - if the version changed meanwhile, the query counts as a miss.
+// A writer that finds the slot busy skips the insert. Hit/miss counters are striped per
+// thread, so the hit path writes no shared cache line.
+template <class Value>
+class QuantizedCache {
+    static_assert(std::is_trivially_copyable<Value>::value, "cached values are copied word by word");
+
+public:
+    // Loads of a key: N in [lowerN, upperN], M between innerM and outerM, |innerM| <= |outerM|
+    // (equal bounds for exact keys)
+    struct Cell {
+        double lowerN, upperN;
+        double innerM, outerM;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t inserts = 0;
+        uint64_t passes = 0;  // queries of pass cells, computed exactly
+
+        double HitRate() const {
+            const uint64_t queries = hits + misses + passes;
+            return queries > 0 ? double(hits) / double(queries) : 0.0;
+        }
+    };
+
+private:
+    static constexpr size_t VALUE_WORDS = (sizeof(Value) + 7) / 8;
+    static constexpr size_t COUNTER_STRIPES = 16;
+    static constexpr size_t WAYS = 4;
+    static constexpr uint64_t WRITING = 1;
+    static constexpr uint64_t FILLED = 2;
+    static constexpr uint64_t PASS = 4;  // filled, but without a value: compute exactly
+    static constexpr uint64_t FLAGS = WRITING | FILLED | PASS;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> version{ 0 };  // WRITING, FILLED, PASS flags, + 8 per write
+        std::atomic<uint64_t> key[3];        // section, quantized N, quantized M
+        std::atomic<uint64_t> value[VALUE_WORDS];
+    };
+
+    struct alignas(64) Counter {
+        std::atomic<uint64_t> hits{ 0 };
+        std::atomic<uint64_t> misses{ 0 };
+        std::atomic<uint64_t> inserts{ 0 };
+        std::atomic<uint64_t> passes{ 0 };
+    };
+
+    double resolutionN, resolutionM;
+    double inverseN, inverseM;  // 1 / resolution
+    size_t slotCount;
+    std::unique_ptr<Slot[]> slots;
+    std::unique_ptr<Counter[]> counters;
+
+    Counter& LocalCounter() const {
+        static std::atomic<size_t> nextStripe{ 0 };
+        thread_local size_t stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % COUNTER_STRIPES;
+        return counters[stripe];
+    }
+
+    // Rounded load in units of the resolution (resolution 0: the exact bits), down or away
+    // from zero; false if the load cannot be represented (not finite, or too large for the
+    // resolution)
+    static bool Quantize(double v, double resolution, double inverse, bool awayFromZero, uint64_t& q) {
+        if (resolution <= 0.0) {
+            v += 0.0;  // -0.0 and 0.0 alike
+            std::memcpy(&q, &v, sizeof(q));
+            return std::isfinite(v);
+        }
+        double scaled = v * inverse;
+        double r = awayFromZero && scaled >= 0.0 ? std::ceil(scaled) : std::floor(scaled);
+        if (!(std::abs(r) < 4.0e18)) return false;
+        q = uint64_t(int64_t(r));
+        return true;
+    }
+
+    static double Dequantize(uint64_t q, double resolution, double v) {
+        return resolution > 0.0 ? double(int64_t(q)) * resolution : v;
+    }
+
+    static uint64_t Mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    static uint64_t Hash(const uint64_t (&key)[3]) {
+        return Mix(key[0] ^ (key[1] * 0x9e3779b97f4a7c15ull) ^ (key[2] * 0xc2b2ae3d27d4eb4full));
+    }
+
+    // First slot of the key's set
+    size_t SetOf(uint64_t hash) const {
+        return size_t(hash) & (slotCount - 1) & ~(WAYS - 1);
+    }
+
+    // Entry of the key; pass = a pass cell (value not set)
+    bool Find(const uint64_t (&key)[3], Value& value, bool& pass) const {
+        size_t set = SetOf(Hash(key));
+        for (size_t w = 0; w < WAYS; w++) {
+            if (FindIn(slots[set + w], key, value, pass)) return true;
+        }
+        return false;
+    }
+
+    static bool FindIn(Slot& slot, const uint64_t (&key)[3], Value& value, bool& pass) {
+        uint64_t before = slot.version.load(std::memory_order_acquire);
+        if ((before & (WRITING | FILLED)) != FILLED) return false;
+        for (size_t i = 0; i < 3; i++) {
+            if (slot.key[i].load(std::memory_order_relaxed) != key[i]) return false;
+        }
+        pass = (before & PASS) != 0;
+
+        uint64_t words[VALUE_WORDS];
+        for (size_t i = 0; i < VALUE_WORDS; i++) words[i] = slot.value[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.version.load(std::memory_order_relaxed) != before) return false;
+
+        std::memcpy(&value, words, sizeof(Value));
+        return true;
+    }
+
+    // Seqlock write: flag the slot, store, publish with the next version; false if another
+    // thread is writing the slot
+    static bool Lock(Slot& slot, uint64_t& version) {
+        version = slot.version.load(std::memory_order_relaxed);
+        if ((version & WRITING) ||
+            !slot.version.compare_exchange_strong(version, version | WRITING, std::memory_order_acquire)) {
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        return true;
+    }
+
+    static void Unlock(Slot& slot, uint64_t version, bool filled, bool pass = false) {
+        slot.version.store(((version & ~FLAGS) + 8) | (filled ? FILLED : 0) | (pass ? PASS : 0),
+                           std::memory_order_release);
+    }
+
+    bool Insert(const uint64_t (&key)[3], const Value& value, bool pass) {
+        // Empty slot of the set first, else a random victim (a fixed one could make two hot
+        // keys evict each other forever)
+        thread_local uint64_t random = 0x853c49e6748fea9bull;
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        size_t set = SetOf(Hash(key));
+        size_t way = size_t(random >> 32) & (WAYS - 1);
+        for (size_t w = 0; w < WAYS; w++) {
+            if (!(slots[set + w].version.load(std::memory_order_relaxed) & FILLED)) {
+                way = w;
+                break;
+            }
+        }
+        Slot& slot = slots[set + way];
+        uint64_t version;
+        if (!Lock(slot, version)) return false;
+
+        uint64_t words[VALUE_WORDS] = {};
+        std::memcpy(words, &value, sizeof(Value));
+        for (size_t i = 0; i < 3; i++) slot.key[i].store(key[i], std::memory_order_relaxed);
+        for (size_t i = 0; i < VALUE_WORDS; i++) slot.value[i].store(words[i], std::memory_order_relaxed);
+        Unlock(slot, version, true, pass);
+        return true;
+    }
+
+public:
+    /// <summary>
+    /// Cache with N rounded down to resolutionN [N] and M away from zero to resolutionM [Nm]
+    /// (0 = exact values only), using at most maxBytes of memory for the table (at least
+    /// one set of 4 entries)
+    /// </summary>
+    explicit QuantizedCache(double resolutionN = 1.0, double resolutionM = 1.0, size_t maxBytes = size_t(32) << 20)
+        : resolutionN(resolutionN), resolutionM(resolutionM),
+          inverseN(resolutionN > 0.0 ? 1.0 / resolutionN : 0.0), inverseM(resolutionM > 0.0 ? 1.0 / resolutionM : 0.0),
+          slotCount(WAYS) {
+        while (slotCount * 2 * sizeof(Slot) <= maxBytes) slotCount *= 2;
+        slots.reset(new Slot[slotCount]);
+        counters.reset(new Counter[COUNTER_STRIPES]);
+    }
+
+    QuantizedCache(const QuantizedCache&) = delete;
+    QuantizedCache& operator=(const QuantizedCache&) = delete;
+
+    /// <summary>
+    /// Cached value for the loads of a section. On a miss computeCell(cell, value) computes the
+    /// value of their Cell and returns whether it holds for every load of the cell; if it does
+    /// the value is stored for the next query, else the cell is stored as a pass and this and
+    /// every later query of it get computeLoads(loads). Thread-safe; the callbacks run outside
+    /// any lock and may run twice for the same key when two threads miss at once.
+    /// </summary>
+    template <class ComputeCell, class ComputeLoads>
+    Value GetOrCompute(uint64_t section, const DesignLoads& loads, const ComputeCell& computeCell,
+                       const ComputeLoads& computeLoads) {
+        Counter& counter = LocalCounter();
+        uint64_t key[3] = { section, 0, 0 };
+        if (!Quantize(loads.N, resolutionN, inverseN, false, key[1]) ||
+            !Quantize(loads.M, resolutionM, inverseM, true, key[2])) {
+            counter.misses.fetch_add(1, std::memory_order_relaxed);
+            return computeLoads(loads);
+        }
+
+        Value value{};
+        bool pass = false;
+        if (Find(key, value, pass)) {
+            if (pass) {
+                counter.passes.fetch_add(1, std::memory_order_relaxed);
+                return computeLoads(loads);
+            }
+            counter.hits.fetch_add(1, std::memory_order_relaxed);
+            return value;
+        }
+        counter.misses.fetch_add(1, std::memory_order_relaxed);
+
+        pass = !computeCell(CellOf(loads), value);
+        if (Insert(key, value, pass)) counter.inserts.fetch_add(1, std::memory_order_relaxed);
+        return pass ? computeLoads(loads) : value;
+    }
+
+    // Cell the cache computes the loads from: the N step and the M step around the loads
+    Cell CellOf(const DesignLoads& loads) const {
+        uint64_t qN, qM;
+        if (!Quantize(loads.N, resolutionN, inverseN, false, qN) || !Quantize(loads.M, resolutionM, inverseM, true, qM)) {
+            return { loads.N, loads.N, loads.M, loads.M };
+        }
+        Cell cell;
+        cell.lowerN = Dequantize(qN, resolutionN, loads.N);
+        cell.upperN = resolutionN > 0.0 ? Dequantize(qN + 1, resolutionN, loads.N) : cell.lowerN;
+        cell.outerM = Dequantize(qM, resolutionM, loads.M);
+        const int64_t m = int64_t(qM);
+        cell.innerM = resolutionM > 0.0 ? Dequantize(uint64_t(m > 0 ? m - 1 : (m < 0 ? m + 1 : 0)), resolutionM, loads.M)
+                                        : cell.outerM;
+        return cell;
+    }
+
+    // Counters summed over all threads (exact once concurrent queries have returned)
+    Stats GetStats() const {
+        Stats stats;
+        for (size_t i = 0; i < COUNTER_STRIPES; i++) {
+            stats.hits += counters[i].hits.load(std::memory_order_relaxed);
+            stats.misses += counters[i].misses.load(std::memory_order_relaxed);
+            stats.inserts += counters[i].inserts.load(std::memory_order_relaxed);
+            stats.passes += counters[i].passes.load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+    // Drop all entries and counters; safe during queries (entries inserted meanwhile may survive)
+    void Clear() {
+        for (size_t i = 0; i < slotCount; i++) {
+            uint64_t version;
+            if (Lock(slots[i], version)) Unlock(slots[i], version, false);
+        }
+        for (size_t i = 0; i < COUNTER_STRIPES; i++) {
+            counters[i].hits.store(0, std::memory_order_relaxed);
+            counters[i].misses.store(0, std::memory_order_relaxed);
+            counters[i].inserts.store(0, std::memory_order_relaxed);
+            counters[i].passes.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Number of entries the table can hold
+    size_t Capacity() const {
+        return slotCount;
+    }
+
+    // Memory of the table and counters [bytes]
+    size_t MemoryBytes() const {
+        return slotCount * sizeof(Slot) + COUNTER_STRIPES * sizeof(Counter);
+    }
+};
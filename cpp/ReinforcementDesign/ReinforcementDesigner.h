@@ -7,6 +7,13 @@
 #include <iomanip>
 #include <vector>
 #include <algorithm>
+#include <limits>
+#include <memory>
+#include "WorkStealingPool.h"
+#include "DiagramCache.h"
+#include "LoadEnvelope.h"
+#include "QuantizedCache.h"
+#include "PerformanceTimer.h"
 
 // Design result structure
 struct DesignResult {
@@ -20,89 +27,151 @@ struct DesignResult {
     double M_calc;       // [Nm] calculated moment
     double errorAbs;     // [Nm] absolute moment error
     double errorRel;     // [-] relative moment error
-    int iterations;      // number of iterations (not used with diagram lookup)
+    int iterations;      // number of iterations (0 for diagram interpolation, -1 enveloped, see DesignEnvelope)
 };
 
-// Design algorithm using pre-generated interaction diagram
-class ReinforcementDesigner {
+// Memo cache of designs, keyed by ReinforcementDesignerT::SectionId and the (N, M) cell;
+// one cache can be shared by any number of designers and threads. Each entry is the most
+// demanding design of its cell's corners, or a pass, see ReinforcementDesignerT::SetCache.
+using DesignCache = QuantizedCache<DesignResult>;
+
+// Solver used by ReinforcementDesigner::Design
+enum class DesignSolver {
+    Interpolation,  // linear interpolation between bracketing diagram points
+    Newton          // exact strain state by safeguarded Newton iteration on the analytical integrator
+};
+
+// Design algorithm using pre-generated interaction diagram, templated on the concrete and steel
+// laws (MaterialLaws.h). ReinforcementDesigner is the EC2 parabola-rectangle / bilinear steel instance.
+template <class ConcreteLaw = MaterialLaws::ParabolaRectangle, class SteelLaw = MaterialLaws::BilinearSteel>
+class ReinforcementDesignerT {
+public:
+    static constexpr int NEWTON_MAX_ITERATIONS = 50;
+    static constexpr double NEWTON_TOLERANCE = 1e-10;  // relative to |fcd|*b*h^2
+
 private:
     SectionGeometry geom;
     ConcreteProperties concrete;
     SteelProperties steel;
-    std::vector<DiagramPoint> diagram;  // Pre-generated interaction diagram (As1=0, As2=0)
-
-    // Find two points on diagram that bracket the target moment
-    // Returns indices of points before and after target M at given N
-    std::pair<int, int> FindBracketingPoints(double N_target, double M_target) {
-        // First, find points with similar N values
-        // For pure bending (N=0), we need to find the range where M varies
-
-        int bestIdx = -1;
-        double minError = 1e100;
-
-        // Find point closest to target N
-        for (size_t i = 0; i < diagram.size(); i++) {
-            double N_diagram = diagram[i].N * 1000.0;  // kN to N
-            double error = std::abs(N_diagram - N_target);
-            if (error < minError) {
-                minError = error;
-                bestIdx = i;
+    ConcreteLaw concreteLaw;  // built once from concrete
+    SteelLaw steelLaw;        // built once from steel
+    DiagramView diagram;                       // Pre-generated interaction diagram (As1=0, As2=0), SoA columns
+    std::shared_ptr<const void> diagramStorage;  // keeps the diagram columns alive (owned, cached or mapped)
+    DesignSolver solver;
+    std::shared_ptr<WorkStealingPool> pool;  // created on first DesignBatch call
+    unsigned threadCount = 0;                // 0 = all hardware threads
+    PerformanceTimer* profiler = nullptr;    // per-case "Design" scopes in DesignBatch (optional)
+    std::shared_ptr<DesignCache> cache;      // in front of quiet Design calls (optional)
+    uint64_t sectionId = 0;                  // hash of section, materials, laws and diagram
+
+    // Bracketing index, built once in the constructor.
+    // Adding As2 moves a diagram point along (dN, dM) = Fs2 * (1, z2), so the strain state
+    // for a load (N, M) is where the diagram crosses the line M - z2*N = M_target - z2*N_target.
+    // The key per point is therefore the moment about the As2 layer, g = M - z2*N, which
+    // combines N and M. The diagram is split into runs monotone in g, each stored in
+    // ascending key order, so a lookup is one binary search per run (typically 1-2 runs).
+    std::vector<double> bracketKeys;                    // [Nm] g, ascending within each run
+    std::vector<int> bracketIdx;                        // diagram index for each key
+    std::vector<std::pair<size_t, size_t>> bracketRuns; // [begin, end) into bracketKeys
+
+    // Moment about the As2 layer (z2 = lever arm of As2 from centroid)
+    double BracketKey(double N, double M) const {
+        double z2 = geom.h / 2.0 - geom.d2;
+        return M - z2 * N;
+    }
+
+    void BuildBracketIndex() {
+        bracketKeys.clear();
+        bracketIdx.clear();
+        bracketRuns.clear();
+
+        int n = (int)diagram.Size();
+        if (n < 2) return;
+
+        bracketKeys.reserve(n + 8);
+        bracketIdx.reserve(n + 8);
+
+        auto key = [&](int i) { return BracketKey(diagram.N[i] * 1000.0, diagram.M[i] * 1000.0); };
+
+        int runStart = 0;
+        int direction = 0;  // +1 non-decreasing, -1 non-increasing, 0 not yet known
+        auto closeRun = [&](int runEnd) {
+            size_t begin = bracketKeys.size();
+            if (direction >= 0) {
+                for (int i = runStart; i <= runEnd; i++) { bracketKeys.push_back(key(i)); bracketIdx.push_back(i); }
+            } else {
+                for (int i = runEnd; i >= runStart; i--) { bracketKeys.push_back(key(i)); bracketIdx.push_back(i); }
+            }
+            bracketRuns.push_back({begin, bracketKeys.size()});
+        };
+
+        for (int i = 0; i < n - 1; i++) {
+            double d = key(i + 1) - key(i);
+            int step = (d > 0.0) ? 1 : (d < 0.0 ? -1 : 0);
+            if (step != 0 && direction != 0 && step != direction) {
+                closeRun(i);  // turning point is shared by both runs
+                runStart = i;
+                direction = step;
+            } else if (step != 0) {
+                direction = step;
             }
         }
+        closeRun(n - 1);
+    }
 
-        if (bestIdx < 0) return {-1, -1};
+    // Find two neighbouring diagram points whose strain states bracket equilibrium for (N, M).
+    // O(runs * log n); returns {-1, -1} when the load is outside the feasible range.
+    std::pair<int, int> FindBracketingPoints(double N_target, double M_target) const {
+        double g = BracketKey(N_target, M_target);
+        if (!std::isfinite(g)) return {-1, -1};  // NaN or inf in N or M passes every range check
 
-        // Now search around this point for M bracketing
-        // Look for segment where M changes from below to above target (or vice versa)
+        for (const auto& run : bracketRuns) {
+            auto first = bracketKeys.begin() + run.first;
+            auto last = bracketKeys.begin() + run.second;
+            if (run.second - run.first < 2 || g < *first || g > *(last - 1)) continue;
 
-        for (int i = 0; i < (int)diagram.size() - 1; i++) {
-            double N1 = diagram[i].N * 1000.0;
-            double N2 = diagram[i + 1].N * 1000.0;
-            double M1 = diagram[i].M * 1000.0;
-            double M2 = diagram[i + 1].M * 1000.0;
+            size_t pos = std::lower_bound(first, last, g) - bracketKeys.begin();
+            if (pos == run.first) pos++;  // g equals the run minimum
 
-            // Check if both points have similar N (within tolerance)
-            double N_mid = (N1 + N2) / 2.0;
-            if (std::abs(N_mid - N_target) < std::abs(N_target) * 0.1 + 1000.0) {
-                // Check if M brackets target
-                if ((M1 <= M_target && M_target <= M2) || (M2 <= M_target && M_target <= M1)) {
-                    return {i, i + 1};
-                }
-            }
+            int i1 = bracketIdx[pos - 1];
+            int i2 = bracketIdx[pos];
+            return {std::min(i1, i2), std::max(i1, i2)};
         }
 
         return {-1, -1};
     }
 
     // Linear interpolation between two diagram points to find required As2
-    DesignResult InterpolateDesign(const DiagramPoint& p1, const DiagramPoint& p2,
-                                   double N_target, double M_target) {
+    DesignResult InterpolateDesign(int idx1, int idx2, double N_target, double M_target) const {
+        const DiagramView& d = diagram;
+
         DesignResult result;
         result.converged = false;
 
-        // Convert to consistent units (N, Nm)
-        double M1 = p1.M * 1000.0;
-        double M2 = p2.M * 1000.0;
+        // Interpolation parameter from the bracketing key, which varies with both N and M
+        // (consistent units N, Nm)
+        double g1 = BracketKey(d.N[idx1] * 1000.0, d.M[idx1] * 1000.0);
+        double g2 = BracketKey(d.N[idx2] * 1000.0, d.M[idx2] * 1000.0);
+        double gTarget = BracketKey(N_target, M_target);
 
-        // Interpolation parameter
         double t = 0.5;
-        if (std::abs(M2 - M1) > 1e-6) {
-            t = (M_target - M1) / (M2 - M1);
+        if (std::abs(g2 - g1) > 1e-6) {
+            t = (gTarget - g1) / (g2 - g1);
         }
 
         // Clamp t to [0, 1]
         t = std::max(0.0, std::min(1.0, t));
 
         // Interpolate all properties
-        result.epsTop = (p1.epsTop + t * (p2.epsTop - p1.epsTop)) / 1000.0;  // per mille to absolute
-        result.epsBot = (p1.epsBot + t * (p2.epsBot - p1.epsBot)) / 1000.0;
-        result.epsS2 = (p1.epsS2 + t * (p2.epsS2 - p1.epsS2)) / 1000.0;
-        result.sigmaS2 = (p1.sigS2 + t * (p2.sigS2 - p1.sigS2)) * 1e6;  // MPa to Pa
+        result.epsTop = (d.epsTop[idx1] + t * (d.epsTop[idx2] - d.epsTop[idx1])) / 1000.0;  // per mille to absolute
+        result.epsBot = (d.epsBot[idx1] + t * (d.epsBot[idx2] - d.epsBot[idx1])) / 1000.0;
+        result.epsS2 = (d.epsS2[idx1] + t * (d.epsS2[idx2] - d.epsS2[idx1])) / 1000.0;
+        result.sigmaS2 = (d.sigS2[idx1] + t * (d.sigS2[idx2] - d.sigS2[idx1])) * 1e6;  // MPa to Pa
 
         // Calculate required As2 from equilibrium
         // At this strain state, we have concrete forces - USE FAST ANALYTICAL METHOD
         ConcreteForces cf = ConcreteIntegrationFast::CalculateForce(
-            result.epsTop, result.epsBot, geom.b, geom.h, concrete
+            result.epsTop, result.epsBot, geom.b, geom.h, concreteLaw
         );
 
         // Required As2 for equilibrium: N = Fc + As2 * sigmaS2
@@ -132,35 +201,107 @@ private:
         return result;
     }
 
-public:
-    // Constructor: generates interaction diagram once
-    ReinforcementDesigner(const SectionGeometry& g, const ConcreteProperties& c,
-                         const SteelProperties& s, int diagramDensity = 10)
-        : geom(g), concrete(c), steel(s) {
+    // Equilibrium residual about the As2 layer: with As2 eliminated from N = Fc + As2*sigmaS2,
+    // M = Mc + (N_target - Fc) * z2 must equal M_target (z2 = lever arm of As2 from centroid)
+    double MomentResidual(double Fc, double Mc, double N_target, double M_target) const {
+        double z2 = geom.h / 2.0 - geom.d2;
+        return Mc + (N_target - Fc) * z2 - M_target;
+    }
 
-        std::cout << "Generating interaction diagram (As1=0, As2=0)...\n";
+    // Exact design by safeguarded Newton iteration along the strain line through p1 -> p2,
+    // warm-started from the bracket found by FindBracketingPoints.
+    // Strains between neighbouring diagram points lie on one straight line in (epsTop, epsBot),
+    // so the line parameter t in [0, 1] is the only unknown; As2 follows from N equilibrium.
+    DesignResult NewtonDesign(int idx1, int idx2, double N_target, double M_target) const {
+        DesignResult result = {};
+        result.converged = false;
+        result.iterations = 0;
+
+        const DiagramView& d = diagram;
+
+        double epsTop1 = d.epsTop[idx1] / 1000.0;
+        double epsBot1 = d.epsBot[idx1] / 1000.0;
+        double dEpsTop = d.epsTop[idx2] / 1000.0 - epsTop1;
+        double dEpsBot = d.epsBot[idx2] / 1000.0 - epsBot1;
+
+        // Chain rule factors: k = (epsTop - epsBot) / h, q = (epsTop + epsBot) / 2
+        double dk_dt = (dEpsTop - dEpsBot) / geom.h;
+        double dq_dt = (dEpsTop + dEpsBot) / 2.0;
+        double z2 = geom.h / 2.0 - geom.d2;
+
+        // Residuals at the bracket ends come from the stored diagram (As=0: N=Fc, M=Mc)
+        double tLo = 0.0, tHi = 1.0;
+        double fLo = MomentResidual(d.N[idx1] * 1000.0, d.M[idx1] * 1000.0, N_target, M_target);
+        double fHi = MomentResidual(d.N[idx2] * 1000.0, d.M[idx2] * 1000.0, N_target, M_target);
+        if (!(fLo * fHi <= 0.0)) {
+            return result;  // root not bracketed, or a non-finite load
+        }
 
-        // Generate diagram with As1=0, As2=0 (concrete only, for finding strain states)
-        InteractionDiagram diagramGen(geom, concrete, steel, 0.0, 0.0);
-        diagram = diagramGen.Generate(diagramDensity);
+        // Warm start: secant between the bracket ends
+        double t = (std::abs(fHi - fLo) > 0.0) ? fLo / (fLo - fHi) : 0.5;
+        double tol = NEWTON_TOLERANCE * std::abs(concrete.fcd) * geom.b * geom.h * geom.h;
 
-        std::cout << "Diagram generated with " << diagram.size() << " points.\n";
+        ConcreteForcesJacobian cf = {};
+        double epsTop = epsTop1, epsBot = epsBot1;
 
-        // Print diagram bounds for debugging
-        double M_min = 1e100, M_max = -1e100;
-        double N_min = 1e100, N_max = -1e100;
-        for (const auto& pt : diagram) {
-            M_min = std::min(M_min, pt.M);
-            M_max = std::max(M_max, pt.M);
-            N_min = std::min(N_min, pt.N);
-            N_max = std::max(N_max, pt.N);
+        for (int it = 1; it <= NEWTON_MAX_ITERATIONS; it++) {
+            result.iterations = it;
+
+            epsTop = epsTop1 + t * dEpsTop;
+            epsBot = epsBot1 + t * dEpsBot;
+            cf = ConcreteIntegrationFast::CalculateForceWithJacobian(epsTop, epsBot, geom.b, geom.h, concreteLaw);
+
+            double f = MomentResidual(cf.Fc, cf.Mc, N_target, M_target);
+            if (std::abs(f) <= tol) {
+                result.converged = true;
+                break;
+            }
+
+            // Shrink bracket
+            if ((f < 0.0) == (fLo < 0.0)) {
+                tLo = t;
+                fLo = f;
+            } else {
+                tHi = t;
+            }
+            if (tHi - tLo < 1e-15) {
+                break;  // bracket exhausted without reaching the tolerance
+            }
+
+            // Newton step, bisection when the derivative vanishes or the step leaves the bracket
+            double df = (cf.dMc_dk - z2 * cf.dFc_dk) * dk_dt + (cf.dMc_dq - z2 * cf.dFc_dq) * dq_dt;
+            double tNew = (df != 0.0) ? t - f / df : tLo - 1.0;
+            if (!(tNew > tLo && tNew < tHi)) {
+                tNew = 0.5 * (tLo + tHi);
+            }
+            t = tNew;
         }
-        std::cout << "Diagram bounds: N=[" << N_min << ", " << N_max << "] kN, "
-                  << "M=[" << M_min << ", " << M_max << "] kNm\n";
+
+        result.epsTop = epsTop;
+        result.epsBot = epsBot;
+        result.epsS2 = epsTop + (epsBot - epsTop) * (geom.h - geom.d2) / geom.h;
+        result.sigmaS2 = steelLaw.Stress(result.epsS2);
+
+        // Required As2 for equilibrium: N = Fc + As2 * sigmaS2
+        if (std::abs(result.sigmaS2) > 1e-6) {
+            result.As2 = (N_target - cf.Fc) / result.sigmaS2;
+        } else {
+            result.As2 = 0.0;
+        }
+        if (result.As2 < 0.0) result.As2 = 0.0;
+
+        double Fs2 = result.As2 * result.sigmaS2;
+        result.N_calc = cf.Fc + Fs2;
+        result.M_calc = cf.Mc + Fs2 * z2;
+
+        result.errorAbs = std::abs(result.M_calc - M_target);
+        result.errorRel = (std::abs(M_target) > 1e-6) ? result.errorAbs / std::abs(M_target) : 0.0;
+
+        return result;
     }
 
-    // Design for specific load case
-    DesignResult Design(const DesignLoads& loads, bool verbose = true) {
+    // Design without the cache
+    DesignResult Solve(const DesignLoads& loads, bool verbose) const {
         if (verbose) {
             std::cout << "\n==========================================================\n";
             std::cout << "Designing for: N = " << loads.N / 1000.0 << " kN, M = " << loads.M / 1000.0 << " kNm\n";
@@ -176,21 +317,27 @@ public:
                 std::cout << "Target load may be outside the feasible range.\n";
             }
 
-            DesignResult result;
+            DesignResult result = {};
             result.converged = false;
             return result;
         }
 
         if (verbose) {
             std::cout << "Found bracketing points:\n";
-            std::cout << "  Point " << idx1 << ": N=" << diagram[idx1].N << " kN, M=" << diagram[idx1].M << " kNm\n";
-            std::cout << "  Point " << idx2 << ": N=" << diagram[idx2].N << " kN, M=" << diagram[idx2].M << " kNm\n";
+            std::cout << "  Point " << idx1 << ": N=" << diagram.N[idx1] << " kN, M=" << diagram.M[idx1] << " kNm\n";
+            std::cout << "  Point " << idx2 << ": N=" << diagram.N[idx2] << " kN, M=" << diagram.M[idx2] << " kNm\n";
         }
 
-        // Interpolate to find design
-        DesignResult result = InterpolateDesign(diagram[idx1], diagram[idx2], loads.N, loads.M);
+        // Interpolate to find design, or solve equilibrium exactly
+        DesignResult result = (solver == DesignSolver::Newton)
+            ? NewtonDesign(idx1, idx2, loads.N, loads.M)
+            : InterpolateDesign(idx1, idx2, loads.N, loads.M);
 
-        if (verbose && result.converged) {
+        if (verbose && result.converged && solver == DesignSolver::Newton) {
+            std::cout << "\n[OK] Design found by Newton iteration (" << result.iterations << " iterations)\n";
+            std::cout << "Required As2 = " << result.As2 * 10000.0 << " cm^2\n";
+            std::cout << "Error: " << result.errorRel * 100.0 << " %\n";
+        } else if (verbose && result.converged) {
             std::cout << "\n[OK] Design found by interpolation\n";
             std::cout << "Required As2 = " << result.As2 * 10000.0 << " cm^2\n";
             std::cout << "Error: " << result.errorRel * 100.0 << " %\n";
@@ -199,14 +346,190 @@ public:
         return result;
     }
 
+    void SetDiagram(const SharedDiagram& shared) {
+        if (shared.view.As1 != 0.0 || shared.view.As2 != 0.0) {
+            // Bracketing needs the concrete-only diagram; leave it empty so Design reports failure
+            std::cerr << "Error: designer diagram must be generated with As1=0, As2=0\n";
+            diagram = DiagramView();
+            diagramStorage.reset();
+            return;
+        }
+        diagram = shared.view;
+        diagramStorage = shared.storage;
+    }
+
+    // Columns of a mapped diagram file, or none (Design reports failure) if the file was
+    // generated with other material laws than the ones of this designer
+    static SharedDiagram ShareIfSameLaws(const std::shared_ptr<const DiagramFile>& file) {
+        if (file->ConcreteLawId() != ConcreteLaw::Id || file->SteelLawId() != SteelLaw::Id) {
+            std::cerr << "Error: diagram file was generated with concrete law " << file->ConcreteLawId()
+                      << " / steel law " << file->SteelLawId() << ", designer uses " << ConcreteLaw::Id
+                      << " / " << SteelLaw::Id << "\n";
+            return SharedDiagram();
+        }
+        return DiagramFile::Share(file);
+    }
+
+    // Shared constructor tail: index the diagram and report its bounds
+    void InitializeDiagram() {
+        std::cout << "Diagram generated with " << diagram.Size() << " points.\n";
+
+        BuildBracketIndex();
+
+        // Everything a design depends on except the solver (added per query)
+        Fnv1a hasher;
+        hasher.Add(uint64_t(ConcreteLaw::Id));
+        hasher.Add(uint64_t(SteelLaw::Id));
+        for (double v : { geom.b, geom.h, geom.d1, geom.d2,
+                          concrete.fcd, concrete.epsC2, concrete.epsCu, concrete.n,
+                          steel.fyd, steel.Es, steel.epsUd, steel.k }) {
+            hasher.Add(v);
+        }
+        for (const double* column : { diagram.N, diagram.M, diagram.epsTop, diagram.epsBot, diagram.epsS2, diagram.sigS2 }) {
+            if (column) hasher.Bytes(column, diagram.Size() * sizeof(double));
+        }
+        sectionId = hasher.h;
+
+        // Print diagram bounds for debugging
+        double M_min = 1e100, M_max = -1e100;
+        double N_min = 1e100, N_max = -1e100;
+        for (size_t i = 0; i < diagram.Size(); i++) {
+            M_min = std::min(M_min, diagram.M[i]);
+            M_max = std::max(M_max, diagram.M[i]);
+            N_min = std::min(N_min, diagram.N[i]);
+            N_max = std::max(N_max, diagram.N[i]);
+        }
+        std::cout << "Diagram bounds: N=[" << N_min << ", " << N_max << "] kN, "
+                  << "M=[" << M_min << ", " << M_max << "] kNm\n";
+    }
+
+public:
+    // Constructor: generates interaction diagram once
+    ReinforcementDesignerT(const SectionGeometry& g, const ConcreteProperties& c,
+                          const SteelProperties& s, int diagramDensity = 10,
+                          DesignSolver designSolver = DesignSolver::Interpolation)
+        : geom(g), concrete(c), steel(s), concreteLaw(c), steelLaw(s), solver(designSolver) {
+
+        std::cout << "Generating interaction diagram (As1=0, As2=0)...\n";
+
+        // Generate diagram with As1=0, As2=0 (concrete only, for finding strain states)
+        InteractionDiagramT<ConcreteLaw, SteelLaw> diagramGen(geom, concrete, steel, 0.0, 0.0);
+        SetDiagram(SharedDiagram::FromCompact(std::make_shared<const CompactDiagram>(diagramGen.GenerateCompact(diagramDensity))));
+
+        InitializeDiagram();
+    }
+
+    // Constructor with adaptively densified diagram (fewer points for the same accuracy)
+    ReinforcementDesignerT(const SectionGeometry& g, const ConcreteProperties& c,
+                          const SteelProperties& s, const AdaptiveDensification& density,
+                          DesignSolver designSolver = DesignSolver::Interpolation)
+        : geom(g), concrete(c), steel(s), concreteLaw(c), steelLaw(s), solver(designSolver) {
+
+        std::cout << "Generating adaptive interaction diagram (As1=0, As2=0)...\n";
+
+        InteractionDiagramT<ConcreteLaw, SteelLaw> diagramGen(geom, concrete, steel, 0.0, 0.0);
+        SetDiagram(SharedDiagram::FromCompact(std::make_shared<const CompactDiagram>(diagramGen.GenerateAdaptiveCompact(density))));
+
+        InitializeDiagram();
+    }
+
+    // Constructor with a diagram from the cache: no generation if the section is known
+    // (in memory or on disk). The diagram is shared with the cache, not copied.
+    ReinforcementDesignerT(const SectionGeometry& g, const ConcreteProperties& c,
+                          const SteelProperties& s, DiagramCache& cache, int diagramDensity = 10,
+                          DesignSolver designSolver = DesignSolver::Interpolation)
+        : geom(g), concrete(c), steel(s), concreteLaw(c), steelLaw(s), solver(designSolver) {
+
+        SetDiagram(cache.Get<ConcreteLaw, SteelLaw>(geom, concrete, steel, 0.0, 0.0, diagramDensity));
+
+        InitializeDiagram();
+    }
+
+    // Constructor with a diagram loaded elsewhere (e.g. DiagramFile::Open); used in place,
+    // without copying. Must be the concrete-only diagram (As1=0, As2=0) of this section.
+    ReinforcementDesignerT(const SectionGeometry& g, const ConcreteProperties& c,
+                          const SteelProperties& s, const SharedDiagram& shared,
+                          DesignSolver designSolver = DesignSolver::Interpolation)
+        : geom(g), concrete(c), steel(s), concreteLaw(c), steelLaw(s), solver(designSolver) {
+
+        SetDiagram(shared);
+
+        InitializeDiagram();
+    }
+
+    // Constructor from a memory-mapped diagram file (DiagramFile::Open); section and materials
+    // are taken from the file header. A file of other material laws is rejected (empty diagram,
+    // every Design fails).
+    explicit ReinforcementDesignerT(const std::shared_ptr<const DiagramFile>& file,
+                                    DesignSolver designSolver = DesignSolver::Interpolation)
+        : ReinforcementDesignerT(file->Geometry(), file->Concrete(), file->Steel(),
+                                 ShareIfSameLaws(file), designSolver) {}
+
+    // Design for specific load case
+    // Thread-safe with verbose = false: reads only the shared diagram and index. With a cache
+    // (SetCache), quiet calls are answered from it, by the design of their cache cell (see SetCache).
+    DesignResult Design(const DesignLoads& loads, bool verbose = true) const {
+        if (cache && !verbose) {
+            uint64_t key = sectionId ^ (uint64_t(solver) * 0x9e3779b97f4a7c15ull);
+            return cache->GetOrCompute(
+                key, loads, [&](const DesignCache::Cell& cell, DesignResult& result) { return DesignCell(cell, result); },
+                [&](const DesignLoads& exact) { return Solve(exact, false); });
+        }
+        return Solve(loads, verbose);
+    }
+
+    // Design covering a cache cell: of its corners the one that needs the most steel. While
+    // the bottom steel yields, As2 grows steadily with |M| and moves steadily with N, so the
+    // corners cover every load of the cell. False if they do not: a corner fails (the cell
+    // reaches past the loads that can be designed), or its bottom steel stays below the yield
+    // strain (compression-dominated loads, where As2 changes steeply and not steadily).
+    bool DesignCell(const DesignCache::Cell& cell, DesignResult& result) const {
+        const double yieldStrain = steel.fyd / steel.Es;
+        const double Ns[2] = { cell.lowerN, cell.upperN };
+        const double Ms[2] = { cell.outerM, cell.innerM };
+        result = {};
+        for (int m = 0; m < (cell.innerM == cell.outerM ? 1 : 2); m++) {
+            for (int n = 0; n < (cell.upperN == cell.lowerN ? 1 : 2); n++) {
+                DesignResult corner = Solve({ Ns[n], Ms[m] }, false);
+                if (!corner.converged || corner.epsS2 < yieldStrain) return false;
+                if (!result.converged || corner.As2 > result.As2) result = corner;
+            }
+        }
+        return true;
+    }
+
+    // Select solver for subsequent Design calls
+    void SetSolver(DesignSolver designSolver) {
+        solver = designSolver;
+    }
+
+    DesignSolver GetSolver() const {
+        return solver;
+    }
+
+    // Neighbouring diagram points whose strain states bracket equilibrium for loads (index
+    // lookup, see FindBracketingPoints); {-1, -1} outside the feasible range or for NaN / inf
+    std::pair<int, int> Bracket(const DesignLoads& loads) const {
+        return FindBracketingPoints(loads.N, loads.M);
+    }
+
     // Get the generated diagram (for export, visualization, etc.)
-    const std::vector<DiagramPoint>& GetDiagram() const {
+    const DiagramView& GetDiagram() const {
         return diagram;
     }
 
+    const SectionGeometry& GetGeometry() const {
+        return geom;
+    }
+
+    const SteelProperties& GetSteel() const {
+        return steel;
+    }
+
     // Design for multiple load cases efficiently
     std::vector<DesignResult> DesignMultiple(const std::vector<DesignLoads>& loadCases) {
         std::vector<DesignResult> results;
+        results.reserve(loadCases.size());
 
         std::cout << "\n==========================================================\n";
         std::cout << "Designing for " << loadCases.size() << " load cases\n";
@@ -219,4 +542,191 @@ public:
 
         return results;
     }
+
+    // Column header of the design results CSV
+    static void WriteResultsHeader(CsvWriter& out) {
+        out.Text("Case,N[kN],M[kNm],Converged,As2[cm^2],epsTop[o/oo],epsBot[o/oo],epsS2[o/oo],"
+                 "sigS2[MPa],N_calc[kN],M_calc[kNm],ErrorAbs[kNm],ErrorRel[-],Iterations\n");
+    }
+
+    // Design results CSV rows for loads[i], results[i]; the Case column starts at firstCase
+    static void WriteResultRows(CsvWriter& out, const DesignLoads* loads, const DesignResult* results,
+                                size_t count, uint64_t firstCase = 1) {
+        WriteResultRowsAt(out, [&](size_t i) { return loads[i]; }, results, count, firstCase);
+    }
+
+    // Same for load cases in columns
+    static void WriteResultRows(CsvWriter& out, const double* N, const double* M, const DesignResult* results,
+                                size_t count, uint64_t firstCase = 1) {
+        WriteResultRowsAt(out, [&](size_t i) { return DesignLoads{ N[i], M[i] }; }, results, count, firstCase);
+    }
+
+    // Rows for any load accessor loadAt(i) -> DesignLoads
+    template <class LoadAt>
+    static void WriteResultRowsAt(CsvWriter& out, const LoadAt& loadAt, const DesignResult* results,
+                                size_t count, uint64_t firstCase) {
+        for (size_t i = 0; i < count; i++) {
+            const DesignResult& r = results[i];
+            const DesignLoads l = loadAt(i);
+            out.Integer(int64_t(firstCase + i));
+            for (double v : { l.N / 1000.0, l.M / 1000.0 }) {
+                out.Char(',');
+                out.Number(v);
+            }
+            out.Char(',');
+            out.Integer(r.converged ? 1 : 0);
+            for (double v : { r.As2 * 10000.0, r.epsTop * 1000.0, r.epsBot * 1000.0, r.epsS2 * 1000.0,
+                              r.sigmaS2 / 1e6, r.N_calc / 1000.0, r.M_calc / 1000.0,
+                              r.errorAbs / 1000.0, r.errorRel }) {
+                out.Char(',');
+                out.Number(v);
+            }
+            out.Char(',');
+            out.Integer(r.iterations);
+            out.Char('\n');
+        }
+    }
+
+    // Export batch results to CSV (row i = loads[i], results[i]); compress = gzip, see CsvWriter
+    static void ExportResultsToCSV(const DesignLoads* loads, const DesignResult* results, size_t count,
+                                   const std::string& filename, bool compress = false) {
+        CsvWriter out(filename, compress);
+        if (!out.IsOpen()) {
+            std::cerr << "Error: Could not open file " << filename << " for writing\n";
+            return;
+        }
+
+        WriteResultsHeader(out);
+        WriteResultRows(out, loads, results, count);
+
+        if (!out.Close()) {
+            std::cerr << "Error: Writing " << filename << " failed\n";
+            return;
+        }
+        std::cout << "Design results exported to: " << filename << "\n";
+        std::cout << "Total cases: " << count << "\n";
+    }
+
+    static void ExportResultsToCSV(const std::vector<DesignLoads>& loads, const std::vector<DesignResult>& results,
+                                   const std::string& filename, bool compress = false) {
+        ExportResultsToCSV(loads.data(), results.data(), std::min(loads.size(), results.size()), filename, compress);
+    }
+
+    // Number of threads used by DesignBatch (0 = all hardware threads)
+    void SetThreadCount(unsigned threads) {
+        if (threads != threadCount) {
+            threadCount = threads;
+            pool.reset();
+        }
+    }
+
+    // Answer quiet Design calls (and so DesignBatch / DesignEnvelope) from a memo cache;
+    // nullptr switches it off. A cached result is DesignCell of the load's cell: the most
+    // demanding of the loads at its corners, |M| rounded up and N at either end of its step
+    // (As2 falls with N in one direction or the other depending on the strain region).
+    //
+    // Conservative: the cached As2 is never below that of the load itself; it can exceed it by
+    // the change of As2 over one N step and one M step (resolutionN / fyd for N, 0.002 cm^2
+    // for 0.1 kN). Cells the corners do not cover - next to loads that cannot be designed, or
+    // where the bottom steel does not yield - are passes and their loads are designed exactly,
+    // without a speedup. A miss designs up to five times.
+    void SetCache(std::shared_ptr<DesignCache> designCache) {
+        cache = std::move(designCache);
+    }
+
+    const std::shared_ptr<DesignCache>& GetCache() const {
+        return cache;
+    }
+
+    // Cache key of the section: equal for designers of the same section, materials and diagram
+    uint64_t SectionId() const {
+        return sectionId;
+    }
+
+    // Record the latency of every case of DesignBatch as a "Design" scope of the given timer
+    // (count, mean, p50, p99, max); nullptr switches it off
+    void SetProfiler(PerformanceTimer* timer) {
+        profiler = timer;
+    }
+
+    // Parallel batch design into a preallocated output array: results[i] is the design of
+    // loads[i], or with a cache (SetCache) the design of its cache cell.
+    // Quiet: no console output. Each case is independent and reads the diagram read-only,
+    // so results are identical for any thread count.
+    void DesignBatch(const DesignLoads* loads, size_t count, DesignResult* results) {
+        DesignBatchAt([&](size_t i) { return loads[i]; }, count, results);
+    }
+
+    // DesignBatch over load cases in columns (N[i], M[i]), e.g. a mapped LoadCaseFile
+    void DesignBatch(const double* N, const double* M, size_t count, DesignResult* results) {
+        DesignBatchAt([&](size_t i) { return DesignLoads{ N[i], M[i] }; }, count, results);
+    }
+
+    // DesignBatch for any load accessor loadAt(i) -> DesignLoads
+    template <class LoadAt>
+    void DesignBatchAt(const LoadAt& loadAt, size_t count, DesignResult* results) {
+        if (!pool) {
+            pool = std::make_shared<WorkStealingPool>(threadCount);
+        }
+
+        size_t grain = std::clamp<size_t>(count / (size_t(pool->Size()) * 16), 16, 4096);
+        pool->ParallelFor(count, grain, [&](size_t begin, size_t end) {
+            if (profiler) {
+                for (size_t i = begin; i < end; i++) {
+                    ScopedTimer scope(*profiler, "Design");
+                    results[i] = Design(loadAt(i), false);
+                }
+                return;
+            }
+            for (size_t i = begin; i < end; i++) {
+                results[i] = Design(loadAt(i), false);
+            }
+        });
+    }
+
+    std::vector<DesignResult> DesignBatch(const std::vector<DesignLoads>& loadCases) {
+        std::vector<DesignResult> results(loadCases.size());
+        DesignBatch(loadCases.data(), loadCases.size(), results.data());
+        return results;
+    }
+
+    // Envelope design of the load cases of one member: only the governing cases (LoadEnvelope)
+    // are designed and get full results. Every other case is covered by the governing case with
+    // the largest As2 and gets only that As2 and converged; its row is marked iterations = -1
+    // and the strain state, forces and errors are NaN (it was not designed). If a governing
+    // case does not converge all cases are designed. Returns the number of designed cases.
+    size_t DesignEnvelope(const DesignLoads* loads, size_t count, DesignResult* results, unsigned bands = 256) {
+        if (count == 0) return 0;
+        std::vector<size_t> governing =
+            LoadEnvelope::Build(loads, count, diagram, geom.h / 2.0 - geom.d2, steel.fyd, bands).Governing();
+        if (governing.empty()) governing.push_back(0);  // all cases inside the diagram: case 0 stands for them
+
+        std::vector<DesignLoads> subset(governing.size());
+        std::vector<DesignResult> subsetResults(governing.size());
+        for (size_t j = 0; j < governing.size(); j++) subset[j] = loads[governing[j]];
+        DesignBatch(subset.data(), subset.size(), subsetResults.data());
+
+        size_t worst = 0;
+        for (size_t j = 0; j < subsetResults.size(); j++) {
+            if (!subsetResults[j].converged) {
+                DesignBatch(loads, count, results);
+                return count;
+            }
+            if (subsetResults[j].As2 > subsetResults[worst].As2) worst = j;
+        }
+
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        DesignResult enveloped = { true, subsetResults[worst].As2, nan, nan, nan, nan, nan, nan, nan, nan, -1 };
+        for (size_t i = 0; i < count; i++) results[i] = enveloped;
+        for (size_t j = 0; j < governing.size(); j++) results[governing[j]] = subsetResults[j];
+        return governing.size();
+    }
+
+    std::vector<DesignResult> DesignEnvelope(const std::vector<DesignLoads>& loadCases) {
+        std::vector<DesignResult> results(loadCases.size());
+        DesignEnvelope(loadCases.data(), loadCases.size(), results.data());
+        return results;
+    }
 };
+
+using ReinforcementDesigner = ReinforcementDesignerT<>;
@@ -0,0 +1,113 @@
+#pragma once
+#include <cmath>
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// SIMD lane abstractions for the branchless batch kernels (concrete and steel).
+// Every lane type exposes the same operations so that one kernel body serves
+// the scalar tail and the AVX2 / AVX-512 main loops.
+namespace ConcreteSimd {
+
+    struct ScalarLane {
+        using Vec = double;
+        using Mask = bool;
+        static constexpr std::size_t Width = 1;
+
+        static inline Vec Load(const double* p) { return *p; }
+        static inline void Store(double* p, Vec v) { *p = v; }
+        static inline Vec Set1(double v) { return v; }
+        static inline Vec Add(Vec a, Vec b) { return a + b; }
+        static inline Vec Sub(Vec a, Vec b) { return a - b; }
+        static inline Vec Mul(Vec a, Vec b) { return a * b; }
+        static inline Vec Div(Vec a, Vec b) { return a / b; }
+        static inline Vec Neg(Vec a) { return -a; }
+        static inline Vec Abs(Vec a) { return std::abs(a); }
+        // Same operand order as std::min / std::max so that ties (+0 / -0) resolve identically
+        static inline Vec Min(Vec a, Vec b) { return std::min(a, b); }
+        static inline Vec Max(Vec a, Vec b) { return std::max(a, b); }
+        static inline Mask Less(Vec a, Vec b) { return a < b; }
+        static inline Mask GreaterEq(Vec a, Vec b) { return a >= b; }
+        static inline Mask And(Mask a, Mask b) { return a && b; }
+        static inline Mask Or(Mask a, Mask b) { return a || b; }
+        static inline Vec Select(Mask m, Vec t, Vec f) { return m ? t : f; }
+        static inline double Sum(Vec a) { return a; }
+    };
+
+#if defined(__AVX2__)
+    struct Avx2Lane {
+        using Vec = __m256d;
+        using Mask = __m256d;
+        static constexpr std::size_t Width = 4;
+
+        static inline Vec Load(const double* p) { return _mm256_loadu_pd(p); }
+        static inline void Store(double* p, Vec v) { _mm256_storeu_pd(p, v); }
+        static inline Vec Set1(double v) { return _mm256_set1_pd(v); }
+        static inline Vec Add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+        static inline Vec Sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+        static inline Vec Mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+        static inline Vec Div(Vec a, Vec b) { return _mm256_div_pd(a, b); }
+        static inline Vec Neg(Vec a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+        static inline Vec Abs(Vec a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+        // minpd/maxpd return the second operand on ties; swapped to mirror std::min / std::max
+        static inline Vec Min(Vec a, Vec b) { return _mm256_min_pd(b, a); }
+        static inline Vec Max(Vec a, Vec b) { return _mm256_max_pd(b, a); }
+        static inline Mask Less(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+        static inline Mask GreaterEq(Vec a, Vec b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+        static inline Mask And(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+        static inline Mask Or(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+        static inline Vec Select(Mask m, Vec t, Vec f) { return _mm256_blendv_pd(f, t, m); }
+        static inline double Sum(Vec a) {
+            __m128d s = _mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+            return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+        }
+    };
+#endif
+
+#if defined(__AVX512F__)
+    struct Avx512Lane {
+        using Vec = __m512d;
+        using Mask = __mmask8;
+        static constexpr std::size_t Width = 8;
+
+        static inline Vec Load(const double* p) { return _mm512_loadu_pd(p); }
+        static inline void Store(double* p, Vec v) { _mm512_storeu_pd(p, v); }
+        static inline Vec Set1(double v) { return _mm512_set1_pd(v); }
+        static inline Vec Add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+        static inline Vec Sub(Vec a, Vec b) { return _mm512_sub_pd(a, b); }
+        static inline Vec Mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+        static inline Vec Div(Vec a, Vec b) { return _mm512_div_pd(a, b); }
+        static inline Vec Neg(Vec a) {
+            return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a),
+                                                         _mm512_castpd_si512(_mm512_set1_pd(-0.0))));
+        }
+        static inline Vec Abs(Vec a) { return _mm512_abs_pd(a); }
+        // maskz forms avoid GCC's -Wuninitialized false positive on _mm512_undefined_pd
+        static inline Vec Min(Vec a, Vec b) { return _mm512_maskz_min_pd(0xFF, b, a); }
+        static inline Vec Max(Vec a, Vec b) { return _mm512_maskz_max_pd(0xFF, b, a); }
+        static inline Mask Less(Vec a, Vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+        static inline Mask GreaterEq(Vec a, Vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+        static inline Mask And(Mask a, Mask b) { return static_cast<Mask>(a & b); }
+        static inline Mask Or(Mask a, Mask b) { return static_cast<Mask>(a | b); }
+        static inline Vec Select(Mask m, Vec t, Vec f) { return _mm512_mask_blend_pd(m, f, t); }
+        static inline double Sum(Vec a) {
+            __m256d h = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xFF, a, 0), _mm512_maskz_extractf64x4_pd(0xFF, a, 1));
+            __m128d s = _mm_add_pd(_mm256_castpd256_pd128(h), _mm256_extractf128_pd(h, 1));
+            return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+        }
+    };
+#endif
+
+    // Widest lane of the build
+#if defined(__AVX512F__)
+    using WidestLane = Avx512Lane;
+#elif defined(__AVX2__)
+    using WidestLane = Avx2Lane;
+#else
+    using WidestLane = ScalarLane;
+#endif
+
+} // namespace ConcreteSimd
@@ -1,9 +1,75 @@
 #pragma once
 #include "MaterialProperties.h"
+#include "SimdLanes.h"
+#include "MaterialLaws.h"
 #include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Steel force resultants of a set of bars, local convention (as ConcreteIntegrationFast::FastConcreteNM)
+struct SteelForces {
+    double Fs;   // [N] Σ A·σ
+    double Ms;   // [Nm] Σ A·σ·y
+    double MsX;  // [Nm] Σ A·σ·x
+};
+
+// Reinforcement as structure-of-arrays, one entry per bar or bar layer,
+// coordinates relative to the section centroid (y up, x to the right).
+// The arrays are padded with zero-area bars to a multiple of the widest SIMD lane,
+// so SteelStress::LayoutForces runs without a scalar tail.
+class SteelLayout {
+private:
+    static constexpr size_t PADDING = ConcreteSimd::WidestLane::Width;
+
+    std::vector<double> y;     // [m]
+    std::vector<double> x;     // [m]
+    std::vector<double> area;  // [m^2]
+    size_t count = 0;
+
+public:
+    void Add(double yc, double a, double xc = 0.0) {
+        if (count == area.size()) {
+            y.resize(count + PADDING, 0.0);
+            x.resize(count + PADDING, 0.0);
+            area.resize(count + PADDING, 0.0);
+        }
+        y[count] = yc;
+        x[count] = xc;
+        area[count] = a;
+        count++;
+    }
+
+    // Bars given in section coordinates, shifted to the centroid (xc, yc)
+    static SteelLayout FromBars(const std::vector<ReinforcementBar>& bars, double xc, double yc) {
+        SteelLayout layout;
+        for (const ReinforcementBar& bar : bars) {
+            layout.Add(bar.y - yc, bar.area, bar.x - xc);
+        }
+        return layout;
+    }
+
+    size_t Size() const { return count; }
+    size_t PaddedSize() const { return area.size(); }
+    double Y(size_t i) const { return y[i]; }
+    double X(size_t i) const { return x[i]; }
+    double Area(size_t i) const { return area[i]; }
+    const double* YData() const { return y.data(); }
+    const double* XData() const { return x.data(); }
+    const double* AreaData() const { return area.data(); }
+
+    double TotalArea() const {
+        double total = 0.0;
+        for (size_t i = 0; i < count; i++) total += area[i];
+        return total;
+    }
+};
 
 // Bilinear steel stress-strain model
+// (CalculateStress derives εyd per call; hot loops use a steel law from MaterialLaws.h instead)
 class SteelStress {
+private:
+    using Lane = ConcreteSimd::WidestLane;
+
 public:
     static double CalculateStress(double eps, const SteelProperties& props) {
         double epsY = props.fyd / props.Es;
@@ -18,4 +84,42 @@ public:
             return eps * props.Es;
         }
     }
+
+    /// <summary>
+    /// Resultants of all bars of a layout in one pass over its SoA arrays
+    /// for the strain plane ε = k·y + q + kx·x (kx = 0 for uniaxial bending)
+    /// </summary>
+    /// <param name="layout">Bars relative to the centroid</param>
+    /// <param name="k">Strain gradient along y [1/m]</param>
+    /// <param name="q">Strain at centroid [-]</param>
+    /// <param name="law">Steel law (MaterialLaws.h)</param>
+    /// <param name="kx">Strain gradient along x [1/m]</param>
+    /// <returns>Steel forces (N, moments about the centroid, local convention)</returns>
+    template <class Law>
+    static SteelForces LayoutForces(const SteelLayout& layout, double k, double q,
+                                    const Law& law, double kx = 0.0) {
+        using Vec = Lane::Vec;
+        const Vec vK = Lane::Set1(k), vQ = Lane::Set1(q), vKx = Lane::Set1(kx);
+        Vec sumF = Lane::Set1(0.0), sumM = Lane::Set1(0.0), sumX = Lane::Set1(0.0);
+
+        // Branchless law (every bar gets the scalar stress); padding bars have zero area and add nothing
+        for (std::size_t i = 0; i < layout.PaddedSize(); i += Lane::Width) {
+            Vec y = Lane::Load(layout.YData() + i);
+            Vec x = Lane::Load(layout.XData() + i);
+            Vec eps = Lane::Add(Lane::Add(Lane::Mul(vK, y), vQ), Lane::Mul(vKx, x));
+            Vec sigma = law.template Stress<Lane>(eps);
+            Vec f = Lane::Mul(Lane::Load(layout.AreaData() + i), sigma);
+            sumF = Lane::Add(sumF, f);
+            sumM = Lane::Add(sumM, Lane::Mul(f, y));
+            sumX = Lane::Add(sumX, Lane::Mul(f, x));
+        }
+
+        return { Lane::Sum(sumF), Lane::Sum(sumM), Lane::Sum(sumX) };
+    }
+
+    // LayoutForces with the bilinear law of the given properties
+    static SteelForces LayoutForces(const SteelLayout& layout, double k, double q,
+                                    const SteelProperties& props, double kx = 0.0) {
+        return LayoutForces(layout, k, q, MaterialLaws::BilinearSteel(props), kx);
+    }
 };
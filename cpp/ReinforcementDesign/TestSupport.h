@@ -0,0 +1,168 @@
+#pragma once
+#include "MaterialProperties.h"
+#include "SteelStress.h"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// Shared fixture of the feature tests (test_*.cpp, one executable and ctest entry per feature):
+// the section and materials of main.cpp, strain states, failure bookkeeping and a scratch
+// directory for the files a test writes.
+namespace TestSupport {
+
+    // Section and materials of main.cpp
+    inline SectionGeometry Section() {
+        SectionGeometry geom;
+        geom.b = 0.3;
+        geom.h = 0.5;
+        geom.d1 = 0.05;
+        geom.d2 = 0.05;
+        return geom;
+    }
+
+    inline ConcreteProperties Concrete() {
+        ConcreteProperties concrete;
+        concrete.fcd = -20.0e6;  // -20 MPa
+        concrete.epsC2 = -0.002;
+        concrete.epsCu = -0.0035;
+        return concrete;
+    }
+
+    inline SteelProperties Steel() {
+        SteelProperties steel;
+        steel.fyd = 435.0e6;
+        steel.Es = 200.0e9;
+        steel.epsUd = 0.010;
+        return steel;
+    }
+
+    // Strain state given by its extreme fibers
+    struct NamedStrain {
+        std::string name;
+        double epsTop;
+        double epsBot;
+    };
+
+    // One state per strain region, from pure compression to nearly pure tension
+    inline std::vector<NamedStrain> CharacteristicStrains() {
+        return {
+            {"Pure compression", -0.0035, -0.0035},
+            {"Balanced (εtop=εcu, εbot=0)", -0.0035, 0.0},
+            {"Small bending", -0.002, -0.001},
+            {"Typical bending", -0.003, 0.002},
+            {"Large bending", -0.0035, 0.010},
+            {"Tension dominant", -0.001, 0.005},
+            {"Nearly pure tension", 0.0, 0.010}
+        };
+    }
+
+    // Random strain states eps(x) = k*x + q of a section of height h over all regions, with
+    // exact k = 0 (every 16th), bottom fiber at epsC2 and top fiber at 0 cases
+    struct Strains {
+        std::vector<double> k, q;
+    };
+
+    inline Strains RandomStrains(size_t count, double h, double epsC2, uint64_t seed = 12345) {
+        Strains s;
+        s.k.resize(count);
+        s.q.resize(count);
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> epsDist(-0.0035, 0.010);
+        for (size_t i = 0; i < count; i++) {
+            double eTop = epsDist(rng);
+            double eBot = (i % 16 == 0) ? eTop : epsDist(rng);
+            if (i % 16 == 1) eBot = epsC2;
+            if (i % 16 == 2) eTop = 0.0;
+            s.k[i] = (eTop - eBot) / h;
+            s.q[i] = (eTop + eBot) / 2.0;
+        }
+        return s;
+    }
+
+    // Six bar layers of two bars each plus three web bars, symmetric about the centroid
+    inline SteelLayout LayeredLayout() {
+        SteelLayout layout;
+        const double layerY[6] = { -0.20, -0.15, -0.10, 0.10, 0.15, 0.20 };
+        for (int i = 0; i < 6; i++) {
+            layout.Add(layerY[i], 3.0e-4, -0.1);
+            layout.Add(layerY[i], 3.0e-4, 0.1);
+        }
+        for (double yWeb : { -0.05, 0.0, 0.05 }) {
+            layout.Add(yWeb, 1.0e-4);
+        }
+        return layout;
+    }
+
+    inline void PrintHeader(const std::string& title) {
+        std::cout << "==========================================================\n";
+        std::cout << "  " << title << "\n";
+        std::cout << "==========================================================\n\n";
+    }
+
+    // Failures of one test executable: every failed check prints a [WARNING] line
+    class Checks {
+    private:
+        int failures = 0;
+
+    public:
+        bool Expect(bool ok, const std::string& warning) {
+            if (!ok) {
+                failures++;
+                std::cout << "[WARNING] " << warning << "\n";
+            }
+            return ok;
+        }
+
+        int Failures() const {
+            return failures;
+        }
+
+        // Closing line and exit code (0 when every check passed)
+        int Finish(const std::string& okMessage) {
+            if (failures == 0) std::cout << "[OK] " << okMessage << "\n";
+            std::cout << "\n==========================================================\n";
+            return failures == 0 ? 0 : 1;
+        }
+    };
+
+    // Directory of its own in the system temp directory, removed with its contents at scope exit
+    class ScratchDirectory {
+    private:
+        std::filesystem::path path;
+
+    public:
+        explicit ScratchDirectory(const std::string& name) {
+            const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+            path = std::filesystem::temp_directory_path() / (name + "_" + std::to_string(stamp));
+            std::filesystem::create_directories(path);
+        }
+
+        ~ScratchDirectory() {
+            std::error_code ec;
+            std::filesystem::remove_all(path, ec);
+        }
+
+        ScratchDirectory(const ScratchDirectory&) = delete;
+        ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+
+        std::string File(const std::string& name) const {
+            return (path / name).string();
+        }
+
+        const std::filesystem::path& Path() const {
+            return path;
+        }
+    };
+
+    inline std::string ReadFile(const std::string& name) {
+        std::ifstream in(name, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+}
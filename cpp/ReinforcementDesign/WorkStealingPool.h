@@ -0,0 +1,192 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+// Persistent thread pool for data-parallel loops with work stealing.
+// ParallelFor splits [0, count) into chunks, gives every participant a contiguous block of
+// chunks, and lets idle participants steal chunks from the back of other blocks. The calling
+// thread takes part as worker 0, so a pool of size 1 runs the loop inline with no threads.
+class WorkStealingPool {
+private:
+    // Chunk range [head, tail) owned by one participant; owner pops at head, thieves at tail
+    struct WorkerQueue {
+        std::mutex mutex;
+        size_t head = 0;
+        size_t tail = 0;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;  // one per participant (caller + threads)
+
+    std::mutex callMutex;  // serializes concurrent ParallelFor callers
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    // Current job
+    const std::function<void(size_t, size_t)>* body = nullptr;
+    size_t jobCount = 0;
+    size_t jobGrain = 1;
+    std::atomic<size_t> chunksLeft{0};
+    unsigned activeWorkers = 0;
+    std::exception_ptr jobError;        // first exception thrown by body (guarded by jobMutex)
+    std::atomic<bool> jobFailed{false};  // remaining chunks are skipped once body has thrown
+
+    bool PopOwn(unsigned self, size_t& chunk) {
+        WorkerQueue& q = *queues[self];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.head >= q.tail) return false;
+        chunk = q.head++;
+        return true;
+    }
+
+    bool Steal(unsigned self, size_t& chunk) {
+        unsigned n = (unsigned)queues.size();
+        for (unsigned i = 1; i < n; i++) {
+            WorkerQueue& q = *queues[(self + i) % n];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.head < q.tail) {
+                chunk = --q.tail;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void RunChunks(unsigned self) {
+        size_t chunk;
+        while (PopOwn(self, chunk) || Steal(self, chunk)) {
+            size_t begin = chunk * jobGrain;
+            size_t end = std::min(begin + jobGrain, jobCount);
+            if (!jobFailed.load(std::memory_order_relaxed)) {
+                try {
+                    (*body)(begin, end);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(jobMutex);
+                    if (!jobError) jobError = std::current_exception();
+                    jobFailed.store(true, std::memory_order_relaxed);
+                }
+            }
+            chunksLeft.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    void WorkerLoop(unsigned self) {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(jobMutex);
+                jobReady.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                if (body == nullptr) continue;  // woke after the job already finished
+                activeWorkers++;
+            }
+
+            RunChunks(self);
+
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                activeWorkers--;
+            }
+            jobDone.notify_all();
+        }
+    }
+
+public:
+    // threadCount = 0 uses all hardware threads
+    explicit WorkStealingPool(unsigned threadCount = 0) {
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 0; i < threadCount; i++) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (unsigned i = 1; i < threadCount; i++) {
+            threads.emplace_back([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            stopping = true;
+        }
+        jobReady.notify_all();
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Number of participants including the calling thread
+    unsigned Size() const {
+        return (unsigned)queues.size();
+    }
+
+    // Run loopBody(begin, end) over [0, count) in chunks of at most grain indices.
+    // Blocks until all chunks are done. If loopBody throws, the chunks not yet started are
+    // skipped and the first exception is rethrown here once the other threads have left the
+    // job. Concurrent callers are serialized; must not be called from inside loopBody.
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& loopBody) {
+        if (count == 0) return;
+        std::lock_guard<std::mutex> call(callMutex);
+        grain = std::max<size_t>(1, grain);
+        size_t chunks = (count + grain - 1) / grain;
+
+        if (queues.size() == 1 || chunks == 1) {
+            for (size_t begin = 0; begin < count; begin += grain) {
+                loopBody(begin, std::min(begin + grain, count));
+            }
+            return;
+        }
+
+        // Contiguous block of chunks per participant
+        unsigned n = (unsigned)queues.size();
+        for (unsigned i = 0; i < n; i++) {
+            std::lock_guard<std::mutex> lock(queues[i]->mutex);
+            queues[i]->head = chunks * i / n;
+            queues[i]->tail = chunks * (i + 1) / n;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            body = &loopBody;
+            jobCount = count;
+            jobGrain = grain;
+            chunksLeft.store(chunks, std::memory_order_release);
+            jobFailed.store(false, std::memory_order_relaxed);
+            generation++;
+        }
+        jobReady.notify_all();
+
+        RunChunks(0);
+
+        // Wait for chunks still running on other threads, and for workers to leave the job
+        // so that queues and body can be reused by the next call
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobDone.wait(lock, [&] {
+                return chunksLeft.load(std::memory_order_acquire) == 0 && activeWorkers == 0;
+            });
+            body = nullptr;
+            std::swap(error, jobError);
+        }
+        if (error) std::rethrow_exception(error);
+    }
+};
@@ -0,0 +1,258 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include "MaterialProperties.h"
+#include "ReinforcementDesigner.h"
+#include "DiagramFile.h"
+#include "LoadCaseStream.h"
+#include "LoadCaseFile.h"
+#include "DesignPipeline.h"
+
+// Non-interactive batch design: streams load cases from a CSV or binary file (or stdin)
+// through DesignPipeline and writes the design results CSV. Memory stays constant for any
+// number of load cases. Binary files are mapped and designed in place (LoadCaseFile).
+
+namespace {
+
+void PrintUsage() {
+    std::cout <<
+        "Usage: batch_design --output=results.csv [options]\n"
+        "\n"
+        "Input:\n"
+        "  --input=<file|->       load cases (default: - = stdin). CSV with N[kN],M[kNm] or\n"
+        "                         Case,N[kN],M[kNm] per line, or a binary load-case file\n"
+        "  --convert=<file|->     only convert the input to a binary load-case file, no design\n"
+        "  --layout=rows|columns  layout of the converted file (columns: file input only);\n"
+        "                         with --load=map, layout of the parsed CSV\n"
+        "  --load=auto|stream|map auto: binary files are mapped, CSV is streamed; map: CSV is\n"
+        "                         parsed in parallel into memory; stream: constant memory\n"
+        "\n"
+        "Section (defaults as in ReinforcementDesign):\n"
+        "  --diagram=<file.diag>  section, materials and diagram from a binary diagram file\n"
+        "  --b=0.3 --h=0.5 --d1=0.05 --d2=0.05          [m]\n"
+        "  --fcd=20 --epsc2=2 --epscu=3.5               [MPa, o/oo]\n"
+        "  --fyd=435 --es=200 --epsud=10                [MPa, GPa, o/oo]\n"
+        "  --density=10           interpolation points between characteristic diagram points\n"
+        "\n"
+        "Design:\n"
+        "  --solver=interpolation|newton   (default: newton)\n"
+        "  --threads=<n>          worker threads (default: 0 = all hardware threads)\n"
+        "  --block=<n>            load cases per pipeline block (default: 65536)\n"
+        "  --blocks=<n>           blocks in flight (default: 4)\n"
+        "  --cache=<r>            memoize designs on an r kN / r kNm grid (e.g. 0.1); conservative:\n"
+        "                         |M| is rounded up and the N step is designed at both ends, so\n"
+        "                         As2 can only come out larger (by about r/fyd); loads where the\n"
+        "                         bottom steel does not yield are designed exactly\n"
+        "  --output=<file>        results CSV; a .gz name is written gzip-compressed (needs zlib)\n";
+}
+
+bool ParseOption(const char* arg, const char* name, std::string& value) {
+    size_t n = std::strlen(name);
+    if (std::strncmp(arg, name, n) != 0 || arg[n] != '=') return false;
+    value = arg + n + 1;
+    return true;
+}
+
+bool EndsWith(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string input = "-", output, convert, diagramFile;
+    SectionGeometry geom = { 0.3, 0.5, 0.05, 0.05 };
+    double fcd = 20.0, epsC2 = 2.0, epsCu = 3.5, fyd = 435.0, Es = 200.0, epsUd = 10.0;
+    int density = 10;
+    DesignSolver solver = DesignSolver::Newton;
+    unsigned threads = 0;
+    DesignPipeline::Options options;
+    std::string load = "auto";
+    bool columns = false;
+    double cacheResolution = 0.0;  // [kN, kNm], 0 = no cache
+
+    for (int i = 1; i < argc; i++) {
+        std::string v;
+        const char* a = argv[i];
+        if (std::strcmp(a, "--help") == 0 || std::strcmp(a, "-h") == 0) {
+            PrintUsage();
+            return 0;
+        }
+        else if (ParseOption(a, "--input", v)) input = v;
+        else if (ParseOption(a, "--output", v)) output = v;
+        else if (ParseOption(a, "--convert", v)) convert = v;
+        else if (ParseOption(a, "--diagram", v)) diagramFile = v;
+        else if (ParseOption(a, "--layout", v) && (v == "rows" || v == "columns")) columns = v == "columns";
+        else if (ParseOption(a, "--load", v) && (v == "auto" || v == "stream" || v == "map")) load = v;
+        else if (ParseOption(a, "--b", v)) geom.b = std::atof(v.c_str());
+        else if (ParseOption(a, "--h", v)) geom.h = std::atof(v.c_str());
+        else if (ParseOption(a, "--d1", v)) geom.d1 = std::atof(v.c_str());
+        else if (ParseOption(a, "--d2", v)) geom.d2 = std::atof(v.c_str());
+        else if (ParseOption(a, "--fcd", v)) fcd = std::atof(v.c_str());
+        else if (ParseOption(a, "--epsc2", v)) epsC2 = std::atof(v.c_str());
+        else if (ParseOption(a, "--epscu", v)) epsCu = std::atof(v.c_str());
+        else if (ParseOption(a, "--fyd", v)) fyd = std::atof(v.c_str());
+        else if (ParseOption(a, "--es", v)) Es = std::atof(v.c_str());
+        else if (ParseOption(a, "--epsud", v)) epsUd = std::atof(v.c_str());
+        else if (ParseOption(a, "--density", v)) density = std::atoi(v.c_str());
+        else if (ParseOption(a, "--threads", v)) threads = unsigned(std::atoi(v.c_str()));
+        else if (ParseOption(a, "--block", v)) options.blockSize = size_t(std::atof(v.c_str()));
+        else if (ParseOption(a, "--blocks", v)) options.blocks = unsigned(std::atoi(v.c_str()));
+        else if (ParseOption(a, "--cache", v) && std::atof(v.c_str()) > 0.0) cacheResolution = std::atof(v.c_str());
+        else if (ParseOption(a, "--solver", v) && (v == "newton" || v == "interpolation")) {
+            solver = v == "newton" ? DesignSolver::Newton : DesignSolver::Interpolation;
+        } else {
+            std::cerr << "Error: unknown option " << a << " (see --help)\n";
+            return 2;
+        }
+    }
+
+    // Binary files (and CSV with --load=map) are mapped; stdin is always streamed.
+    // Column-layout files can only be mapped.
+    LoadCaseReader reader;
+    bool streamable = reader.Open(input);
+    bool mapInput = input != "-" &&
+                    (load == "map" || (reader.IsBinary() && (load == "auto" || !streamable)) ||
+                     (!convert.empty() && columns));
+    if (!streamable && !(mapInput && reader.IsBinary())) {
+        std::cerr << "Error: " << reader.Error() << "\n";
+        return 1;
+    }
+
+    std::shared_ptr<const LoadCaseFile> mapped;
+    if (mapInput) {
+        auto start = std::chrono::steady_clock::now();
+        mapped = LoadCaseFile::Open(input, columns ? LoadCaseFormat::Columns : LoadCaseFormat::Rows, threads);
+        if (!mapped->Ok()) {
+            std::cerr << "Error: " << mapped->Error() << "\n";
+            return 1;
+        }
+        std::cerr << (mapped->IsBinary() ? "Mapped " : "Mapped and parsed ") << mapped->View().count
+                  << " load cases in " << std::fixed << std::setprecision(3)
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s\n";
+    }
+
+    // Conversion only: CSV (or binary) in, binary load-case file out
+    if (!convert.empty()) {
+        if (columns && !mapped) {
+            std::cerr << "Error: --layout=columns needs an input file, not stdin\n";
+            return 2;
+        }
+
+        uint64_t count = 0;
+        bool ok;
+        if (mapped) {
+            const LoadCaseView& v = mapped->View();
+            std::vector<DesignLoads> rows;
+            std::vector<double> N, M;
+            if (columns && !v.IsColumns()) {
+                N.resize(v.count);
+                M.resize(v.count);
+                for (size_t i = 0; i < v.count; i++) {
+                    N[i] = v.rows[i].N;
+                    M[i] = v.rows[i].M;
+                }
+            } else if (!columns && v.IsColumns()) {
+                rows.resize(v.count);
+                for (size_t i = 0; i < v.count; i++) rows[i] = v[i];
+            }
+            count = v.count;
+            ok = columns ? LoadCaseWriter::WriteColumns(convert, v.IsColumns() ? v.N : N.data(),
+                                                        v.IsColumns() ? v.M : M.data(), v.count)
+                         : LoadCaseWriter::WriteFile(convert, v.IsColumns() ? rows.data() : v.rows, v.count);
+        } else {
+            LoadCaseWriter writer;
+            if (!writer.Open(convert)) {
+                std::cerr << "Error: cannot open " << convert << " for writing\n";
+                return 1;
+            }
+            std::vector<DesignLoads> block(options.blockSize > 0 ? options.blockSize : 65536);
+            while (size_t n = reader.Read(block.data(), block.size())) {
+                writer.Write(block.data(), n);
+            }
+            if (reader.Failed()) {
+                std::cerr << "Error: " << reader.Error() << "\n";
+                return 1;
+            }
+            count = writer.Count();
+            ok = writer.Close();
+        }
+        if (!ok) {
+            std::cerr << "Error: writing " << convert << " failed\n";
+            return 1;
+        }
+        std::cerr << "Converted " << count << " load cases to " << convert << "\n";
+        return 0;
+    }
+
+    if (output.empty()) {
+        std::cerr << "Error: --output=<file> is required (see --help)\n";
+        return 2;
+    }
+    options.compress = EndsWith(output, ".gz");
+    if (options.compress && !CsvWriter::COMPRESSION_AVAILABLE) {
+        std::cerr << "Error: " << output << " needs gzip output, built without zlib (CSV_WRITER_ZLIB)\n";
+        return 2;
+    }
+
+    // Designer output (diagram generation messages) goes to stderr, stdout may be a pipe
+    std::streambuf* coutBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+    std::unique_ptr<ReinforcementDesigner> designer;
+    if (!diagramFile.empty()) {
+        auto file = DiagramFile::Open(diagramFile, true);
+        if (!file) {
+            std::cout.rdbuf(coutBuffer);
+            std::cerr << "Error: cannot open diagram file " << diagramFile << "\n";
+            return 1;
+        }
+        designer = std::make_unique<ReinforcementDesigner>(file, solver);
+        if (designer->GetDiagram().Size() == 0) {
+            std::cout.rdbuf(coutBuffer);
+            std::cerr << "Error: diagram file " << diagramFile << " does not fit the designer\n";
+            return 1;
+        }
+    } else {
+        ConcreteProperties concrete = { -fcd * 1e6, -epsC2 / 1000.0, -epsCu / 1000.0 };
+        SteelProperties steel = { fyd * 1e6, Es * 1e9, epsUd / 1000.0 };
+        designer = std::make_unique<ReinforcementDesigner>(geom, concrete, steel, density, solver);
+    }
+    std::cout.rdbuf(coutBuffer);
+    designer->SetThreadCount(threads);
+    if (cacheResolution > 0.0) {
+        designer->SetCache(std::make_shared<DesignCache>(cacheResolution * 1000.0, cacheResolution * 1000.0));
+    }
+
+    DesignPipeline::Stats stats = mapped ? DesignPipeline::Run(*designer, mapped->View(), output, options)
+                                         : DesignPipeline::Run(*designer, reader, output, options);
+
+    std::cerr << std::fixed << std::setprecision(3)
+              << "Input: " << (input == "-" ? "stdin" : input) << (reader.IsBinary() ? " (binary" : " (CSV")
+              << (mapped ? ", mapped)" : ", streamed)") << "\n"
+              << "Load cases: " << stats.cases << ", converged: " << stats.converged
+              << ", failed: " << (stats.cases - stats.converged) << "\n"
+              << "Time: " << stats.seconds << " s (" << std::setprecision(0)
+              << (stats.seconds > 0.0 ? stats.cases / stats.seconds : 0.0) << " cases/s)\n"
+              << std::setprecision(3)
+              << "Stage busy time: read " << stats.readSeconds << " s, design " << stats.designSeconds
+              << " s, write " << stats.writeSeconds << " s\n"
+              << "Pipeline buffers: " << std::setprecision(1) << stats.bufferBytes / 1048576.0 << " MB ("
+              << options.blocks << " x " << options.blockSize << " cases)\n";
+    if (const auto& cache = designer->GetCache()) {
+        DesignCache::Stats cacheStats = cache->GetStats();
+        std::cerr << "Design cache: " << cacheStats.hits << " hits, " << cacheStats.misses << " misses, "
+                  << cacheStats.passes << " designed exactly (" << cacheStats.HitRate() * 100.0 << " % hits), "
+                  << cache->MemoryBytes() / 1048576.0 << " MB\n";
+    }
+
+    if (!stats.ok) {
+        std::cerr << "Error: " << stats.error << "\n";
+        return 1;
+    }
+    std::cerr << "Results written to " << output << "\n";
+    return 0;
+}
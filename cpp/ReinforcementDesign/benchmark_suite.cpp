@@ -0,0 +1,407 @@
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <streambuf>
+#include <vector>
+#include "MaterialProperties.h"
+#include "ConcreteIntegration.h"
+#include "ConcreteIntegrationFast.h"
+#include "ConcreteIntegrationPolygon.h"
+#include "InteractionDiagram.h"
+#include "InteractionSurface.h"
+#include "ReinforcementDesigner.h"
+#include "DesignGrid.h"
+#include "Benchmark.h"
+
+// Micro and macro benchmarks (see Benchmark.h for the options), e.g.
+//   benchmark_suite --filter=Integration --repetitions=10 --csv=benchmarks.csv
+// Section and materials are those of main.cpp.
+
+namespace {
+
+    struct Setup {
+        SectionGeometry geom;
+        ConcreteProperties concrete;
+        SteelProperties steel;
+
+        // Random strain states (eps(x) = k*x + q) over all integration zones
+        std::vector<double> epsTop, epsBot, k, q;
+
+        // Load cases with the pattern of main.cpp, spread over a larger range
+        std::vector<DesignLoads> loads;
+
+        Setup() {
+            geom.b = 0.3;
+            geom.h = 0.5;
+            geom.d1 = 0.05;
+            geom.d2 = 0.05;
+            concrete.fcd = -20.0e6;
+            concrete.epsC2 = -0.002;
+            concrete.epsCu = -0.0035;
+            steel.fyd = 435.0e6;
+            steel.Es = 200.0e9;
+            steel.epsUd = 0.010;
+
+            const size_t states = 4096;
+            std::mt19937_64 rng(12345);
+            std::uniform_real_distribution<double> eps(-0.0035, 0.010);
+            for (size_t i = 0; i < states; i++) {
+                double top = eps(rng), bot = eps(rng);
+                epsTop.push_back(top);
+                epsBot.push_back(bot);
+                k.push_back((top - bot) / geom.h);
+                q.push_back((top + bot) / 2.0);
+            }
+
+            const size_t cases = 65536;
+            loads.resize(cases);
+            for (size_t i = 0; i < cases; i++) {
+                double t = double(i % 1000) / 1000.0;
+                DesignLoads& ld = loads[i];
+                if (i % 5 < 2) {
+                    ld.N = 0.0;                           // pure bending
+                    ld.M = 10000.0 + t * 40000.0;
+                } else if (i % 5 < 4) {
+                    ld.N = -50000.0 - t * 100000.0;       // compression + bending
+                    ld.M = 15000.0 + t * 30000.0;
+                } else {
+                    ld.N = 10000.0 + t * 20000.0;         // small tension + bending
+                    ld.M = 20000.0 + t * 10000.0;
+                }
+            }
+        }
+    };
+
+    const Setup& Data() {
+        static const Setup setup;
+        return setup;
+    }
+
+    // Discards std::cout while alive (the designer and exporters report their progress)
+    class QuietCout {
+    private:
+        struct NullBuffer : std::streambuf {
+            int overflow(int c) override { return c; }
+        } null;
+        std::streambuf* saved;
+
+    public:
+        QuietCout() : saved(std::cout.rdbuf(&null)) {}
+        ~QuietCout() { std::cout.rdbuf(saved); }
+    };
+
+    // Designer built once per solver (diagram generation is benchmarked separately)
+    ReinforcementDesigner& Designer(DesignSolver solver) {
+        const Setup& s = Data();
+        QuietCout quiet;
+        static ReinforcementDesigner interpolation(s.geom, s.concrete, s.steel, 10, DesignSolver::Interpolation);
+        static ReinforcementDesigner newton(s.geom, s.concrete, s.steel, 10, DesignSolver::Newton);
+        return solver == DesignSolver::Newton ? newton : interpolation;
+    }
+
+    std::string TempFile(const char* name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+}
+
+// ---------------------------------------------------------------- integration (per strain state)
+
+static void Integration_Numerical(Bench::State& state) {
+    const Setup& s = Data();
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        Bench::DoNotOptimize(ConcreteIntegration::CalculateForce(s.epsTop[i], s.epsBot[i], s.geom.b, s.geom.h, s.concrete));
+        i = (i + 1) % s.epsTop.size();
+    }
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(Integration_Numerical);
+
+static void Integration_Analytical(Bench::State& state) {
+    const Setup& s = Data();
+    const MaterialLaws::ParabolaRectangle law(s.concrete);
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        Bench::DoNotOptimize(ConcreteIntegrationFast::CalculateForce(s.epsTop[i], s.epsBot[i], s.geom.b, s.geom.h, law));
+        i = (i + 1) % s.epsTop.size();
+    }
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(Integration_Analytical);
+
+static void Integration_AnalyticalJacobian(Bench::State& state) {
+    const Setup& s = Data();
+    const MaterialLaws::ParabolaRectangle law(s.concrete);
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        Bench::DoNotOptimize(ConcreteIntegrationFast::CalculateForceWithJacobian(s.epsTop[i], s.epsBot[i], s.geom.b, s.geom.h, law));
+        i = (i + 1) % s.epsTop.size();
+    }
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(Integration_AnalyticalJacobian);
+
+// One iteration = the whole batch of strain states
+static void Integration_Batch(Bench::State& state) {
+    const Setup& s = Data();
+    const MaterialLaws::ParabolaRectangle law(s.concrete);
+    std::vector<double> N(s.k.size()), M(s.k.size());
+    while (state.KeepRunning()) {
+        ConcreteIntegrationFast::FastConcreteNMBatch(s.k.data(), s.q.data(), s.k.size(), s.geom.b, s.geom.h, law,
+                                                      N.data(), M.data());
+        Bench::DoNotOptimize(N.data());
+        Bench::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.Iterations() * int64_t(s.k.size()));
+    state.SetLabel(std::to_string(ConcreteSimd::WidestLane::Width) + " lanes");
+}
+BENCHMARK(Integration_Batch);
+
+static void Integration_PolygonRectangle(Bench::State& state) {
+    const Setup& s = Data();
+    const PolygonSection section = PolygonSection::Rectangle(s.geom.b, s.geom.h);
+    const MaterialLaws::ParabolaRectangle law(s.concrete);
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        Bench::DoNotOptimize(ConcreteIntegrationPolygon::PolygonConcreteNM(section, s.k[i], s.q[i], law));
+        i = (i + 1) % s.k.size();
+    }
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(Integration_PolygonRectangle);
+
+// Arg = number of circle segments
+static void Integration_PolygonCircle(Bench::State& state) {
+    const Setup& s = Data();
+    const PolygonSection section = PolygonSection::Circle(s.geom.h, int(state.Range()));
+    const MaterialLaws::ParabolaRectangle law(s.concrete);
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        Bench::DoNotOptimize(ConcreteIntegrationPolygon::PolygonConcreteNM(section, s.k[i], s.q[i], law));
+        i = (i + 1) % s.k.size();
+    }
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(Integration_PolygonCircle)->Arg(16)->Arg(64);
+
+// ---------------------------------------------------------------- diagram generation
+
+// Arg = points between characteristic points
+static void Diagram_Generate(Bench::State& state) {
+    const Setup& s = Data();
+    InteractionDiagram diagram(s.geom, s.concrete, s.steel, 0.0, 10.0e-4);
+    while (state.KeepRunning()) {
+        CompactDiagram d = diagram.GenerateCompact(int(state.Range()));
+        Bench::DoNotOptimize(d.N.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * int64_t(diagram.GenerateCompact(int(state.Range())).Size()));
+}
+BENCHMARK(Diagram_Generate)->Arg(5)->Arg(10)->Arg(20)->Arg(50)->Arg(100);
+
+static void Diagram_GenerateAdaptive(Bench::State& state) {
+    const Setup& s = Data();
+    InteractionDiagram diagram(s.geom, s.concrete, s.steel, 0.0, 10.0e-4);
+    while (state.KeepRunning()) {
+        CompactDiagram d = diagram.GenerateAdaptiveCompact();
+        Bench::DoNotOptimize(d.N.data());
+    }
+    state.SetItemsProcessed(state.Iterations() * int64_t(diagram.GenerateAdaptiveCompact().Size()));
+}
+BENCHMARK(Diagram_GenerateAdaptive);
+
+static void Diagram_BasisMaterialize(Bench::State& state) {
+    const Setup& s = Data();
+    InteractionDiagram diagram(s.geom, s.concrete, s.steel, 0.0, 0.0);
+    const DiagramBasis basis = diagram.GenerateBasis(10);
+    std::vector<double> N(basis.Size()), M(basis.Size());
+    double as2 = 0.0;
+    while (state.KeepRunning()) {
+        basis.MaterializeNM(0.0, as2, N.data(), M.data());
+        Bench::DoNotOptimize(N.data());
+        Bench::ClobberMemory();
+        as2 += 1.0e-6;
+    }
+    state.SetItemsProcessed(state.Iterations() * int64_t(basis.Size()));
+}
+BENCHMARK(Diagram_BasisMaterialize);
+
+// Arg = meridians (10 points between characteristic points)
+static void Surface_Generate(Bench::State& state) {
+    const Setup& s = Data();
+    InteractionSurface surface = InteractionSurface::RectangularColumn(s.geom, s.concrete, s.steel, 5.0e-4, 10.0e-4);
+    while (state.KeepRunning()) {
+        surface.Generate(int(state.Range()), 10);
+        Bench::DoNotOptimize(surface);
+    }
+}
+BENCHMARK(Surface_Generate)->Arg(36);
+
+// ---------------------------------------------------------------- design
+
+static void Design_Interpolation(Bench::State& state) {
+    const Setup& s = Data();
+    const ReinforcementDesigner& designer = Designer(DesignSolver::Interpolation);
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        Bench::DoNotOptimize(designer.Design(s.loads[i], false));
+        i = (i + 1) % s.loads.size();
+    }
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(Design_Interpolation);
+
+static void Design_Newton(Bench::State& state) {
+    const Setup& s = Data();
+    const ReinforcementDesigner& designer = Designer(DesignSolver::Newton);
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        Bench::DoNotOptimize(designer.Design(s.loads[i], false));
+        i = (i + 1) % s.loads.size();
+    }
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(Design_Newton);
+
+// Repeated queries answered from a warm DesignCache (every case already cached)
+static void Design_CacheHit(Bench::State& state) {
+    const Setup& s = Data();
+    ReinforcementDesigner& designer = Designer(DesignSolver::Newton);
+    designer.SetCache(std::make_shared<DesignCache>(1.0, 1.0, size_t(64) << 20));
+    for (const DesignLoads& l : s.loads) designer.Design(l, false);
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        Bench::DoNotOptimize(designer.Design(s.loads[i], false));
+        i = (i + 1) % s.loads.size();
+    }
+    designer.SetCache(nullptr);
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(Design_CacheHit);
+
+// Arg = number of load cases. Cases cycle through the prepared pool in chunks of at most
+// the pool size, so memory stays bounded for 10^7 cases.
+template <DesignSolver Solver>
+static void BatchDesign(Bench::State& state) {
+    const Setup& s = Data();
+    ReinforcementDesigner& designer = Designer(Solver);
+    const size_t count = size_t(state.Range());
+    const size_t chunk = std::min(count, s.loads.size());
+    std::vector<DesignResult> results(chunk);
+    while (state.KeepRunning()) {
+        for (size_t done = 0; done < count; done += chunk) {
+            size_t n = std::min(chunk, count - done);
+            designer.DesignBatch(s.loads.data(), n, results.data());
+            Bench::DoNotOptimize(results.data());
+            Bench::ClobberMemory();
+        }
+    }
+    state.SetItemsProcessed(state.Iterations() * int64_t(count));
+}
+
+static void Batch_Interpolation(Bench::State& state) { BatchDesign<DesignSolver::Interpolation>(state); }
+BENCHMARK(Batch_Interpolation)->Range(1000, 10000000, 10);
+
+static void Batch_Newton(Bench::State& state) { BatchDesign<DesignSolver::Newton>(state); }
+BENCHMARK(Batch_Newton)->Range(1000, 1000000, 10);
+
+// Same cases as Batch_Newton, designed as member envelopes (only the governing cases)
+static void Batch_Envelope(Bench::State& state) {
+    const Setup& s = Data();
+    ReinforcementDesigner& designer = Designer(DesignSolver::Newton);
+    const size_t count = size_t(state.Range());
+    const size_t chunk = std::min(count, s.loads.size());
+    std::vector<DesignResult> results(chunk);
+    while (state.KeepRunning()) {
+        for (size_t done = 0; done < count; done += chunk) {
+            size_t n = std::min(chunk, count - done);
+            designer.DesignEnvelope(s.loads.data(), n, results.data());
+            Bench::DoNotOptimize(results.data());
+            Bench::ClobberMemory();
+        }
+    }
+    state.SetItemsProcessed(state.Iterations() * int64_t(count));
+}
+BENCHMARK(Batch_Envelope)->Range(1000, 1000000, 10);
+
+// Grid of the Newton designer over its default domain (all cases of any As2 up to 4 %)
+static void Grid_Build(Bench::State& state) {
+    ReinforcementDesigner& designer = Designer(DesignSolver::Newton);
+    while (state.KeepRunning()) {
+        Bench::DoNotOptimize(DesignGrid::Build(designer).GetStats());
+    }
+    state.SetItemsProcessed(state.Iterations());
+}
+BENCHMARK(Grid_Build);
+
+// Same cases as Batch_Newton as As2 lookups in that grid, over load columns
+static void Batch_GridLookup(Bench::State& state) {
+    const Setup& s = Data();
+    static const DesignGrid grid = DesignGrid::Build(Designer(DesignSolver::Newton));
+    const size_t count = size_t(state.Range());
+    const size_t chunk = std::min(count, s.loads.size());
+    std::vector<double> N(chunk), M(chunk), As2(chunk);
+    std::vector<uint8_t> valid(chunk);
+    for (size_t i = 0; i < chunk; i++) {
+        N[i] = s.loads[i].N;
+        M[i] = s.loads[i].M;
+    }
+    while (state.KeepRunning()) {
+        for (size_t done = 0; done < count; done += chunk) {
+            size_t n = std::min(chunk, count - done);
+            Bench::DoNotOptimize(grid.Lookup(N.data(), M.data(), n, As2.data(), valid.data()));
+            Bench::ClobberMemory();
+        }
+    }
+    state.SetItemsProcessed(state.Iterations() * int64_t(count));
+}
+BENCHMARK(Batch_GridLookup)->Range(1000, 1000000, 10);
+
+// Single-threaded loop over Design, for the parallel speedup of DesignBatch
+static void Batch_Serial(Bench::State& state) {
+    const Setup& s = Data();
+    const ReinforcementDesigner& designer = Designer(DesignSolver::Interpolation);
+    const size_t count = size_t(state.Range());
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < count; i++) {
+            Bench::DoNotOptimize(designer.Design(s.loads[i % s.loads.size()], false));
+        }
+    }
+    state.SetItemsProcessed(state.Iterations() * int64_t(count));
+}
+BENCHMARK(Batch_Serial)->Range(1000, 100000, 10);
+
+// ---------------------------------------------------------------- export
+
+// Arg = number of result rows
+static void Export_DesignResultsCSV(Bench::State& state) {
+    const Setup& s = Data();
+    const size_t count = std::min(size_t(state.Range()), s.loads.size());
+    std::vector<DesignResult> results(count);
+    Designer(DesignSolver::Interpolation).DesignBatch(s.loads.data(), count, results.data());
+    const std::string file = TempFile("benchmark_design_results.csv");
+    QuietCout quiet;
+    while (state.KeepRunning()) {
+        ReinforcementDesigner::ExportResultsToCSV(s.loads.data(), results.data(), count, file);
+    }
+    state.SetItemsProcessed(state.Iterations() * int64_t(count));
+    state.SetBytesProcessed(state.Iterations() * int64_t(std::filesystem::file_size(file)));
+    std::remove(file.c_str());
+}
+BENCHMARK(Export_DesignResultsCSV)->Arg(1000)->Arg(65536);
+
+static void Export_DiagramCSV(Bench::State& state) {
+    const Setup& s = Data();
+    InteractionDiagram diagram(s.geom, s.concrete, s.steel, 0.0, 10.0e-4);
+    const CompactDiagram d = diagram.GenerateCompact(100);
+    const std::string file = TempFile("benchmark_diagram.csv");
+    QuietCout quiet;
+    while (state.KeepRunning()) {
+        InteractionDiagram::ExportToCSV(d, file);
+    }
+    state.SetItemsProcessed(state.Iterations() * int64_t(d.Size()));
+    state.SetBytesProcessed(state.Iterations() * int64_t(std::filesystem::file_size(file)));
+    std::remove(file.c_str());
+}
+BENCHMARK(Export_DiagramCSV);
+
+BENCHMARK_MAIN();
@@ -1,13 +1,24 @@
 #include <iostream>
 #include <iomanip>
+#include <thread>
 #include "MaterialProperties.h"
 #include "ReinforcementDesigner.h"
 #include "InteractionDiagram.h"
+#include "DiagramCache.h"
+#include "DiagramFile.h"
+#include "InteractionSurface.h"
 #include "PerformanceTimer.h"
 
-int main() {
+int main(int argc, char** argv) {
     // Create performance timer
     PerformanceTimer timer(true);  // Enable auto-logging
+    timer.EnableTrace();           // timeline for chrome://tracing / Perfetto (performance_trace.json)
+
+    // --counters: hardware counters (cycles, instructions, branch and LLC misses) per scope
+    if (argc > 1 && std::string(argv[1]) == "--counters") {
+        timer.EnableHardwareCounters();
+        std::cout << "Hardware counters: " << timer.HardwareCountersStatus() << "\n\n";
+    }
 
     std::cout << "==========================================================\n";
     std::cout << "  REINFORCEMENT DESIGN FOR RC CROSS-SECTION (Variant 2)\n";
@@ -80,24 +91,29 @@ int main() {
     std::cout << "  GENERATING INTERACTION DIAGRAM\n";
     std::cout << "==========================================================\n\n";
 
-    // Generate concrete-only diagram
-    std::cout << "Generating concrete-only diagram...\n";
-    timer.Start("ConcreteOnlyDiagramGeneration");
-    InteractionDiagram diagramConcrete(geom, concrete, steel, 0.0, 0.0);
-    auto pointsConcrete = diagramConcrete.Generate(10);  // 10 interpolation points between characteristic points
+    // Generate the reinforcement-independent basis once (all concrete integrations happen here)
+    std::cout << "Generating diagram basis...\n";
+    timer.Start("DiagramBasisGeneration");
+    InteractionDiagram diagramGen(geom, concrete, steel);
+    DiagramBasis basis = diagramGen.GenerateBasis(10);  // 10 interpolation points between characteristic points
     timer.Stop("8 characteristic + 70 interpolated points");
 
+    // Concrete-only diagram
+    std::cout << "Materializing concrete-only diagram...\n";
+    timer.Start("ConcreteOnlyDiagramMaterialize");
+    auto pointsConcrete = basis.Materialize(0.0, 0.0);
+    timer.Stop("from basis, no integrations");
+
     timer.Start("ConcreteOnlyDiagramExportCSV");
     InteractionDiagram::ExportToCSV(pointsConcrete, "interaction_diagram_concrete_only.csv");
     timer.Stop();
 
-    // Generate diagram with reinforcement As2 = 10 cm^2
-    std::cout << "\nGenerating diagram with reinforcement (As1=0, As2=10 cm^2)...\n";
-    timer.Start("WithReinforcementDiagramGeneration");
+    // Diagram with reinforcement As2 = 10 cm^2
+    std::cout << "\nMaterializing diagram with reinforcement (As1=0, As2=10 cm^2)...\n";
+    timer.Start("WithReinforcementDiagramMaterialize");
     double As2_diagram = 10.0 / 10000.0;  // 10 cm^2 to m^2
-    InteractionDiagram diagramWithReinf(geom, concrete, steel, 0.0, As2_diagram);
-    auto pointsWithReinf = diagramWithReinf.Generate(10);
-    timer.Stop("As2=10 cm^2, 78 total points");
+    auto pointsWithReinf = basis.Materialize(0.0, As2_diagram);
+    timer.Stop("As2=10 cm^2, from basis, no integrations");
 
     timer.Start("WithReinforcementDiagramExportCSV");
     InteractionDiagram::ExportToCSV(pointsWithReinf, "interaction_diagram_with_reinforcement.csv");
@@ -113,6 +129,32 @@ int main() {
     ReinforcementDesigner designer(geom, concrete, steel, 10);
     timer.Stop("Generate diagram once, reuse for all designs");
 
+    // Same section through the diagram cache: the first call generates (or loads from disk on
+    // later runs), the second is a memory hit
+    DiagramCache diagramCache(16, "diagram_cache");
+    timer.Start("DesignerInitialization_Cache");
+    ReinforcementDesigner cachedDesigner(geom, concrete, steel, diagramCache, 10);
+    timer.Stop("generated or loaded from disk");
+
+    timer.Start("DesignerInitialization_CacheHit");
+    ReinforcementDesigner cachedDesigner2(geom, concrete, steel, diagramCache, 10);
+    timer.Stop("memory hit");
+
+    DiagramCache::Stats cacheStats = diagramCache.GetStats();
+    std::cout << "Diagram cache: " << cacheStats.memoryHits << " memory hits, "
+              << cacheStats.diskHits << " disk hits, " << cacheStats.misses << " misses\n";
+
+    // Binary diagram file: written once, then mapped and used by the designer in place
+    DiagramFile::Write("interaction_diagram_concrete_only.diag", designer.GetDiagram(), geom, concrete, steel);
+    timer.Start("DesignerInitialization_MappedFile");
+    auto diagramFile = DiagramFile::Open("interaction_diagram_concrete_only.diag");
+    if (diagramFile) {
+        ReinforcementDesigner mappedDesigner(diagramFile);
+        timer.Stop("zero-copy load of binary diagram");
+    } else {
+        timer.Stop("binary diagram could not be opened");
+    }
+
     // Design for first load case
     timer.Start("Design_LoadCase1_N0_M30");
     DesignResult result = designer.Design(loads);
@@ -225,12 +267,89 @@ int main() {
     std::cout << "  Average per design: " << (batchTime / batchLoads.size()) << " ms\n";
     std::cout << "  Designs per second: " << (1000.0 / batchTime * 1000.0) << "\n";
 
+
+    // Same batch with the exact Newton solver (warm-started from the diagram bracket)
+    designer.SetSolver(DesignSolver::Newton);
+
+    timer.Start("Batch_1000_Designs_Newton");
+    int newtonSuccess = 0;
+    int newtonIterations = 0;
+    double newtonMaxError = 0.0;
+
+    for (const auto& ld : batchLoads) {
+        DesignResult res = designer.Design(ld, false);
+        if (res.converged) {
+            newtonSuccess++;
+            newtonIterations += res.iterations;
+            newtonMaxError = std::max(newtonMaxError, res.errorRel);
+        }
+    }
+
+    double newtonTime = timer.Stop("1000 N,M combinations, Newton solver");
+
+    std::cout << "\nNewton batch results:\n";
+    std::cout << "  Successful designs: " << newtonSuccess << " / " << batchLoads.size() << "\n";
+    std::cout << "  Average iterations: " << (newtonSuccess > 0 ? double(newtonIterations) / newtonSuccess : 0.0) << "\n";
+    std::cout << "  Max relative error: " << std::scientific << newtonMaxError << std::fixed << "\n";
+    std::cout << "  Total time: " << newtonTime << " ms\n";
+    std::cout << "  Average per design: " << (newtonTime / batchLoads.size()) << " ms\n";
+
+    // Same batch on the work-stealing pool, designed into a preallocated output array
+    std::vector<DesignResult> parallelResults(batchLoads.size());
+
+    designer.SetProfiler(&timer);  // per-design latency (p50/p99) as a nested "Design" scope
+    timer.Start("Batch_1000_Designs_Parallel");
+    designer.DesignBatch(batchLoads.data(), batchLoads.size(), parallelResults.data());
+    double parallelTime = timer.Stop("1000 N,M combinations, Newton solver, all threads");
+    designer.SetProfiler(nullptr);
+
+    int mismatchCount = 0;
+    for (size_t i = 0; i < batchLoads.size(); i++) {
+        DesignResult serial = designer.Design(batchLoads[i], false);
+        if (serial.converged != parallelResults[i].converged || serial.As2 != parallelResults[i].As2) {
+            mismatchCount++;
+        }
+    }
+
+    std::cout << "\nParallel batch results:\n";
+    std::cout << "  Threads: " << std::thread::hardware_concurrency() << "\n";
+    std::cout << "  Mismatches vs. serial: " << mismatchCount << " / " << batchLoads.size() << "\n";
+    std::cout << "  Total time: " << parallelTime << " ms\n";
+
+    timer.Start("Batch_1000_Designs_ExportCSV");
+    ReinforcementDesigner::ExportResultsToCSV(batchLoads, parallelResults, "batch_design_results.csv");
+    timer.Stop();
+    std::cout << "\n==========================================================\n";
+
+    // ========== BIAXIAL BENDING: N-My-Mz INTERACTION SURFACE ==========
+    std::cout << "\n==========================================================\n";
+    std::cout << "  BIAXIAL INTERACTION SURFACE (corner bars 4 x 5 cm^2)\n";
+    std::cout << "==========================================================\n\n";
+
+    timer.Start("InteractionSurface_Generate");
+    InteractionSurface surface = InteractionSurface::RectangularColumn(geom, concrete, steel, 10.0 / 10000.0, 10.0 / 10000.0);
+    surface.SetProfiler(&timer);  // meridians per thread on the trace timeline
+    surface.Generate(36, 10);
+    timer.Stop("36 meridians x 81 strain states, triangle mesh + direction index");
+
+    std::cout << "Vertices: " << surface.VertexCount() << ", triangles: " << surface.Triangles().size() << "\n";
+    const double biaxialLoads[3][3] = { { -500.0, 60.0, 30.0 }, { -1000.0, 120.0, 80.0 }, { 0.0, 90.0, 90.0 } };
+    timer.Start("InteractionSurface_CapacityChecks");
+    for (const auto& l : biaxialLoads) {
+        double u = surface.Utilization(l[0], l[1], l[2]);
+        std::cout << "  N=" << l[0] << " kN, My=" << l[1] << " kNm, Mz=" << l[2] << " kNm: utilization "
+                  << std::fixed << std::setprecision(3) << u << (u <= 1.0 ? " (OK)" : " (FAILS)") << "\n";
+    }
+    timer.Stop("3 biaxial loads");
+
+    surface.ExportToCSV("interaction_surface.csv");
     std::cout << "\n==========================================================\n";
 
     // ========== PERFORMANCE ANALYSIS ==========
     timer.PrintSummary();
     timer.Analyze();
     timer.ExportToCSV("performance_results.csv");
+    timer.ExportTrace("performance_trace.json");
 
     std::cout << "\nPress Enter to exit...";
     std::cin.get();
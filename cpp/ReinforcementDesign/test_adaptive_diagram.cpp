@@ -0,0 +1,103 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "MaterialProperties.h"
+#include "InteractionDiagram.h"
+#include "TestSupport.h"
+
+// Adaptive densification: points lie on the strain lines of the uniform diagram, the chords
+// stay close to the curve sampled densely between them, and fewer points are needed than with
+// uniform densification of the same chord error.
+
+// Position along the diagram: segment + t, characteristic point Pi at i
+static double Position(const CompactDiagram& d, size_t i) {
+    return d.kind[i] == DiagramPointKind::Characteristic ? d.segment[i] : d.segment[i] + d.t[i];
+}
+
+// Largest distance, in (N/tolN, M/tolM), of the dense diagram's points from the chords of the
+// coarse diagram; both run along the same strain lines
+static double MaxChordError(const CompactDiagram& coarse, const CompactDiagram& dense, double tolN, double tolM) {
+    double worst = 0.0;
+    size_t c = 0;  // chord c -> c + 1
+    for (size_t i = 0; i < dense.Size(); i++) {
+        while (c + 2 < coarse.Size() && Position(coarse, c + 1) < Position(dense, i)) c++;
+        double ax = coarse.N[c] / tolN, ay = coarse.M[c] / tolM;
+        double bx = coarse.N[c + 1] / tolN, by = coarse.M[c + 1] / tolM;
+        double px = dense.N[i] / tolN, py = dense.M[i] / tolM;
+        double dx = bx - ax, dy = by - ay, len2 = dx * dx + dy * dy;
+        double s = len2 > 0.0 ? std::clamp(((px - ax) * dx + (py - ay) * dy) / len2, 0.0, 1.0) : 0.0;
+        worst = std::max(worst, std::hypot(px - ax - s * dx, py - ay - s * dy));
+    }
+    return worst;
+}
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+    const double as = 10.0 / 10000.0;
+
+    TestSupport::PrintHeader("ADAPTIVE DENSIFICATION (chord error)");
+
+    InteractionDiagram generator(geom, concrete, steel, 0.5 * as, as);
+    const int denseSteps = 256;  // t = i/256 holds every bisection point down to maxDepth 8
+    CompactDiagram dense = generator.GenerateCompact(denseSteps);
+
+    bool onStrainLines = true, depthsOk = true, fewerPoints = true;
+    double worstRatio = 0.0;
+    std::cout << std::fixed << std::setprecision(2);
+    for (double scale : { 4.0, 1.0, 0.25 }) {
+        AdaptiveDensification opts;
+        opts.tolN *= scale;
+        opts.tolM *= scale;
+        CompactDiagram adaptive = generator.GenerateAdaptiveCompact(opts);
+
+        // Every point is the dense point of the same segment and t, bit for bit; each segment
+        // has between 2^minDepth - 1 and 2^maxDepth - 1 interior points
+        std::vector<int> interior(CHARACTERISTIC_POINT_COUNT - 1, 0);
+        for (size_t i = 0; i < adaptive.Size(); i++) {
+            size_t j;
+            if (adaptive.kind[i] == DiagramPointKind::Characteristic) {
+                j = size_t(adaptive.segment[i]) * denseSteps;
+            } else {
+                interior[adaptive.segment[i]]++;
+                double steps = adaptive.t[i] * denseSteps;
+                onStrainLines = onStrainLines && steps == std::floor(steps) &&
+                                adaptive.kind[i] == DiagramPointKind::Adaptive;
+                j = size_t(adaptive.segment[i]) * denseSteps + size_t(steps);
+            }
+            onStrainLines = onStrainLines && j < dense.Size() && adaptive.N[i] == dense.N[j] &&
+                            adaptive.M[i] == dense.M[j] && adaptive.epsTop[i] == dense.epsTop[j] &&
+                            adaptive.epsBot[i] == dense.epsBot[j];
+        }
+        for (int n : interior) {
+            depthsOk = depthsOk && n >= (1 << opts.minDepth) - 1 && n <= (1 << opts.maxDepth) - 1;
+        }
+
+        // Chord error between the points (bisection tests only the midpoints, so it may exceed
+        // the tolerance somewhat next to a kink), and the uniform density that first reaches it
+        double adaptiveError = MaxChordError(adaptive, dense, opts.tolN, opts.tolM);
+        int uniformDensity = 1;
+        while (uniformDensity < denseSteps &&
+               MaxChordError(generator.GenerateCompact(uniformDensity), dense, opts.tolN, opts.tolM) > adaptiveError) {
+            uniformDensity++;
+        }
+        size_t uniformPoints = generator.GenerateCompact(uniformDensity).Size();
+        fewerPoints = fewerPoints && adaptive.Size() < uniformPoints;
+        worstRatio = std::max(worstRatio, adaptiveError);
+
+        std::cout << "Tolerance " << opts.tolN << " kN / " << opts.tolM << " kNm: " << adaptive.Size()
+                  << " points, chord error " << adaptiveError << " x tolerance; uniform needs " << uniformPoints
+                  << " points (density " << uniformDensity << ")\n";
+    }
+    std::cout << "\n";
+
+    checks.Expect(onStrainLines, "Adaptive points are not on the strain lines of the uniform diagram");
+    checks.Expect(depthsOk, "Adaptive segments break minDepth or maxDepth");
+    checks.Expect(worstRatio <= 1.5, "Chords of the adaptive diagram are far outside the tolerance");
+    checks.Expect(fewerPoints, "Adaptive diagram is not smaller than a uniform one of the same chord error");
+    return checks.Finish("Adaptive densification meets the chord tolerance with fewer points");
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include "MaterialProperties.h"
+#include "ReinforcementDesigner.h"
+#include "TestSupport.h"
+
+// Bracket index: the monotone-run lookup finds the same diagram segment as a linear scan over
+// consecutive diagram points, including loads at the ends of the runs and just outside them.
+
+// Linear scan: the first segment whose bracket keys g = M - z2*N enclose the load's key
+static std::pair<int, int> ScanBracket(const DiagramView& d, double z2, double g) {
+    for (size_t i = 0; i + 1 < d.Size(); i++) {
+        double g1 = d.M[i] * 1000.0 - z2 * d.N[i] * 1000.0;
+        double g2 = d.M[i + 1] * 1000.0 - z2 * d.N[i + 1] * 1000.0;
+        if (std::min(g1, g2) <= g && g <= std::max(g1, g2)) return {(int)i, (int)i + 1};
+    }
+    return {-1, -1};
+}
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+    const double z2 = geom.h / 2.0 - geom.d2;
+
+    TestSupport::PrintHeader("BRACKET INDEX (monotone runs vs. linear scan)");
+
+    size_t cases = 0, differ = 0, notBracketing = 0, outsideFound = 0, nonFiniteFound = 0;
+    for (int density : { 2, 10, 40 }) {
+        ReinforcementDesigner designer(geom, concrete, steel, density, DesignSolver::Interpolation);
+        const DiagramView& d = designer.GetDiagram();
+        auto key = [&](size_t i) { return d.M[i] * 1000.0 - z2 * d.N[i] * 1000.0; };
+
+        // Loads of a given key g (any N will do, the lookup only depends on g)
+        std::vector<double> keys;
+        double gMin = key(0), gMax = key(0);
+        for (size_t i = 0; i < d.Size(); i++) {
+            keys.push_back(key(i));  // every point, so every run end and turning point
+            gMin = std::min(gMin, key(i));
+            gMax = std::max(gMax, key(i));
+        }
+        for (size_t i = 0; i + 1 < d.Size(); i++) {
+            keys.push_back(0.5 * (key(i) + key(i + 1)));
+        }
+        std::mt19937 rng(density);
+        std::uniform_real_distribution<double> u(gMin, gMax);
+        for (int i = 0; i < 2000; i++) keys.push_back(u(rng));
+
+        for (double g : keys) {
+            const DesignLoads loads = { -400e3, g - z2 * 400e3 };
+            auto indexed = designer.Bracket(loads);
+            auto scanned = ScanBracket(d, z2, loads.M - z2 * loads.N);
+            cases++;
+            if (indexed != scanned) {
+                // Several segments can enclose g only at a shared key (a turning point or a flat
+                // stretch); the lookup may return any of them, as long as it brackets g
+                double gl = loads.M - z2 * loads.N;
+                bool tie = indexed.first >= 0 && scanned.first >= 0 &&
+                           (key(scanned.first) == gl || key(scanned.second) == gl);
+                if (!tie) differ++;
+            }
+            if (indexed.first >= 0) {
+                double g1 = key(indexed.first), g2 = key(indexed.second), gl = loads.M - z2 * loads.N;
+                if (indexed.second != indexed.first + 1 || std::min(g1, g2) > gl || gl > std::max(g1, g2)) notBracketing++;
+            }
+        }
+
+        // Just beyond the ends of the outermost runs: nothing to bracket
+        for (double g : { gMin - 1e-6 * std::abs(gMin) - 1.0, gMax + 1e-6 * std::abs(gMax) + 1.0 }) {
+            const DesignLoads loads = { 0.0, g };
+            cases++;
+            if (designer.Bracket(loads).first != -1 || ScanBracket(d, z2, g).first != -1) outsideFound++;
+        }
+
+        // NaN or inf in N or M: not bracketed, and neither solver designs the load
+        const double nan = std::numeric_limits<double>::quiet_NaN(), inf = std::numeric_limits<double>::infinity();
+        for (const DesignLoads& loads : std::vector<DesignLoads>{ { nan, 50e3 }, { -400e3, nan }, { inf, 50e3 },
+                                                                  { -400e3, -inf }, { inf, inf }, { -inf, nan } }) {
+            cases++;
+            designer.SetSolver(DesignSolver::Interpolation);
+            bool interpolated = designer.Design(loads, false).converged;
+            designer.SetSolver(DesignSolver::Newton);
+            bool solved = designer.Design(loads, false).converged;
+            designer.SetSolver(DesignSolver::Interpolation);
+            if (designer.Bracket(loads).first != -1 || interpolated || solved) nonFiniteFound++;
+        }
+    }
+
+    std::cout << "Loads: " << cases << ", different segment: " << differ << ", not bracketing: " << notBracketing
+              << ", bracketed beyond the diagram: " << outsideFound << ", non-finite bracketed or designed: "
+              << nonFiniteFound << "\n\n";
+
+    checks.Expect(differ == 0, "Bracket index finds a different segment than the linear scan");
+    checks.Expect(notBracketing == 0, "Bracket index returns a segment that does not enclose the load");
+    checks.Expect(outsideFound == 0, "Load beyond the diagram is bracketed");
+    checks.Expect(nonFiniteFound == 0, "Load with NaN or inf is bracketed or designed");
+    return checks.Finish("Bracket index agrees with the linear scan");
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "MaterialProperties.h"
+#include "InteractionDiagram.h"
+#include "TestSupport.h"
+
+// Compact diagram: the columns, ToPoints and the rebuilt names are the diagram that
+// DiagramPoint vectors carried before, and uniform generation allocates each column once.
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+    const double as = 10.0 / 10000.0;
+
+    TestSupport::PrintHeader("COMPACT DIAGRAM (SoA columns, rebuilt names)");
+
+    InteractionDiagram generator(geom, concrete, steel, 0.5 * as, as);
+    bool namesOk = true, columnsOk = true, reserved = true;
+    size_t points = 0;
+    for (int density : { 1, 2, 10, 25 }) {
+        CompactDiagram compact = generator.GenerateCompact(density);
+        std::vector<DiagramPoint> vec = generator.Generate(density);
+
+        // Names as the former generator built them, in diagram order
+        std::vector<std::string> names = { CHARACTERISTIC_POINT_NAMES[0] };
+        for (int seg = 0; seg + 1 < CHARACTERISTIC_POINT_COUNT; seg++) {
+            for (int i = 1; i < density; i++) {
+                names.push_back(std::string("Interp_") + CHARACTERISTIC_POINT_NAMES[seg] + "_to_" +
+                                CHARACTERISTIC_POINT_NAMES[seg + 1] + "_" + std::to_string(i));
+            }
+            names.push_back(CHARACTERISTIC_POINT_NAMES[seg + 1]);
+        }
+        namesOk = namesOk && compact.Size() == names.size() && vec.size() == names.size();
+        for (size_t i = 0; namesOk && i < names.size(); i++) {
+            namesOk = compact.Name(i) == names[i] && vec[i].name == names[i];
+        }
+
+        // ToPoints and View read the same columns
+        const DiagramView view = compact.View();
+        for (size_t i = 0; columnsOk && i < compact.Size() && i < vec.size(); i++) {
+            const DiagramPoint& p = vec[i];
+            columnsOk = p.epsTop == view.epsTop[i] && p.epsBot == view.epsBot[i] && p.epsS1 == view.epsS1[i] &&
+                        p.epsS2 == view.epsS2[i] && p.sigS1 == view.sigS1[i] && p.sigS2 == view.sigS2[i] &&
+                        p.N == view.N[i] && p.M == view.M[i] && p.Fc == view.Fc[i] && p.Mc == view.Mc[i] &&
+                        p.Fs1 == view.Fs1[i] && p.Fs2 == view.Fs2[i] && p.As1 == compact.As1 && p.As2 == compact.As2 &&
+                        view.kind[i] == compact.kind[i] && view.segment[i] == compact.segment[i];
+        }
+        columnsOk = columnsOk && view.Size() == compact.Size() && compact.As1 == 0.5 * as * 10000.0 &&
+                    compact.As2 == as * 10000.0;
+
+        // Reserved up front: no column grew past the point count
+        reserved = reserved && compact.N.capacity() == compact.Size() && compact.t.capacity() == compact.Size() &&
+                   compact.kind.capacity() == compact.Size();
+        points += compact.Size();
+    }
+
+    // Adaptive points are named per segment in order, "Adapt_<Pi>_to_<Pi+1>_<k>"
+    CompactDiagram adaptive = generator.GenerateAdaptiveCompact();
+    bool adaptiveNamesOk = adaptive.Size() > size_t(CHARACTERISTIC_POINT_COUNT);
+    uint32_t counter = 0;
+    for (size_t i = 0; adaptiveNamesOk && i < adaptive.Size(); i++) {
+        int seg = adaptive.segment[i];
+        if (adaptive.kind[i] == DiagramPointKind::Characteristic) {
+            counter = 0;
+            adaptiveNamesOk = adaptive.Name(i) == CHARACTERISTIC_POINT_NAMES[seg];
+        } else {
+            adaptiveNamesOk = adaptive.Name(i) == std::string("Adapt_") + CHARACTERISTIC_POINT_NAMES[seg] + "_to_" +
+                                                  CHARACTERISTIC_POINT_NAMES[seg + 1] + "_" + std::to_string(++counter);
+        }
+    }
+
+    std::cout << "Uniform diagrams (" << points << " points): names as before " << (namesOk ? "yes" : "NO")
+              << ", columns = ToPoints " << (columnsOk ? "yes" : "NO") << ", reserved up front "
+              << (reserved ? "yes" : "NO") << "\n";
+    std::cout << "Adaptive diagram (" << adaptive.Size() << " points): names " << (adaptiveNamesOk ? "ok" : "WRONG") << "\n\n";
+
+    checks.Expect(namesOk, "Rebuilt point names differ from the former names");
+    checks.Expect(columnsOk, "Compact columns and ToPoints disagree");
+    checks.Expect(reserved, "Uniform generation reallocates its columns");
+    checks.Expect(adaptiveNamesOk, "Adaptive point names are wrong");
+    return checks.Finish("Compact diagram is the point diagram without stored names");
+}
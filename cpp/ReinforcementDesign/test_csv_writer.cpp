@@ -0,0 +1,178 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "MaterialProperties.h"
+#include "InteractionDiagram.h"
+#include "ReinforcementDesigner.h"
+#include "CsvWriter.h"
+#include "TestSupport.h"
+
+// CSV writer: the diagram export keeps the columns of the former ofstream export, numbers read
+// back bit for bit, block writes do not depend on the buffer size, and a compressed writer
+// writes gzip, or without zlib refuses to open.
+
+static std::vector<std::vector<std::string>> SplitCsv(const std::string& text) {
+    std::vector<std::vector<std::string>> rows;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::vector<std::string> fields;
+        std::istringstream cells(line);
+        std::string cell;
+        while (std::getline(cells, cell, ',')) fields.push_back(cell);
+        rows.push_back(fields);
+    }
+    return rows;
+}
+
+static bool SameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+int main() {
+    TestSupport::Checks checks;
+    TestSupport::ScratchDirectory scratch("test_csv_writer");
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+    const double as = 10.0 / 10000.0;
+
+    TestSupport::PrintHeader("CSV WRITER (to_chars, buffered)");
+
+    // Diagram export vs. the former ofstream export (operator<<, 6 significant digits)
+    std::vector<DiagramPoint> points = InteractionDiagram(geom, concrete, steel, 0.5 * as, as).Generate(10);
+    const std::string newFile = scratch.File("diagram.csv");
+    InteractionDiagram::ExportToCSV(points, newFile);
+    std::ostringstream old;
+    old << "Name,epsTop[o/oo],epsBot[o/oo],epsS1[o/oo],epsS2[o/oo],"
+           "sigS1[MPa],sigS2[MPa],N[kN],M[kNm],Fc[kN],Mc[kNm],"
+           "Fs1[kN],Fs2[kN],As1[cm^2],As2[cm^2]\n";
+    for (const auto& pt : points) {
+        old << pt.name << ","
+            << pt.epsTop << "," << pt.epsBot << ","
+            << pt.epsS1 << "," << pt.epsS2 << ","
+            << pt.sigS1 << "," << pt.sigS2 << ","
+            << pt.N << "," << pt.M << ","
+            << pt.Fc << "," << pt.Mc << ","
+            << pt.Fs1 << "," << pt.Fs2 << ","
+            << pt.As1 << "," << pt.As2 << "\n";
+    }
+    const auto oldRows = SplitCsv(old.str());
+    const auto newRows = SplitCsv(TestSupport::ReadFile(newFile));
+    bool columnsSame = !newRows.empty() && newRows.size() == oldRows.size() && newRows[0] == oldRows[0];
+    double maxDiff = 0.0;
+    for (size_t r = 1; columnsSame && r < newRows.size(); r++) {
+        columnsSame = newRows[r].size() == oldRows[r].size() && newRows[r][0] == oldRows[r][0];
+        for (size_t c = 1; columnsSame && c < newRows[r].size(); c++) {
+            double a = std::strtod(newRows[r][c].c_str(), nullptr), b = std::strtod(oldRows[r][c].c_str(), nullptr);
+            maxDiff = std::max(maxDiff, std::abs(a - b) / std::max(std::abs(a), 1e-300));
+        }
+    }
+    // Compact diagram: same file as the point vector
+    const std::string compactFile = scratch.File("compact.csv");
+    InteractionDiagram::ExportToCSV(InteractionDiagram(geom, concrete, steel, 0.5 * as, as).GenerateCompact(10), compactFile);
+    bool compactSame = TestSupport::ReadFile(compactFile) == TestSupport::ReadFile(newFile);
+    std::cout << "Diagram export: " << newRows.size() << " lines, columns as before: " << (columnsSame ? "yes" : "NO")
+              << ", compact export identical: " << (compactSame ? "yes" : "NO")
+              << ", max relative difference to 6 digits: " << std::scientific << std::setprecision(2) << maxDiff << "\n";
+
+    // Numbers round-trip bit for bit (extremes, subnormals, signed zero, random bit patterns);
+    // fixed and integer fields read as ostream writes them
+    std::vector<double> values = { 0.0, -0.0, 1.0, -1.0, 0.1, 1.0 / 3.0, 1e-300, -1e300,
+                                   std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+                                   std::numeric_limits<double>::min(), std::numeric_limits<double>::denorm_min() };
+    std::mt19937_64 rng(7);
+    while (values.size() < 20000) {
+        uint64_t bits = rng();
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        if (std::isfinite(v)) values.push_back(v);
+    }
+    std::vector<double> fixedValues = { 0.0, 0.5, 2.5, -1234.5678901, 1e-7, 123456789.123456789, 1e20 };
+    std::uniform_real_distribution<double> ms(0.0, 10000.0);
+    for (int i = 0; i < 2000; i++) fixedValues.push_back(ms(rng));
+    const std::vector<int64_t> integers = { 0, 1, -1, 1000000, std::numeric_limits<int64_t>::min(),
+                                            std::numeric_limits<int64_t>::max() };
+
+    auto writeNumbers = [&](const std::string& filename, bool compress, size_t bufferSize) {
+        CsvWriter out(filename, compress, bufferSize);
+        for (double v : values) { out.Number(v); out.Char('\n'); }
+        for (double v : fixedValues) { out.Fixed(v, 6); out.Char(','); out.Fixed(v, 1); out.Char('\n'); }
+        for (int64_t v : integers) { out.Integer(v); out.Char('\n'); }
+        out.Text(std::string(5000, 'x'));  // longer than a small buffer: written through
+        out.Char('\n');
+        return out.Close();
+    };
+    const std::string numbersFile = scratch.File("numbers.csv");
+    bool written = writeNumbers(numbersFile, false, size_t(1) << 20);
+    std::ostringstream expectedFixed;
+    expectedFixed << std::fixed;
+    for (double v : fixedValues) expectedFixed << std::setprecision(6) << v << ',' << std::setprecision(1) << v << '\n';
+    for (int64_t v : integers) expectedFixed << v << '\n';
+    expectedFixed << std::string(5000, 'x') << '\n';
+
+    const std::string numbers = TestSupport::ReadFile(numbersFile);
+    std::istringstream numberLines(numbers);
+    std::string line, rest;
+    bool roundTrip = written;
+    for (double v : values) {
+        roundTrip = roundTrip && std::getline(numberLines, line) && SameBits(std::strtod(line.c_str(), nullptr), v);
+    }
+    std::getline(numberLines, rest, '\0');
+    bool fixedSame = rest == expectedFixed.str();
+
+    // Block writes: a buffer smaller than one field's reserve is the same file
+    const std::string smallBufferFile = scratch.File("numbers_small_buffer.csv");
+    bool blocksSame = writeNumbers(smallBufferFile, false, 64) && TestSupport::ReadFile(smallBufferFile) == numbers;
+
+    // Compressed writer: gzip with zlib, otherwise it does not open (and writes nothing)
+    const std::string compressedFile = scratch.File("numbers.csv.gz");
+    bool compressedOk = writeNumbers(compressedFile, true, size_t(1) << 20);
+    const std::string compressed = TestSupport::ReadFile(compressedFile);
+#ifdef CSV_WRITER_ZLIB
+    compressedOk = compressedOk && compressed.size() > 2 && uint8_t(compressed[0]) == 0x1f && uint8_t(compressed[1]) == 0x8b;
+    const char* compressedMode = "gzip";
+#else
+    compressedOk = !compressedOk && compressed.empty();
+    const char* compressedMode = "refused without zlib";
+#endif
+
+    // Design results: one row per case with the header's column count
+    const std::string resultsFile = scratch.File("results.csv");
+    ReinforcementDesigner designer(geom, concrete, steel, 10, DesignSolver::Newton);
+    std::vector<DesignLoads> loads = { { -100e3, 60e3 }, { -800e3, 150e3 }, { -9000e3, 10e3 } };
+    std::vector<DesignResult> results = designer.DesignBatch(loads);
+    ReinforcementDesigner::ExportResultsToCSV(loads, results, resultsFile);
+    const auto resultRows = SplitCsv(TestSupport::ReadFile(resultsFile));
+    bool resultsOk = resultRows.size() == loads.size() + 1;
+    for (size_t r = 1; resultsOk && r < resultRows.size(); r++) {
+        const DesignResult& res = results[r - 1];
+        resultsOk = resultRows[r].size() == resultRows[0].size() && resultRows[r][0] == std::to_string(r) &&
+                    resultRows[r][3] == (res.converged ? "1" : "0") &&
+                    SameBits(std::strtod(resultRows[r][4].c_str(), nullptr), res.As2 * 10000.0) &&
+                    resultRows[r].back() == std::to_string(res.iterations);
+    }
+
+    std::cout << "Numbers: " << values.size() << " doubles round-trip: " << (roundTrip ? "yes" : "NO")
+              << ", fixed / integer fields as ostream: " << (fixedSame ? "yes" : "NO")
+              << ", 64-byte buffer identical: " << (blocksSame ? "yes" : "NO") << "\n";
+    std::cout << "Compressed writer (" << compressedMode << "): " << (compressedOk ? "ok" : "WRONG")
+              << ", design results rows: " << (resultsOk ? "ok" : "WRONG") << "\n\n";
+
+    checks.Expect(columnsSame && compactSame && maxDiff <= 1e-5, "Diagram export changed its columns or values");
+    checks.Expect(roundTrip, "Numbers do not read back to the same double");
+    checks.Expect(fixedSame, "Fixed or integer fields differ from ostream output");
+    checks.Expect(blocksSame, "Output depends on the buffer size");
+    checks.Expect(compressedOk, "Compressed writer output is wrong");
+    checks.Expect(resultsOk, "Design results export has wrong rows");
+    return checks.Finish("CSV writer keeps the columns and round-trips numbers");
+}
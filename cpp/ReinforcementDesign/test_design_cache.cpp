@@ -0,0 +1,127 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include "MaterialProperties.h"
+#include "ReinforcementDesigner.h"
+#include "TestSupport.h"
+
+// Design cache: results of the load's cell (or of the load itself where the cell's bounds do
+// not cover it), never below the design of the load, shared by threads and designers of one
+// section.
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+
+    TestSupport::PrintHeader("DESIGN CACHE (quantized N, M)");
+
+    ReinforcementDesigner designer(geom, concrete, steel, 10, DesignSolver::Newton);
+    auto designCache = std::make_shared<DesignCache>(100.0, 100.0, size_t(1) << 20);  // 0.1 kN, 0.1 kNm
+    ReinforcementDesigner cachedDesigner(geom, concrete, steel, 10, DesignSolver::Newton);
+    cachedDesigner.SetThreadCount(3);
+    cachedDesigner.SetCache(designCache);
+
+    // Queries repeating 2000 distinct load cases, each with noise within its cell (N in the
+    // 0.1 kN step above, |M| up to the next 0.1 kNm)
+    std::vector<DesignLoads> distinct(2000), queries(50000);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> distN(-300e3, 50e3), distM(0.0, 80e3);
+    for (auto& l : distinct) l = { std::round(distN(rng) / 100.0) * 100.0, std::round(distM(rng) / 100.0) * 100.0 };
+    std::uniform_int_distribution<size_t> pick(0, distinct.size() - 1);
+    std::uniform_real_distribution<double> noiseN(1.0, 99.0), noiseM(-99.0, 0.0);
+    for (auto& l : queries) {
+        const DesignLoads& d = distinct[pick(rng)];
+        l = { d.N + noiseN(rng), d.M > 0.0 ? d.M + noiseM(rng) : 0.0 };
+    }
+
+    std::vector<DesignResult> cached(queries.size());
+    cachedDesigner.DesignBatch(queries.data(), queries.size(), cached.data());
+    DesignCache::Stats cacheStats = designCache->GetStats();
+
+    // Every answer must be the uncached design of the cell, or of a pass cell's load, bit for bit
+    size_t mismatches = 0;
+    for (size_t i = 0; i < queries.size(); i++) {
+        DesignResult direct;
+        if (!designer.DesignCell(designCache->CellOf(queries[i]), direct)) direct = designer.Design(queries[i], false);
+        if (std::memcmp(&direct, &cached[i], sizeof(DesignResult)) != 0 &&
+            !(direct.converged == cached[i].converged && direct.As2 == cached[i].As2 &&
+              direct.iterations == cached[i].iterations && direct.M_calc == cached[i].M_calc)) {
+            mismatches++;
+        }
+    }
+
+    // Conservative over the whole diagram, also where As2 changes steeply with compression: on
+    // a coarse 20 kN / 2 kNm grid the cached As2 must cover the design of the load itself
+    // (rounding N to the nearest step fell short by cm^2 there), and whether a load can be
+    // designed must not change
+    auto coarseCache = std::make_shared<DesignCache>(20e3, 2e3, size_t(1) << 20);
+    cachedDesigner.SetCache(coarseCache);
+    std::vector<DesignLoads> sweep;
+    std::uniform_real_distribution<double> sweepN(-3200e3, 400e3), sweepM(-250e3, 250e3);
+    for (int i = 0; i < 20000; i++) sweep.push_back({ sweepN(rng), sweepM(rng) });
+    std::vector<DesignResult> sweepCached(sweep.size());
+    cachedDesigner.DesignBatch(sweep.data(), sweep.size(), sweepCached.data());
+    cachedDesigner.SetCache(designCache);
+    const DesignCache::Stats coarseStats = coarseCache->GetStats();
+    size_t belowLoad = 0, feasibilityChanged = 0;
+    double maxShortfall = 0.0, maxExcess = 0.0;
+    for (size_t i = 0; i < sweep.size(); i++) {
+        DesignResult exact = designer.Design(sweep[i], false);
+        if (exact.converged != sweepCached[i].converged) feasibilityChanged++;
+        if (!exact.converged || !sweepCached[i].converged) continue;
+        maxShortfall = std::max(maxShortfall, exact.As2 - sweepCached[i].As2);
+        maxExcess = std::max(maxExcess, sweepCached[i].As2 - exact.As2);
+        if (sweepCached[i].As2 < exact.As2) belowLoad++;
+    }
+    // Another designer of the same section shares the entries; another solver does not
+    ReinforcementDesigner sharingDesigner(geom, concrete, steel, 10, DesignSolver::Newton);
+    sharingDesigner.SetCache(designCache);
+    cachedDesigner.Design(distinct[0], false);
+    uint64_t hitsBefore = designCache->GetStats().hits;
+    sharingDesigner.Design(distinct[0], false);
+    bool shared = designCache->GetStats().hits == hitsBefore + 1 && sharingDesigner.SectionId() == cachedDesigner.SectionId();
+    sharingDesigner.SetSolver(DesignSolver::Interpolation);
+    DesignResult otherSolver = sharingDesigner.Design(distinct[0], false);
+    shared = shared && designCache->GetStats().hits == hitsBefore + 1 && otherSolver.iterations == 0;
+
+    // A tiny cache keeps evicting but stays correct and within its budget
+    auto tinyCache = std::make_shared<DesignCache>(100.0, 100.0, 4096);
+    cachedDesigner.SetCache(tinyCache);
+    std::vector<DesignResult> tinyResults(queries.size());
+    cachedDesigner.DesignBatch(queries.data(), queries.size(), tinyResults.data());
+    size_t tinyMismatches = 0;
+    for (size_t i = 0; i < queries.size(); i++) {
+        if (tinyResults[i].As2 != cached[i].As2 || tinyResults[i].converged != cached[i].converged) tinyMismatches++;
+    }
+    DesignCache::Stats tinyStats = tinyCache->GetStats();
+
+    std::cout << "Queries: " << queries.size() << " (" << distinct.size() << " distinct), hits: " << cacheStats.hits
+              << ", misses: " << cacheStats.misses << ", passes: " << cacheStats.passes << ", hit rate: " << std::fixed << std::setprecision(1)
+              << cacheStats.HitRate() * 100.0 << " %\n";
+    std::cout << "Answers equal to the uncached design of their cell: " << (mismatches == 0 ? "yes" : "NO") << "\n";
+    std::cout << "Coarse cache over " << sweep.size() << " loads (" << coarseStats.passes
+              << " designed exactly): As2 below the load's own " << belowLoad << " (max shortfall "
+              << std::setprecision(4) << maxShortfall * 1e4 << " cm^2), max excess " << maxExcess * 1e4
+              << " cm^2, designability changed " << feasibilityChanged << "\n" << std::setprecision(1);
+    std::cout << "Shared by designers of the same section: " << (shared ? "yes" : "NO") << "\n";
+    std::cout << "Cache of " << tinyCache->Capacity() << " entries (" << tinyCache->MemoryBytes() << " bytes): hit rate "
+              << tinyStats.HitRate() * 100.0 << " %, results " << (tinyMismatches == 0 ? "unchanged" : "DIFFER") << "\n\n";
+
+    checks.Expect(mismatches == 0, "Cached results differ from the design of their cell");
+    checks.Expect(belowLoad == 0, "Cached As2 is below the design of the load itself");
+    checks.Expect(feasibilityChanged == 0, "Cache changes whether a load can be designed");
+    checks.Expect(shared, "Cache entries are not shared by section, or leak across solvers");
+    checks.Expect(cacheStats.hits + cacheStats.misses + cacheStats.passes == queries.size() && cacheStats.HitRate() > 0.9,
+                  "Cache statistics do not add up or the hit rate is too low");
+    checks.Expect(tinyMismatches == 0 && tinyStats.hits + tinyStats.misses + tinyStats.passes == queries.size(),
+                  "Evicting cache changes the results");
+    checks.Expect(designCache->MemoryBytes() <= (size_t(1) << 20) + 4096 && tinyCache->MemoryBytes() <= 8192,
+                  "Cache exceeds its memory budget");
+    return checks.Finish("Design cache returns conservative designs of the load cells");
+}
@@ -0,0 +1,145 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "MaterialProperties.h"
+#include "ReinforcementDesigner.h"
+#include "LoadCaseFile.h"
+#include "DesignGrid.h"
+#include "TestSupport.h"
+
+// Precomputed As2 grid: bilinear lookups against Design, scalar vs. column vs. row lookups,
+// cells cut by a kink of As2 masked.
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+
+    TestSupport::PrintHeader("DESIGN GRID (precomputed As2, bilinear lookup)");
+
+    ReinforcementDesigner designer(geom, concrete, steel, 10, DesignSolver::Newton);
+    designer.SetThreadCount(2);
+
+    DesignGrid::Options options;
+    options.nMin = -300e3;
+    options.nMax = 50e3;
+    options.mMin = 0.0;
+    options.mMax = 80e3;
+    options.cellsN = 64;
+    options.cellsM = 64;
+
+    // The build bypasses the designer's cache and gives it back
+    auto designCache = std::make_shared<DesignCache>(100.0, 100.0, size_t(1) << 16);
+    designer.SetCache(designCache);
+    DesignGrid grid = DesignGrid::Build(designer, options);
+    DesignGrid::Stats stats = grid.GetStats();
+    const DesignCache::Stats cacheStats = designCache->GetStats();
+    bool cacheRestored = designer.GetCache() == designCache && cacheStats.hits + cacheStats.misses + cacheStats.passes == 0;
+    designer.SetCache(nullptr);
+
+    // Random loads over the domain and a margin around it
+    std::vector<double> gridN(100000), gridM(gridN.size()), gridAs2(gridN.size());
+    std::vector<uint8_t> gridValid(gridN.size());
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> distN(-320e3, 70e3), distM(-10e3, 90e3);
+    for (size_t i = 0; i < gridN.size(); i++) {
+        gridN[i] = distN(rng);
+        gridM[i] = distM(rng);
+    }
+    LoadCaseView view;
+    view.count = gridN.size();
+    view.N = gridN.data();
+    view.M = gridM.data();
+    size_t hits = grid.Lookup(view, gridAs2.data(), gridValid.data());
+
+    double maxGridErr = 0.0;
+    size_t scalarMismatches = 0, outside = 0, maskedFeasible = 0;
+    for (size_t i = 0; i < gridN.size(); i++) {
+        double scalarAs2;
+        bool scalarOk = grid.Lookup(gridN[i], gridM[i], scalarAs2);
+        if (scalarOk != (gridValid[i] != 0) || scalarAs2 != gridAs2[i]) scalarMismatches++;
+        bool inDomain = gridN[i] >= options.nMin && gridN[i] <= options.nMax &&
+                        gridM[i] >= options.mMin && gridM[i] <= options.mMax;
+        DesignResult direct = designer.Design({ gridN[i], gridM[i] }, false);
+        if (!gridValid[i]) {
+            if (inDomain && direct.converged) maskedFeasible++;
+            continue;
+        }
+        if (!inDomain || !direct.converged) {
+            outside++;
+            continue;
+        }
+        maxGridErr = std::max(maxGridErr, std::abs(gridAs2[i] - direct.As2));
+    }
+
+    // Coarse cells over the whole diagram, not refined and checked only at their centre and
+    // edge midpoints: a kink between those points (e.g. where As2 starts to be needed) passes
+    // the check and errs by hundreds of cm^2 in between. The regime check must mask such cells.
+    DesignGrid::Options coarseOptions;
+    DesignGrid::DefaultDomain(designer, coarseOptions);
+    coarseOptions.cellsN = 32;
+    coarseOptions.cellsM = 32;
+    coarseOptions.refine = 1;
+    coarseOptions.checkSteps = 2;
+    coarseOptions.tolerance = 1e-4;  // 1 cm^2: smooth cells pass, cells cut by a kink can err by far more
+    DesignGrid coarseGrid = DesignGrid::Build(designer, coarseOptions);
+    double maxCoarseErr = 0.0;
+    size_t coarseHits = 0;
+    std::uniform_real_distribution<double> inN(coarseOptions.nMin, coarseOptions.nMax),
+        inM(coarseOptions.mMin, coarseOptions.mMax);
+    for (int i = 0; i < 20000; i++) {
+        const DesignLoads l = { inN(rng), inM(rng) };
+        double As2;
+        DesignResult direct = designer.Design(l, false);
+        if (!coarseGrid.Lookup(l.N, l.M, As2) || !direct.converged) continue;
+        coarseHits++;
+        maxCoarseErr = std::max(maxCoarseErr, std::abs(As2 - direct.As2));
+    }
+    const DesignGrid::Stats coarseStats = coarseGrid.GetStats();
+
+    // Rows give the same answers as columns
+    std::vector<DesignLoads> rows(64);
+    for (size_t i = 0; i < rows.size(); i++) rows[i] = { gridN[i], gridM[i] };
+    LoadCaseView rowView;
+    rowView.count = rows.size();
+    rowView.rows = rows.data();
+    std::vector<double> rowAs2(rows.size());
+    std::vector<uint8_t> rowValid(rows.size());
+    grid.Lookup(rowView, rowAs2.data(), rowValid.data());
+    bool rowsOk = std::equal(rowAs2.begin(), rowAs2.end(), gridAs2.begin()) &&
+                  std::equal(rowValid.begin(), rowValid.end(), gridValid.begin());
+
+    std::cout << "Cells: " << stats.cells << " (" << stats.refinedCells << " refined), valid "
+              << stats.validCells << " of " << stats.leafCells << ", " << stats.designs
+              << " designs in " << std::fixed << std::setprecision(3) << stats.seconds << " s, "
+              << stats.memoryBytes / 1024 << " KB\n";
+    std::cout << "Lookups: " << gridN.size() << ", from the grid: " << hits << ", feasible but masked: "
+              << maskedFeasible << "\n";
+    std::cout << "Max |grid - Design|: " << std::setprecision(4) << maxGridErr * 1e4 << " cm^2 (tolerance "
+              << grid.Tolerance() * 1e4 << " cm^2), valid outside the feasible region: " << outside << "\n";
+    std::cout << "Coarse grid " << coarseOptions.cellsN << " x " << coarseOptions.cellsM << ": " << coarseStats.kinkCells
+              << " cells masked at kinks, valid " << coarseStats.validCells << ", max |grid - Design| "
+              << maxCoarseErr * 1e4 << " cm^2 over " << coarseHits << " lookups (tolerance "
+              << coarseGrid.Tolerance() * 1e4 << " cm^2)\n";
+    std::cout << "Scalar, column and row lookups agree: " << (scalarMismatches == 0 && rowsOk ? "yes" : "NO")
+              << ", cache bypassed and restored: " << (cacheRestored ? "yes" : "NO") << "\n\n";
+
+    // Random loads of this section: the check lattice and the regimes catch its kinks (the
+    // tolerance is not guaranteed between the check points, see DesignGrid)
+    checks.Expect(maxGridErr <= grid.Tolerance(), "Grid lookups exceed the tolerance");
+    checks.Expect(coarseStats.kinkCells > 0 && coarseHits > 0 && maxCoarseErr <= coarseGrid.Tolerance(),
+                  "Cells cut by a kink of As2 are not masked");
+    checks.Expect(scalarMismatches == 0 && rowsOk, "Scalar, column and row lookups disagree");
+    checks.Expect(outside == 0, "Grid answers loads outside the feasible region");
+    checks.Expect(stats.maxCheckError <= 0.5 * grid.Tolerance(), "Grid refinement stopped above half the tolerance");
+    checks.Expect(cacheRestored, "Grid build uses or loses the designer's cache");
+    checks.Expect(maskedFeasible < gridN.size() / 100 && hits > gridN.size() / 2,
+                  "Too many designable loads fall in masked grid cells");
+    return checks.Finish("Grid lookups stay within the tolerance of Design");
+}
@@ -0,0 +1,232 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "MaterialProperties.h"
+#include "ReinforcementDesigner.h"
+#include "LoadCaseStream.h"
+#include "LoadCaseFile.h"
+#include "DesignPipeline.h"
+#include "CsvWriter.h"
+#include "TestSupport.h"
+
+// Streaming batch pipeline and mapped load-case files: the results CSV must be byte for byte
+// that of DesignBatch + ExportResultsToCSV, for binary, CSV, mapped and column input.
+
+// Designer whose DesignBatch fails on the given block: the pipeline must stop its stages and
+// pass the exception on instead of terminating on unjoined threads
+class ThrowingDesigner : public ReinforcementDesigner {
+private:
+    int blocksLeft;
+
+    void Count() {
+        if (--blocksLeft < 0) throw std::runtime_error("design failed");
+    }
+
+public:
+    ThrowingDesigner(const SectionGeometry& geom, const ConcreteProperties& concrete, const SteelProperties& steel,
+                     int failingBlock)
+        : ReinforcementDesigner(geom, concrete, steel, 10, DesignSolver::Newton), blocksLeft(failingBlock) {}
+
+    void DesignBatch(const DesignLoads* loads, size_t count, DesignResult* results) {
+        Count();
+        ReinforcementDesigner::DesignBatch(loads, count, results);
+    }
+    void DesignBatch(const double* N, const double* M, size_t count, DesignResult* results) {
+        Count();
+        ReinforcementDesigner::DesignBatch(N, M, count, results);
+    }
+};
+
+int main() {
+    TestSupport::Checks checks;
+    TestSupport::ScratchDirectory scratch("test_design_pipeline");
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+
+    TestSupport::PrintHeader("STREAMING BATCH PIPELINE (read / design / write)");
+
+    ReinforcementDesigner designer(geom, concrete, steel, 10, DesignSolver::Newton);
+    designer.SetThreadCount(2);
+
+    std::vector<DesignLoads> loads(10007);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> distN(-300e3, 50e3), distM(0.0, 80e3);
+    for (auto& l : loads) l = { distN(rng), distM(rng) };
+
+    const std::string binFile = scratch.File("loads.bin");
+    const std::string csvFile = scratch.File("loads.csv");
+    const std::string colsFile = scratch.File("columns.bin");
+    const std::string outFile = scratch.File("results.csv");
+    const std::string refFile = scratch.File("reference.csv");
+
+    // Binary input: loads arrive bit-exact
+    bool filesOk = LoadCaseWriter::WriteFile(binFile, loads.data(), loads.size());
+    std::vector<DesignResult> results = designer.DesignBatch(loads);
+    ReinforcementDesigner::ExportResultsToCSV(loads, results, refFile);
+
+    DesignPipeline::Options options;
+    options.blockSize = 1000;  // 11 blocks through 2 slots: every stage waits on the others
+    options.blocks = 2;
+    LoadCaseReader binReader;
+    DesignPipeline::Stats binStats;
+    if (binReader.Open(binFile)) {
+        binStats = DesignPipeline::Run(designer, binReader, outFile, options);
+    }
+    bool binSame = binStats.ok && binReader.IsBinary() && binStats.cases == loads.size() &&
+                   binStats.blocks == 11 && TestSupport::ReadFile(outFile) == TestSupport::ReadFile(refFile);
+    std::cout << "Binary input: " << binStats.cases << " cases in " << binStats.blocks << " blocks, "
+              << binStats.converged << " converged, output identical to DesignBatch: " << (binSame ? "yes" : "NO") << "\n";
+
+    // CSV input (kN, kNm, with header, comment, CRLF and a Case column): compared with
+    // DesignBatch on the loads as parsed
+    {
+        CsvWriter csv(csvFile);
+        csv.Text("Case;N[kN];M[kNm]\r\n# exported by test\r\n\r\n");
+        for (size_t i = 0; i < loads.size(); i++) {
+            csv.Integer(int64_t(i + 1));
+            csv.Text("; ");
+            csv.Number(loads[i].N / 1000.0);
+            csv.Char(';');
+            csv.Number(loads[i].M / 1000.0);
+            csv.Text("\r\n");
+        }
+        filesOk = csv.Close() && filesOk;
+    }
+    std::vector<DesignLoads> csvLoads(loads.size() + 1);
+    size_t csvCount = 0;
+    {
+        LoadCaseReader r;
+        filesOk = r.Open(csvFile) && filesOk;
+        csvCount = r.Read(csvLoads.data(), csvLoads.size());
+        filesOk = !r.Failed() && filesOk;
+    }
+    csvLoads.resize(csvCount);
+    double csvMaxDiff = 0.0;
+    for (size_t i = 0; i < std::min(csvCount, loads.size()); i++) {
+        csvMaxDiff = std::max({ csvMaxDiff, std::abs(csvLoads[i].N - loads[i].N), std::abs(csvLoads[i].M - loads[i].M) });
+    }
+    ReinforcementDesigner::ExportResultsToCSV(csvLoads, designer.DesignBatch(csvLoads), refFile);
+    LoadCaseReader csvReader;
+    DesignPipeline::Stats csvStats;
+    if (csvReader.Open(csvFile)) {
+        csvStats = DesignPipeline::Run(designer, csvReader, outFile, options);
+    }
+    bool csvSame = csvStats.ok && !csvReader.IsBinary() && csvCount == loads.size() && csvMaxDiff < 1e-6 &&
+                   TestSupport::ReadFile(outFile) == TestSupport::ReadFile(refFile);
+    std::cout << "CSV input: " << csvStats.cases << " cases, loads within " << std::scientific << csvMaxDiff
+              << std::fixed << " N of the originals, output identical to DesignBatch: " << (csvSame ? "yes" : "NO") << "\n";
+
+    // Mapped input: binary rows and columns in place, CSV parsed in parallel chunks; the
+    // pipeline over the mapping must match the streamed results
+    {
+        std::vector<double> colN(loads.size()), colM(loads.size());
+        for (size_t i = 0; i < loads.size(); i++) {
+            colN[i] = loads[i].N;
+            colM[i] = loads[i].M;
+        }
+        filesOk = LoadCaseWriter::WriteColumns(colsFile, colN.data(), colM.data(), colN.size()) && filesOk;
+    }
+    bool mapOk = true;
+    {
+        auto mappedRows = LoadCaseFile::Open(binFile);
+        auto mappedCols = LoadCaseFile::Open(colsFile);
+        auto parsedRows = LoadCaseFile::Open(csvFile, LoadCaseFormat::Rows, 3, 4096);  // ~60 chunks
+        auto parsedCols = LoadCaseFile::Open(csvFile, LoadCaseFormat::Columns, 3, 4096);
+        mapOk = mappedRows->Ok() && mappedCols->Ok() && parsedRows->Ok() && parsedCols->Ok() &&
+                mappedRows->IsBinary() && !mappedRows->View().IsColumns() && mappedCols->View().IsColumns() &&
+                !parsedRows->View().IsColumns() && parsedCols->View().IsColumns();
+        for (auto* f : { &mappedRows, &mappedCols, &parsedRows, &parsedCols }) {
+            const LoadCaseView& v = (*f)->View();
+            const std::vector<DesignLoads>& expected = (*f)->IsBinary() ? loads : csvLoads;
+            mapOk = mapOk && v.count == expected.size();
+            for (size_t i = 0; mapOk && i < v.count; i++) {
+                mapOk = v[i].N == expected[i].N && v[i].M == expected[i].M;
+            }
+        }
+        std::vector<DesignResult> colResults(loads.size());
+        designer.DesignBatch(mappedCols->View().N, mappedCols->View().M, colResults.size(), colResults.data());
+        for (size_t i = 0; mapOk && i < colResults.size(); i++) {
+            mapOk = colResults[i].converged == results[i].converged && colResults[i].As2 == results[i].As2;
+        }
+        ReinforcementDesigner::ExportResultsToCSV(loads, results, refFile);
+        for (auto* f : { &mappedRows, &mappedCols }) {
+            DesignPipeline::Stats mapStats = DesignPipeline::Run(designer, (*f)->View(), outFile, options);
+            mapOk = mapOk && mapStats.ok && mapStats.cases == loads.size() &&
+                    TestSupport::ReadFile(outFile) == TestSupport::ReadFile(refFile);
+        }
+    }
+    std::cout << "Mapped input (binary rows, binary columns, CSV parsed in parallel): "
+              << (mapOk ? "identical loads and results" : "MISMATCH") << "\n";
+
+    // Malformed lines: reported with their line number, streamed and mapped, pipeline fails.
+    // nan / inf fields and a numeric first line are malformed too, not data or a header.
+    bool badReported = true;
+    std::string badExample;
+    for (const char* badLine : { "30,x\n", "30,nan\n", "inf,30\n", "7,-INF,30\n" }) {
+        {
+            std::ofstream bad(csvFile);
+            bad << "N,M\n";
+            for (int i = 0; i < 1000; i++) bad << i << "," << 2 * i << "\n";
+            bad << badLine;
+        }
+        LoadCaseReader badReader;
+        DesignPipeline::Stats badStats;
+        if (badReader.Open(csvFile)) {
+            badStats = DesignPipeline::Run(designer, badReader, outFile, options);
+        }
+        auto badMapped = LoadCaseFile::Open(csvFile, LoadCaseFormat::Rows, 2, 512);
+        badReported = badReported && !badStats.ok && badStats.error.rfind("line 1002:", 0) == 0 &&
+                      !badMapped->Ok() && badMapped->Error() == badStats.error;
+        if (badExample.empty()) badExample = badStats.error;
+    }
+    for (const char* firstLine : { "1.5,x\n", "nan,inf\n", "N,2\n", "Case,N,M,Extra\n", "-N,M\n" }) {
+        {
+            std::ofstream bad(csvFile);
+            bad << firstLine << "1,2\n";
+        }
+        LoadCaseReader badReader;
+        std::vector<DesignLoads> read(4);
+        bool streamedFails = badReader.Open(csvFile) && badReader.Read(read.data(), read.size()) == 0 &&
+                             badReader.Failed() && badReader.Error().rfind("line 1:", 0) == 0;
+        auto badMapped = LoadCaseFile::Open(csvFile);
+        badReported = badReported && streamedFails && !badMapped->Ok() && badMapped->Error() == badReader.Error();
+    }
+    std::cout << "Malformed input: " << (badReported ? badExample : "NOT REPORTED") << "\n";
+
+    // DesignBatch throws on the third block, streamed and mapped: the exception reaches the
+    // caller (a stage left unjoined would call std::terminate)
+    bool throwPropagated = true;
+    for (bool mapped : { false, true }) {
+        ThrowingDesigner failing(geom, concrete, steel, 2);
+        bool caught = false;
+        try {
+            if (mapped) {
+                auto mappedRows = LoadCaseFile::Open(binFile);
+                DesignPipeline::Run(failing, mappedRows->View(), outFile, options);
+            } else {
+                LoadCaseReader reader;
+                if (reader.Open(binFile)) DesignPipeline::Run(failing, reader, outFile, options);
+            }
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+        throwPropagated = throwPropagated && caught;
+    }
+    std::cout << "DesignBatch throwing mid-run: " << (throwPropagated ? "stages joined, exception passed on" : "NOT PASSED ON")
+              << "\n\n";
+
+    checks.Expect(filesOk, "Writing or reading the load-case test files failed");
+    checks.Expect(binSame, "Pipeline over binary input differs from DesignBatch");
+    checks.Expect(csvSame, "Pipeline over CSV input differs from DesignBatch");
+    checks.Expect(mapOk, "Mapped load-case files differ from the streamed input");
+    checks.Expect(badReported, "Malformed CSV line (or nan / inf, or a numeric header) is not reported with its line number");
+    checks.Expect(throwPropagated, "Exception from DesignBatch does not reach the caller");
+    return checks.Finish("Streaming and mapped pipelines match DesignBatch");
+}
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "MaterialProperties.h"
+#include "ReinforcementDesigner.h"
+#include "TestSupport.h"
+
+// Design solvers over an (N, M) grid: Newton converges within NEWTON_MAX_ITERATIONS to
+// equilibrium, and diagram interpolation agrees with it within its discretization error.
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+
+    TestSupport::PrintHeader("DESIGN SOLVERS (Newton vs. interpolation)");
+
+    ReinforcementDesigner newton(geom, concrete, steel, 10, DesignSolver::Newton);
+    ReinforcementDesigner coarse(geom, concrete, steel, 10, DesignSolver::Interpolation);
+    ReinforcementDesigner fine(geom, concrete, steel, 40, DesignSolver::Interpolation);
+
+    // Interpolation between diagram points of density 10: within 5 % of As2 plus 0.1 cm^2 (the
+    // absolute part covers loads just outside the diagram, where As2 is small)
+    const double relTol = 0.05, absTol = 0.1e-4;
+    const double momentTol = ReinforcementDesigner::NEWTON_TOLERANCE * std::abs(concrete.fcd) * geom.b * geom.h * geom.h;
+    const double scaleN = std::abs(concrete.fcd * geom.b * geom.h);
+
+    size_t cases = 0, converged = 0, feasibilityMismatches = 0, newtonOff = 0, outsideTol = 0;
+    int maxIterations = 0;
+    double maxCoarse = 0.0, maxFine = 0.0, maxMomentErr = 0.0;
+    const int steps = 60;
+    for (int i = 0; i <= steps; i++) {
+        for (int j = 0; j <= steps; j++) {
+            const DesignLoads loads = { -1500e3 + 1600e3 * i / steps, 250e3 * j / steps };
+            DesignResult n = newton.Design(loads, false);
+            DesignResult c = coarse.Design(loads, false);
+            DesignResult f = fine.Design(loads, false);
+            cases++;
+            if (n.converged != c.converged || n.converged != f.converged) {
+                feasibilityMismatches++;
+                continue;
+            }
+            if (!n.converged) continue;
+            converged++;
+
+            maxIterations = std::max(maxIterations, n.iterations);
+            if (n.iterations < 1 || n.iterations > ReinforcementDesigner::NEWTON_MAX_ITERATIONS) newtonOff++;
+
+            // Equilibrium where reinforcement is needed (As2 = 0: the load lies inside the diagram)
+            if (n.As2 > 0.0) {
+                maxMomentErr = std::max(maxMomentErr, n.errorAbs);
+                if (n.errorAbs > momentTol * (1.0 + 1e-9) || std::abs(n.N_calc - loads.N) > 1e-9 * scaleN) newtonOff++;
+            }
+
+            double dCoarse = std::abs(c.As2 - n.As2), dFine = std::abs(f.As2 - n.As2);
+            maxCoarse = std::max(maxCoarse, dCoarse);
+            maxFine = std::max(maxFine, dFine);
+            if (dCoarse > relTol * n.As2 + absTol) outsideTol++;
+        }
+    }
+
+    // Non-finite loads have no equilibrium: Newton must report failure, not a collapsed bracket
+    const double nan = std::numeric_limits<double>::quiet_NaN(), inf = std::numeric_limits<double>::infinity();
+    size_t nonFiniteConverged = 0;
+    for (const DesignLoads& loads : std::vector<DesignLoads>{ { nan, 100e3 }, { -500e3, nan }, { nan, nan },
+                                                              { inf, 100e3 }, { -500e3, inf }, { -inf, -inf } }) {
+        DesignResult n = newton.Design(loads, false);
+        if (n.converged) nonFiniteConverged++;
+    }
+
+    std::cout << "Grid cases: " << cases << ", converged: " << converged
+              << ", feasibility differs between solvers: " << feasibilityMismatches << "\n";
+    std::cout << "Newton: max " << maxIterations << " iterations (limit " << ReinforcementDesigner::NEWTON_MAX_ITERATIONS
+              << "), max moment error " << std::scientific << std::setprecision(3) << maxMomentErr
+              << " Nm (tolerance " << momentTol << " Nm)\n";
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Max |As2 interpolation - Newton|: density 10 " << maxCoarse * 1e4 << " cm^2, density 40 "
+              << maxFine * 1e4 << " cm^2, outside tolerance: " << outsideTol << "\n";
+    std::cout << "Newton designs of NaN / inf loads reported as converged: " << nonFiniteConverged << "\n\n";
+
+    checks.Expect(converged > cases / 2, "Too few grid cases converge");
+    checks.Expect(feasibilityMismatches == 0, "Solvers disagree on which loads can be designed");
+    checks.Expect(newtonOff == 0 && maxIterations < ReinforcementDesigner::NEWTON_MAX_ITERATIONS,
+                  "Newton does not reach equilibrium within NEWTON_MAX_ITERATIONS");
+    checks.Expect(outsideTol == 0, "Interpolation differs from Newton by more than 5 % of As2 + 0.1 cm^2");
+    checks.Expect(nonFiniteConverged == 0, "Newton reports a NaN or inf load as converged");
+    checks.Expect(maxFine < 0.5 * maxCoarse, "Interpolation does not approach Newton as the diagram gets denser");
+    return checks.Finish("Newton and interpolation agree over the load grid");
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include "MaterialProperties.h"
+#include "MaterialLaws.h"
+#include "InteractionDiagram.h"
+#include "TestSupport.h"
+
+// Diagram basis: diagrams materialized for any reinforcement are the generated diagrams bit
+// for bit, without integrating the concrete again.
+
+static bool SamePoint(const DiagramPoint& a, const DiagramPoint& b) {
+    return a.name == b.name && a.epsTop == b.epsTop && a.epsBot == b.epsBot && a.epsS1 == b.epsS1 &&
+           a.epsS2 == b.epsS2 && a.sigS1 == b.sigS1 && a.sigS2 == b.sigS2 && a.N == b.N && a.M == b.M &&
+           a.Fc == b.Fc && a.Mc == b.Mc && a.Fs1 == b.Fs1 && a.Fs2 == b.Fs2 && a.As1 == b.As1 && a.As2 == b.As2;
+}
+
+// Materialize vs. Generate for every pair; returns the number of differing points and the
+// largest MaterializeNM deviation relative to fcd*b*h (and *h)
+template <class Diagram>
+static std::pair<size_t, double> CompareBasis(const SectionGeometry& geom, const ConcreteProperties& concrete,
+                                              const SteelProperties& steel, int density,
+                                              const std::vector<std::pair<double, double>>& areas) {
+    const double scaleN = std::abs(concrete.fcd * geom.b * geom.h) / 1000.0;
+    DiagramBasis basis = Diagram(geom, concrete, steel).GenerateBasis(density);
+    size_t differ = 0;
+    double maxNM = 0.0;
+    std::vector<double> N(basis.Size()), M(basis.Size());
+    for (const auto& [as1, as2] : areas) {
+        std::vector<DiagramPoint> generated = Diagram(geom, concrete, steel, as1, as2).Generate(density);
+        std::vector<DiagramPoint> materialized = basis.Materialize(as1, as2);
+        if (generated.size() != materialized.size()) return { generated.size() + 1, 0.0 };
+        basis.MaterializeNM(as1, as2, N.data(), M.data());
+        for (size_t i = 0; i < generated.size(); i++) {
+            if (!SamePoint(generated[i], materialized[i])) differ++;
+            maxNM = std::max({ maxNM, std::abs(N[i] - generated[i].N) / scaleN,
+                               std::abs(M[i] - generated[i].M) / (scaleN * geom.h) });
+        }
+    }
+    return { differ, maxNM };
+}
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+    const double cm2 = 1.0 / 10000.0;
+
+    TestSupport::PrintHeader("DIAGRAM BASIS (materialized reinforcement)");
+
+    // No steel, one side only, symmetric, asymmetric and heavily reinforced
+    const std::vector<std::pair<double, double>> areas = {
+        { 0.0, 0.0 }, { 0.0, 10.0 * cm2 }, { 6.0 * cm2, 0.0 }, { 10.0 * cm2, 10.0 * cm2 },
+        { 3.14 * cm2, 25.13 * cm2 }, { 60.0 * cm2, 120.0 * cm2 },
+    };
+
+    size_t differ = 0;
+    double maxNM = 0.0;
+    for (int density : { 1, 4, 10 }) {
+        auto [d, nm] = CompareBasis<InteractionDiagram>(geom, concrete, steel, density, areas);
+        auto [dLaws, nmLaws] = CompareBasis<InteractionDiagramT<MaterialLaws::ParabolaRectangleN, MaterialLaws::HardeningSteel>>(
+            geom, concrete, steel, density, areas);
+        differ += d + dLaws;
+        maxNM = std::max({ maxNM, nm, nmLaws });
+    }
+
+    // The basis itself is the concrete-only diagram
+    DiagramBasis basis = InteractionDiagram(geom, concrete, steel, 5.0 * cm2, 5.0 * cm2).GenerateBasis(10);
+    std::vector<DiagramPoint> concreteOnly = InteractionDiagram(geom, concrete, steel).Generate(10);
+    bool basisConcreteOnly = basis.ConcreteOnly().size() == concreteOnly.size();
+    for (size_t i = 0; basisConcreteOnly && i < concreteOnly.size(); i++) {
+        basisConcreteOnly = SamePoint(basis.ConcreteOnly()[i], concreteOnly[i]);
+    }
+
+    std::cout << "Materialize vs. Generate (" << areas.size() << " reinforcement pairs, 3 densities, 2 law sets): "
+              << differ << " differing points\n";
+    std::cout << "MaterializeNM vs. Generate: " << std::scientific << std::setprecision(3) << maxNM
+              << " (relative to fcd*b*h)\n";
+    std::cout << "Basis ignores the designer's reinforcement: " << (basisConcreteOnly ? "yes" : "NO") << "\n\n";
+
+    checks.Expect(differ == 0, "Materialized diagram differs from the generated one");
+    checks.Expect(maxNM <= 1e-12, "MaterializeNM differs from the generated N, M");
+    checks.Expect(basisConcreteOnly, "Basis is not the concrete-only diagram");
+    return checks.Finish("Diagram basis materializes the generated diagrams");
+}
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "MaterialProperties.h"
+#include "MaterialLaws.h"
+#include "InteractionDiagram.h"
+#include "DiagramFile.h"
+#include "DiagramCache.h"
+#include "TestSupport.h"
+
+// Diagram cache: LRU of the memory tier, the disk tier round trip, and disk entries the cache
+// must regenerate (corrupted, of another file version or other laws, stored under another key).
+
+// Disk entry of a key: "<key as 16 hex digits>.diag"
+static std::string EntryName(uint64_t key) {
+    std::ostringstream name;
+    name << std::hex;
+    name.width(16);
+    name.fill('0');
+    name << key;
+    return name.str() + ".diag";
+}
+
+static bool SameDiagram(const DiagramView& a, const DiagramView& b) {
+    if (a.Size() == 0 || a.Size() != b.Size()) return false;
+    for (size_t i = 0; i < a.Size(); i++) {
+        if (a.N[i] != b.N[i] || a.M[i] != b.M[i] || a.epsTop[i] != b.epsTop[i] || a.kind[i] != b.kind[i]) return false;
+    }
+    return true;
+}
+
+int main() {
+    TestSupport::Checks checks;
+    TestSupport::ScratchDirectory scratch("test_diagram_cache");
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+    const double as = 10.0 / 10000.0;
+
+    TestSupport::PrintHeader("DIAGRAM CACHE (memory LRU, disk tier)");
+
+    // Memory tier of two entries: A, B miss; A hits; C evicts B (least recently used), not A
+    DiagramCache memory(2);
+    auto get = [&](DiagramCache& cache, double as2) { return cache.Get(geom, concrete, steel, 0.0, as2, 4); };
+    SharedDiagram a = get(memory, 1.0 * as);
+    get(memory, 2.0 * as);
+    SharedDiagram aAgain = get(memory, 1.0 * as);
+    get(memory, 3.0 * as);
+    DiagramCache::Stats afterC = memory.GetStats();
+    SharedDiagram aKept = get(memory, 1.0 * as);
+    DiagramCache::Stats afterA = memory.GetStats();
+    get(memory, 2.0 * as);
+    DiagramCache::Stats afterB = memory.GetStats();
+    bool lruOk = afterC.misses == 3 && afterC.memoryHits == 1 &&
+                 afterA.misses == 3 && afterA.memoryHits == 2 &&  // A survived C
+                 afterB.misses == 4 && afterB.memoryHits == 2 &&  // B was evicted
+                 aAgain.view.N == a.view.N && aKept.view.N == a.view.N && memory.Size() == 2 && afterB.diskHits == 0;
+    std::cout << "LRU hits / misses: " << afterB.memoryHits << " / " << afterB.misses
+              << ", least recently used evicted: " << (lruOk ? "yes" : "NO") << "\n";
+
+    // Disk tier: a second cache (another process) maps the file written by the first
+    const std::string directory = scratch.File("diagrams");
+    const uint64_t key = DiagramCache::Key(geom, concrete, steel, 0.0, as, 10);
+    const std::string entry = directory + "/" + EntryName(key);
+    CompactDiagram reference = InteractionDiagram(geom, concrete, steel, 0.0, as).GenerateCompact(10);
+    bool diskOk;
+    {
+        DiagramCache writer(4, directory);
+        SharedDiagram generated = writer.Get(geom, concrete, steel, 0.0, as);
+        DiagramCache reader(4, directory);
+        SharedDiagram mapped = reader.Get(geom, concrete, steel, 0.0, as);
+        diskOk = writer.GetStats().misses == 1 && reader.GetStats().diskHits == 1 && reader.GetStats().misses == 0 &&
+                 SameDiagram(generated.view, reference.View()) && SameDiagram(mapped.view, reference.View());
+    }
+    std::cout << "Disk round trip: " << (diskOk ? "identical" : "DIFFERENT") << "\n";
+
+    // Disk entries that must not be used: each is regenerated (a miss), gives the right
+    // diagram, and is replaced by a good file the next cache maps
+    const std::string good = TestSupport::ReadFile(entry);
+    auto regenerates = [&](const std::string& bytes) {
+        std::ofstream(entry, std::ios::binary | std::ios::trunc).write(bytes.data(), (std::streamsize)bytes.size());
+        DiagramCache cache(4, directory);
+        SharedDiagram d = cache.Get(geom, concrete, steel, 0.0, as);
+        DiagramCache next(4, directory);
+        SharedDiagram again = next.Get(geom, concrete, steel, 0.0, as);
+        return cache.GetStats().misses == 1 && cache.GetStats().diskHits == 0 && SameDiagram(d.view, reference.View()) &&
+               next.GetStats().diskHits == 1 && SameDiagram(again.view, reference.View());
+    };
+
+    std::string corrupted = good;
+    corrupted[corrupted.size() / 2] ^= 0x5a;
+    bool corruptedOk = regenerates(corrupted) && regenerates(good.substr(0, good.size() / 2));
+
+    std::string oldVersion = good;
+    const uint32_t version = DiagramFile::VERSION - 1;
+    std::memcpy(&oldVersion[8], &version, sizeof(version));
+    bool staleOk = regenerates(oldVersion);
+
+    // Same section and key, written with other laws (a key that ignored the laws)
+    const std::string otherLawsFile = scratch.File("other_laws.diag");
+    CompactDiagram otherLaws = InteractionDiagramT<MaterialLaws::ParabolaRectangleN, MaterialLaws::HardeningSteel>(
+        geom, concrete, steel, 0.0, as).GenerateCompact(10);
+    DiagramFile::Write<MaterialLaws::ParabolaRectangleN, MaterialLaws::HardeningSteel>(
+        otherLawsFile, otherLaws.View(), geom, concrete, steel, key);
+    staleOk = staleOk && regenerates(TestSupport::ReadFile(otherLawsFile));
+
+    // A valid file stored under the name of another key (hash-named collision)
+    const std::string otherKeyFile = scratch.File("other_key.diag");
+    DiagramFile::Write(otherKeyFile, reference.View(), geom, concrete, steel, key ^ 1);
+    bool keyOk = regenerates(TestSupport::ReadFile(otherKeyFile));
+
+    std::cout << "Corrupted and truncated entries regenerated: " << (corruptedOk ? "yes" : "NO") << "\n";
+    std::cout << "Entries of an older file version or other laws regenerated: " << (staleOk ? "yes" : "NO") << "\n";
+    std::cout << "Entry with another stored key regenerated: " << (keyOk ? "yes" : "NO") << "\n\n";
+
+    checks.Expect(lruOk, "Memory tier does not hit or evict in LRU order");
+    checks.Expect(diskOk, "Disk tier does not round-trip the diagram");
+    checks.Expect(corruptedOk, "Corrupted disk entry is used");
+    checks.Expect(staleOk, "Stale disk entry (file version or material laws) is used");
+    checks.Expect(keyOk, "Disk entry with another stored key is used");
+    return checks.Finish("Diagram cache hits, evicts and regenerates as expected");
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "MaterialProperties.h"
+#include "MaterialLaws.h"
+#include "InteractionDiagram.h"
+#include "DiagramFile.h"
+#include "ReinforcementDesigner.h"
+#include "TestSupport.h"
+
+// Binary diagram file: round trip of the columns and header, and files the reader must reject.
+
+int main() {
+    TestSupport::Checks checks;
+    TestSupport::ScratchDirectory scratch("test_diagram_file");
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+
+    TestSupport::PrintHeader("DIAGRAM FILE (mapped, columnar)");
+
+    using ParabolaN = MaterialLaws::ParabolaRectangleN;
+    using Hardening = MaterialLaws::HardeningSteel;
+
+    // Default laws: every column comes back bit for bit, the header carries the law Ids
+    const std::string defaultFile = scratch.File("default.diag");
+    CompactDiagram diagram = InteractionDiagram(geom, concrete, steel).GenerateCompact(10);
+    bool written = DiagramFile::Write(defaultFile, diagram.View(), geom, concrete, steel, 42);
+    auto file = DiagramFile::Open(defaultFile, true);
+    bool roundTrip = written && file && file->View().Size() == diagram.Size() && file->Key() == 42 &&
+                     file->ConcreteLawId() == MaterialLaws::ParabolaRectangle::Id &&
+                     file->SteelLawId() == MaterialLaws::BilinearSteel::Id &&
+                     file->Geometry().h == geom.h && file->Steel().fyd == steel.fyd;
+    for (size_t i = 0; roundTrip && i < diagram.Size(); i++) {
+        const DiagramView& v = file->View();
+        roundTrip = v.N[i] == diagram.N[i] && v.M[i] == diagram.M[i] && v.epsTop[i] == diagram.epsTop[i] &&
+                    v.sigS2[i] == diagram.sigS2[i] && v.t[i] == diagram.t[i] && v.kind[i] == diagram.kind[i] &&
+                    v.segment[i] == diagram.segment[i] && v.index[i] == diagram.index[i] &&
+                    v.Name(i) == diagram.Name(i);
+    }
+    std::cout << "Round trip of " << diagram.Size() << " points: " << (roundTrip ? "identical" : "DIFFERENT") << "\n";
+
+    // Law Ids: a designer only accepts a file of its own laws
+    const std::string lawFile = scratch.File("laws.diag");
+    CompactDiagram lawDiagram = InteractionDiagramT<ParabolaN, Hardening>(geom, concrete, steel).GenerateCompact(10);
+    written = DiagramFile::Write<ParabolaN, Hardening>(lawFile, lawDiagram.View(), geom, concrete, steel);
+    auto lawMapped = DiagramFile::Open(lawFile, true);
+    bool lawsOk = written && lawMapped && lawMapped->ConcreteLawId() == ParabolaN::Id && lawMapped->SteelLawId() == Hardening::Id;
+    if (lawsOk) {
+        const DesignLoads loads = { -100e3, 60e3 };
+        std::cout << "Designer of other laws (an error is expected):\n";
+        ReinforcementDesigner wrongLaws(lawMapped, DesignSolver::Newton);
+        ReinforcementDesignerT<ParabolaN, Hardening> sameLaws(lawMapped, DesignSolver::Newton);
+        ReinforcementDesignerT<ParabolaN, Hardening> generated(geom, concrete, steel, 10, DesignSolver::Newton);
+        DesignResult fromFile = sameLaws.Design(loads, false);
+        DesignResult direct = generated.Design(loads, false);
+        lawsOk = wrongLaws.GetDiagram().Size() == 0 && !wrongLaws.Design(loads, false).converged &&
+                 sameLaws.GetDiagram().Size() == lawDiagram.Size() && fromFile.converged && fromFile.As2 == direct.As2;
+    }
+    std::cout << "Law Ids stored and checked: " << (lawsOk ? "yes" : "NO") << "\n";
+
+    // A file of the previous version (no law Ids) is not opened
+    bool oldVersionRejected = false;
+    {
+        std::string bytes = TestSupport::ReadFile(defaultFile);
+        const uint32_t oldVersion = DiagramFile::VERSION - 1;
+        std::memcpy(&bytes[8], &oldVersion, sizeof(oldVersion));
+        const std::string oldFile = scratch.File("old_version.diag");
+        std::ofstream(oldFile, std::ios::binary).write(bytes.data(), (std::streamsize)bytes.size());
+        oldVersionRejected = !DiagramFile::Open(oldFile) && !DiagramFile::Open(oldFile, true);
+    }
+    std::cout << "File of version " << DiagramFile::VERSION - 1 << " rejected: " << (oldVersionRejected ? "yes" : "NO") << "\n";
+
+    // Damaged columns. Header: column offsets at byte 152 (8 bytes each: 13 double columns,
+    // then kind, segment, index). Out-of-range kinds and segments (DiagramView::Name would read
+    // past the point names) are rejected even without the checksum; other damage only with it.
+    const std::string original = TestSupport::ReadFile(defaultFile);
+    auto columnOffset = [&](int column) {
+        uint64_t offset;
+        std::memcpy(&offset, &original[152 + 8 * column], sizeof(offset));
+        return size_t(offset);
+    };
+    auto opensDamaged = [&](size_t at, uint8_t value, bool verifyChecksum) {
+        std::string bytes = original;
+        bytes[at] = char(value);
+        const std::string damaged = scratch.File("damaged.diag");
+        std::ofstream(damaged, std::ios::binary).write(bytes.data(), (std::streamsize)bytes.size());
+        return DiagramFile::Open(damaged, verifyChecksum) != nullptr;
+    };
+    const size_t last = diagram.Size() - 1;  // P8: characteristic, segment 8
+    const size_t interp = 1;                 // between P1 and P2: segment 0
+    bool damageRejected =
+        !opensDamaged(columnOffset(14) + interp, CHARACTERISTIC_POINT_COUNT - 1, false) &&  // no P9
+        !opensDamaged(columnOffset(14) + last, CHARACTERISTIC_POINT_COUNT, false) &&
+        !opensDamaged(columnOffset(13) + interp, 3, false) &&                               // no such kind
+        opensDamaged(columnOffset(14) + interp, CHARACTERISTIC_POINT_COUNT - 2, false) &&   // in range
+        opensDamaged(columnOffset(6) + 8 * interp + 3, 0x5a, false) &&                      // N, unchecked
+        !opensDamaged(columnOffset(6) + 8 * interp + 3, 0x5a, true);
+    std::cout << "Damaged kinds, segments and data rejected: " << (damageRejected ? "yes" : "NO") << "\n\n";
+
+    checks.Expect(roundTrip, "Diagram file does not round-trip the diagram");
+    checks.Expect(lawsOk, "Law Ids of the diagram file are not stored or not checked by the designer");
+    checks.Expect(oldVersionRejected, "Diagram file of an older version is opened");
+    checks.Expect(damageRejected, "Damaged diagram file is opened");
+    return checks.Finish("Diagram file round-trips and rejects files it cannot use");
+}
@@ -1,45 +1,36 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <algorithm>
 #include "MaterialProperties.h"
 #include "ConcreteIntegration.h"
 #include "ConcreteIntegrationFast.h"
 #include "PerformanceTimer.h"
+#include "Benchmark.h"
+#include "TestSupport.h"
+
+// Numerical vs. analytical concrete integration: forces, Jacobian, speed and the SoA batch
+// kernel. The other features have test executables of their own (test_*.cpp, see CMakeLists.txt).
+
+int main(int argc, char** argv) {
+    // --no-wait: exit without waiting for Enter (ctest, scripts)
+    bool wait = !(argc > 1 && std::strcmp(argv[1], "--no-wait") == 0);
 
-int main() {
     std::cout << "==========================================================\n";
     std::cout << "  CONCRETE INTEGRATION COMPARISON TEST\n";
     std::cout << "  Numerical (100 segments) vs. Analytical (closed-form)\n";
     std::cout << "==========================================================\n\n";
 
     // Setup test case
-    SectionGeometry geom;
-    geom.b = 0.3;
-    geom.h = 0.5;
-    geom.d1 = 0.05;
-    geom.d2 = 0.05;
-
-    ConcreteProperties concrete;
-    concrete.fcd = -20.0e6;    // -20 MPa
-    concrete.epsC2 = -0.002;
-    concrete.epsCu = -0.0035;
+    SectionGeometry geom = TestSupport::Section();
+    ConcreteProperties concrete = TestSupport::Concrete();
 
     // Test cases
-    struct TestCase {
-        std::string name;
-        double epsTop;
-        double epsBot;
-    };
-
-    std::vector<TestCase> testCases = {
-        {"Pure compression", -0.0035, -0.0035},
-        {"Balanced (εtop=εcu, εbot=0)", -0.0035, 0.0},
-        {"Small bending", -0.002, -0.001},
-        {"Typical bending", -0.003, 0.002},
-        {"Large bending", -0.0035, 0.010},
-        {"Tension dominant", -0.001, 0.005},
-        {"Nearly pure tension", 0.0, 0.010}
-    };
+    std::vector<TestSupport::NamedStrain> testCases = TestSupport::CharacteristicStrains();
 
     std::cout << "Test geometry: b=" << geom.b << "m, h=" << geom.h << "m\n";
     std::cout << "Concrete: fcd=" << concrete.fcd/1e6 << " MPa, ec2=" << concrete.epsC2*1000 << " o/oo\n\n";
@@ -100,6 +91,75 @@ int main() {
     std::cout << "Maximum difference - N: " << maxDiffN << " %\n";
     std::cout << "Maximum difference - M: " << maxDiffM << " %\n\n";
 
+    // Analytical Jacobian vs. central finite differences
+    std::cout << "\n==========================================================\n";
+    std::cout << "  JACOBIAN CHECK (analytical vs. central differences)\n";
+    std::cout << "==========================================================\n\n";
+
+    double maxJacErr = 0.0;
+    for (const auto& tc : testCases) {
+        double k = (tc.epsTop - tc.epsBot) / geom.h;
+        double q = (tc.epsTop + tc.epsBot) / 2.0;
+        ConcreteForcesJacobian jac = ConcreteIntegrationFast::FastConcreteNMWithJacobian(
+            geom.b, geom.h, k, q, concrete.fcd
+        );
+
+        const double dk = 1e-7;
+        const double dq = 1e-9;
+        auto fdK = [&](double kk) { return ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, kk, q, concrete.fcd); };
+        auto fdQ = [&](double qq) { return ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, k, qq, concrete.fcd); };
+        ConcreteForces kp = fdK(k + dk), km = fdK(k - dk);
+        ConcreteForces qp = fdQ(q + dq), qm = fdQ(q - dq);
+
+        // Errors relative to the section scale fcd*b*h per unit strain
+        const double scale = std::abs(concrete.fcd * geom.b * geom.h) / std::abs(concrete.epsC2);
+        double err = 0.0;
+        err = std::max(err, std::abs(jac.dFc_dk - (kp.Fc - km.Fc) / (2.0 * dk)) / (scale * geom.h));
+        err = std::max(err, std::abs(jac.dFc_dq - (qp.Fc - qm.Fc) / (2.0 * dq)) / scale);
+        err = std::max(err, std::abs(jac.dMc_dk - (kp.Mc - km.Mc) / (2.0 * dk)) / (scale * geom.h * geom.h));
+        err = std::max(err, std::abs(jac.dMc_dq - (qp.Mc - qm.Mc) / (2.0 * dq)) / (scale * geom.h));
+        maxJacErr = std::max(maxJacErr, err);
+
+        std::cout << std::setw(30) << std::left << tc.name
+                  << std::scientific << std::setprecision(3)
+                  << "dN/dk=" << jac.dFc_dk << "  dN/dq=" << jac.dFc_dq
+                  << "  dM/dk=" << jac.dMc_dk << "  dM/dq=" << jac.dMc_dq
+                  << "  rel.err=" << err << "\n";
+    }
+    std::cout << "Maximum Jacobian error (relative to section scale): " << maxJacErr << "\n";
+    std::cout << std::fixed << std::setprecision(6);
+
+    // Nearly uniform strain: gradients just above the k = 0 threshold (1e-12) must give the
+    // uniform-strain result, including the plateau zone, in the scalar and the batch kernel
+    std::cout << "\n==========================================================\n";
+    std::cout << "  NEARLY UNIFORM STRAIN (1e-12 <= |k| < 1e-10)\n";
+    std::cout << "==========================================================\n\n";
+
+    std::vector<double> kSmall, qSmall;
+    for (double k : { 2e-12, -2e-12, 5e-11, -5e-11, 9e-11 }) {
+        for (double q : { 0.001, -0.0005, -0.0015, -0.0025, -0.0035 }) {
+            kSmall.push_back(k);
+            qSmall.push_back(q);
+        }
+    }
+    std::vector<double> nSmall(kSmall.size()), mSmall(kSmall.size());
+    ConcreteIntegrationFast::FastConcreteNMBatch(kSmall.data(), qSmall.data(), kSmall.size(),
+                                                 geom.b, geom.h, concrete.fcd,
+                                                 nSmall.data(), mSmall.data());
+    double maxSmallKErr = 0.0;
+    const double scaleUniform = std::abs(concrete.fcd * geom.b * geom.h);
+    for (size_t i = 0; i < kSmall.size(); i++) {
+        ConcreteForces uniform = ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, 0.0, qSmall[i], concrete.fcd);
+        ConcreteForces scalar = ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, kSmall[i], qSmall[i], concrete.fcd);
+        maxSmallKErr = std::max({ maxSmallKErr, std::abs(scalar.Fc - uniform.Fc) / scaleUniform,
+                                  std::abs(scalar.Mc - uniform.Mc) / (scaleUniform * geom.h),
+                                  std::abs(nSmall[i] - uniform.Fc) / scaleUniform,
+                                  std::abs(mSmall[i] - uniform.Mc) / (scaleUniform * geom.h) });
+    }
+    std::cout << std::scientific << std::setprecision(3);
+    std::cout << "Maximum deviation from k = 0 (relative to section scale): " << maxSmallKErr << "\n";
+    std::cout << std::fixed << std::setprecision(6);
+
     // Performance comparison
     std::cout << "\n==========================================================\n";
     std::cout << "  PERFORMANCE COMPARISON\n";
@@ -114,12 +174,13 @@ int main() {
     double epsTop = -0.003;
     double epsBot = 0.002;
 
-    // Benchmark numerical integration
+    // Benchmark numerical integration (see benchmark_suite.cpp for statistically sound timings)
     timer.Start("Numerical_10000");
     for (int i = 0; i < iterations; i++) {
         ConcreteForces cf = ConcreteIntegration::CalculateForce(
             epsTop, epsBot, geom.b, geom.h, concrete
         );
+        Bench::DoNotOptimize(cf);  // keep the call from being optimized away
     }
     double timeNum = timer.Stop();
 
@@ -129,6 +190,7 @@ int main() {
         ConcreteForces cf = ConcreteIntegrationFast::CalculateForce(
             epsTop, epsBot, geom.b, geom.h, concrete
         );
+        Bench::DoNotOptimize(cf);  // keep the call from being optimized away
     }
     double timeFast = timer.Stop();
 
@@ -138,16 +200,88 @@ int main() {
     std::cout << "\nSpeedup: " << (timeNum / timeFast) << "x faster\n";
     std::cout << "Time saved per 1000 calls: " << (timeNum - timeFast) << " ms\n\n";
 
+    // Batch (SoA, SIMD) kernel vs. scalar FastConcreteNM
+    std::cout << "==========================================================\n";
+    std::cout << "  BATCH KERNEL CONSISTENCY (SoA vs. scalar)\n";
+    std::cout << "==========================================================\n\n";
+
+    const size_t batchCount = 1000000;
+    TestSupport::Strains strains = TestSupport::RandomStrains(batchCount, geom.h, concrete.epsC2);
+    const std::vector<double>& kArr = strains.k;
+    const std::vector<double>& qArr = strains.q;
+    std::vector<double> nBatch(batchCount), mBatch(batchCount);
+    std::vector<double> nScalar(batchCount), mScalar(batchCount);
+
+    timer.Start("Scalar_1M");
+    for (size_t i = 0; i < batchCount; i++) {
+        ConcreteForces cf = ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, kArr[i], qArr[i], concrete.fcd);
+        nScalar[i] = cf.Fc;
+        mScalar[i] = cf.Mc;
+    }
+    double timeScalar = timer.Stop();
+
+    timer.Start("Batch_1M");
+    ConcreteIntegrationFast::FastConcreteNMBatch(kArr.data(), qArr.data(), batchCount,
+                                                 geom.b, geom.h, concrete.fcd,
+                                                 nBatch.data(), mBatch.data());
+    double timeBatch = timer.Stop();
+
+    auto ulpDistance = [](double a, double b) -> uint64_t {
+        int64_t ia, ib;
+        std::memcpy(&ia, &a, sizeof(double));
+        std::memcpy(&ib, &b, sizeof(double));
+        if (ia < 0) ia = INT64_MIN - ia;
+        if (ib < 0) ib = INT64_MIN - ib;
+        return ia > ib ? uint64_t(ia - ib) : uint64_t(ib - ia);
+    };
+
+    size_t identical = 0;
+    double maxScaledDiff = 0.0;
+    const double scaleN = std::abs(concrete.fcd * geom.b * geom.h);
+    const double scaleM = scaleN * geom.h;
+    for (size_t i = 0; i < batchCount; i++) {
+        if (ulpDistance(nBatch[i], nScalar[i]) == 0 && ulpDistance(mBatch[i], mScalar[i]) == 0) {
+            identical++;
+        }
+        maxScaledDiff = std::max(maxScaledDiff, std::abs(nBatch[i] - nScalar[i]) / scaleN);
+        maxScaledDiff = std::max(maxScaledDiff, std::abs(mBatch[i] - mScalar[i]) / scaleM);
+    }
+    double maxUlpOfScale = maxScaledDiff / std::numeric_limits<double>::epsilon();
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Strain states:            " << batchCount << "\n";
+    std::cout << "Bit-identical results:    " << identical << " / " << batchCount << "\n";
+    std::cout << "Max difference:           " << maxUlpOfScale << " ULP of fcd*b*h (fcd*b*h^2 for M)\n";
+    std::cout << "Scalar:                   " << timeScalar << " ms\n";
+    std::cout << "Batch:                    " << timeBatch << " ms\n";
+    std::cout << "Batch speedup:            " << (timeScalar / timeBatch) << "x\n\n";
+
     // Summary
     std::cout << "==========================================================\n";
     std::cout << "  SUMMARY\n";
     std::cout << "==========================================================\n\n";
 
+    int failures = 0;
+
+    if (maxJacErr > 1e-5) {
+        failures++;
+        std::cout << "[WARNING] Analytical Jacobian disagrees with finite differences\n";
+    }
+    if (maxSmallKErr > 1e-8) {
+        failures++;
+        std::cout << "[WARNING] Nearly uniform strain differs from the uniform-strain result\n";
+    }
+    if (maxUlpOfScale > 4.0) {
+        failures++;
+        std::cout << "[WARNING] Batch kernel deviates from scalar FastConcreteNM by more than 4 ULP\n";
+    }
+
     if (maxDiffN < 0.1 && maxDiffM < 0.1) {
         std::cout << "[OK] Analytical method matches numerical method within 0.1%\n";
     } else if (maxDiffN < 1.0 && maxDiffM < 1.0) {
         std::cout << "[OK] Analytical method matches numerical method within 1%\n";
     } else {
+        failures++;
         std::cout << "[WARNING] Differences exceed 1% - review implementation\n";
     }
 
@@ -158,8 +292,10 @@ int main() {
     std::cout << "  - Maximum error: " << std::max(maxDiffN, maxDiffM) << "%\n";
 
     std::cout << "\n==========================================================\n";
-    std::cout << "\nPress Enter to exit...";
-    std::cin.get();
+    if (wait) {
+        std::cout << "\nPress Enter to exit...";
+        std::cin.get();
+    }
 
-    return 0;
+    return failures == 0 ? 0 : 1;
 }
@@ -0,0 +1,617 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "MaterialProperties.h"
+#include "ConcreteIntegration.h"
+#include "ConcreteIntegrationFast.h"
+#include "ConcreteIntegrationPolygon.h"
+#include "CsvWriter.h"
+#include "Benchmark.h"
+
+// Randomized differential test of the concrete integrators.
+// Samples strain states (epsTop, epsBot) over every strain region, with extra weight on the
+// edge cases (k ≈ 0, fibers on or next to ε = 0, εc2, εcu), together with random b, h and fcd.
+// Every integration path is compared against an independent long double reference and timed.
+// Exit code 1 on an accuracy or speed regression.
+//
+//   test_integration_differential [--states=2000000] [--seed=1] [--csv=file]
+//                                 [--baseline=file] [--save-baseline=file] [--speed-tolerance=0.25]
+//                                 [--no-wait]
+
+namespace {
+
+constexpr double EPS_C2 = -0.002;   // εc2 of the fcd-only overloads
+constexpr double EPS_CU = -0.0035;
+constexpr size_t CHUNK = 65536;     // states generated, integrated and checked at a time
+constexpr size_t SECTIONS = 1024;   // random rectangles (polygon sections are prebuilt)
+constexpr int NUMERICAL_STRIDE = 8; // the 100-strip integrator only sees every 8th state
+constexpr int WORST = 5;
+
+// Error histogram: exact, < 1e-16, one bin per decade up to 1e-4, ≥ 1e-4
+constexpr int BINS = 15;
+
+int Bin(double err) {
+    if (err == 0.0) return 0;
+    if (err < 1e-16) return 1;
+    if (err >= 1e-4) return BINS - 1;
+    int decade = int(std::floor(std::log10(err)));  // -16 .. -5
+    return std::clamp(decade + 18, 2, BINS - 2);
+}
+
+std::string BinLabel(int bin) {
+    if (bin == 0) return "0";
+    if (bin == 1) return "<1e-16";
+    if (bin == BINS - 1) return ">=1e-4";
+    return "1e" + std::to_string(bin - 18);
+}
+
+enum Category { Uniform, KNearZero, OneBoundary, TwoBoundaries, FullCompression, FullTension, CATEGORIES };
+
+const char* CategoryName(int c) {
+    static const char* const names[CATEGORIES] = {
+        "uniform", "k~0", "boundary", "2 boundaries", "compression", "tension"
+    };
+    return names[c];
+}
+
+struct State {
+    double epsTop, epsBot, b, h, fcd;
+    int category;
+};
+
+struct Worst {
+    double err = -1.0;
+    State state{};
+    double refN = 0.0, refM = 0.0, N = 0.0, M = 0.0;
+};
+
+struct PathStats {
+    std::string name;
+    double maxErrN = 0.0;
+    double maxErrM = 0.0;
+    double maxErrByCategory[CATEGORIES] = {};
+    uint64_t histogram[BINS] = {};
+    Worst worst[WORST];
+    uint64_t calls = 0;
+    double seconds = 0.0;
+
+    double NsPerCall() const { return calls > 0 ? seconds * 1e9 / double(calls) : 0.0; }
+
+    void Add(const State& s, double refN, double refM, double N, double M) {
+        double scaleN = std::abs(s.fcd) * s.b * s.h;
+        double eN = std::abs(N - refN) / scaleN;
+        double eM = std::abs(M - refM) / (scaleN * s.h);
+        if (!std::isfinite(eN) || !std::isfinite(eM)) eN = eM = 1.0;  // NaN/inf is the worst case
+
+        maxErrN = std::max(maxErrN, eN);
+        maxErrM = std::max(maxErrM, eM);
+        double err = std::max(eN, eM);
+        maxErrByCategory[s.category] = std::max(maxErrByCategory[s.category], err);
+        histogram[Bin(err)]++;
+
+        if (err > worst[WORST - 1].err) {
+            int i = WORST - 1;
+            for (; i > 0 && worst[i - 1].err < err; i--) worst[i] = worst[i - 1];
+            worst[i] = { err, s, refN, refM, N, M };
+        }
+    }
+};
+
+// Reference: piecewise Gauss-Legendre in long double, split at ε = 0 and ε = εc2.
+// The stress is a polynomial of degree ≤ 2 on every piece, so the 3-point rule is exact
+// there and the only error left is rounding. Moment in the local convention (M = ∫σ·x dA,
+// x upwards from the centroid), like FastConcreteNM.
+long double Stress(long double eps, long double fcd) {
+    if (eps >= 0.0L) return 0.0L;
+    if (eps > EPS_C2) {
+        long double t = 1.0L - eps / EPS_C2;
+        return fcd * (1.0L - t * t);
+    }
+    return fcd;
+}
+
+void Reference(const State& s, double& N, double& M) {
+    const long double top = s.epsTop, bot = s.epsBot, h = s.h, fcd = s.fcd;
+    const long double d = top - bot;
+
+    long double cuts[4] = { 0.0L, 0.0L, 0.0L, 1.0L };
+    int n = 1;
+    if (d != 0.0L) {
+        for (long double target : { 0.0L, (long double)EPS_C2 }) {
+            long double t = (target - bot) / d;
+            if (t > 0.0L && t < 1.0L) cuts[n++] = t;
+        }
+    }
+    cuts[n] = 1.0L;
+    if (n == 3 && cuts[1] > cuts[2]) std::swap(cuts[1], cuts[2]);
+
+    static const long double node = std::sqrt(0.6L);
+    static const long double nodes[3] = { -node, 0.0L, node };
+    static const long double weights[3] = { 5.0L / 9.0L, 8.0L / 9.0L, 5.0L / 9.0L };
+
+    long double sumN = 0.0L, sumM = 0.0L;
+    for (int p = 0; p < n; p++) {
+        long double mid = 0.5L * (cuts[p] + cuts[p + 1]), half = 0.5L * (cuts[p + 1] - cuts[p]);
+        for (int g = 0; g < 3; g++) {
+            long double t = mid + half * nodes[g];
+            long double sigma = Stress(bot + d * t, fcd);
+            sumN += weights[g] * half * sigma;
+            sumM += weights[g] * half * sigma * (t - 0.5L) * h;
+        }
+    }
+    N = double(sumN * s.b * h);
+    M = double(sumM * s.b * h);
+}
+
+// Brute-force midpoint sum, only used to validate the reference itself
+void MidpointReference(const State& s, int strips, double& N, double& M) {
+    const long double top = s.epsTop, bot = s.epsBot, h = s.h;
+    long double sumN = 0.0L, sumM = 0.0L;
+    for (int i = 0; i < strips; i++) {
+        long double t = (i + 0.5L) / strips;
+        long double sigma = Stress(bot + (top - bot) * t, s.fcd);
+        sumN += sigma;
+        sumM += sigma * (t - 0.5L) * h;
+    }
+    N = double(sumN * s.b * h / strips);
+    M = double(sumM * s.b * h / strips);
+}
+
+class Sampler {
+    std::mt19937_64 rng;
+    std::uniform_real_distribution<double> unit{ 0.0, 1.0 };
+
+    double U(double lo, double hi) { return lo + (hi - lo) * unit(rng); }
+
+    // Strain on a zone boundary, exactly or displaced by 1e-20 .. 1e-6
+    double BoundaryStrain() {
+        static const double boundaries[3] = { 0.0, EPS_C2, EPS_CU };
+        double eps = boundaries[rng() % 3];
+        if (rng() % 4 == 0) return eps;
+        double delta = std::pow(10.0, U(-20.0, -6.0));
+        return rng() % 2 ? eps + delta : eps - delta;
+    }
+
+    double AnyStrain() { return U(EPS_CU, 0.010); }
+
+public:
+    explicit Sampler(uint64_t seed) : rng(seed) {}
+
+    size_t Section() { return size_t(rng() % SECTIONS); }
+    double Fcd() { return -U(10.0e6, 50.0e6); }
+
+    void Strains(int category, double& top, double& bot) {
+        switch (category) {
+        case Uniform:
+            top = AnyStrain();
+            bot = AnyStrain();
+            break;
+        case KNearZero: {
+            double q = rng() % 2 ? U(EPS_CU - 0.0005, 0.003) : BoundaryStrain();
+            double delta = rng() % 4 == 0 ? 0.0 : std::pow(10.0, U(-20.0, -8.0));
+            if (rng() % 2) delta = -delta;
+            top = q + 0.5 * delta;
+            bot = q - 0.5 * delta;
+            break;
+        }
+        case OneBoundary:
+            top = BoundaryStrain();
+            bot = AnyStrain();
+            break;
+        case TwoBoundaries:
+            top = BoundaryStrain();
+            bot = BoundaryStrain();
+            break;
+        case FullCompression:
+            top = U(EPS_CU, 0.0);
+            bot = U(EPS_CU, 0.0);
+            break;
+        default:
+            top = U(0.0, 0.010);
+            bot = U(0.0, 0.010);
+            break;
+        }
+        if (rng() % 2) std::swap(top, bot);
+    }
+
+    int Category() { return int(rng() % CATEGORIES); }
+};
+
+double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool ParseOption(const char* arg, const char* name, std::string& value) {
+    size_t n = std::strlen(name);
+    if (std::strncmp(arg, name, n) != 0 || arg[n] != '=') return false;
+    value = arg + n + 1;
+    return true;
+}
+
+// Baseline file: "Path,NsPerCall" lines, as written by --save-baseline
+bool LoadBaseline(const std::string& filename, std::vector<std::pair<std::string, double>>& out) {
+    std::ifstream in(filename);
+    if (!in.is_open()) return false;
+    std::string line;
+    std::getline(in, line);  // header
+    while (std::getline(in, line)) {
+        size_t comma = line.find(',');
+        if (comma == std::string::npos) continue;
+        out.emplace_back(line.substr(0, comma), std::atof(line.c_str() + comma + 1));
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t states = 2000000;
+    uint64_t seed = 1;
+    double speedTolerance = 0.25;
+    std::string csvFile, baselineFile, saveBaselineFile;
+    bool wait = true;
+
+    for (int i = 1; i < argc; i++) {
+        std::string value;
+        if (std::strcmp(argv[i], "--no-wait") == 0) wait = false;
+        else if (ParseOption(argv[i], "--states", value)) states = size_t(std::atof(value.c_str()));
+        else if (ParseOption(argv[i], "--seed", value)) seed = std::strtoull(value.c_str(), nullptr, 10);
+        else if (ParseOption(argv[i], "--csv", value)) csvFile = value;
+        else if (ParseOption(argv[i], "--baseline", value)) baselineFile = value;
+        else if (ParseOption(argv[i], "--save-baseline", value)) saveBaselineFile = value;
+        else if (ParseOption(argv[i], "--speed-tolerance", value)) speedTolerance = std::atof(value.c_str());
+        else {
+            std::cerr << "Error: unknown option " << argv[i] << "\n";
+            return 2;
+        }
+    }
+
+    std::cout << "==========================================================\n";
+    std::cout << "  DIFFERENTIAL INTEGRATION TEST\n";
+    std::cout << "  " << states << " random strain states vs. long double reference\n";
+    std::cout << "==========================================================\n\n";
+    std::cout << "Batch kernel: " << ConcreteSimd::WidestLane::Width << " lanes\n";
+
+    Sampler sampler(seed);
+
+    struct Section { double b, h; PolygonSection polygon; };
+    std::vector<Section> sections;
+    sections.reserve(SECTIONS);
+    {
+        std::mt19937_64 shapes(seed ^ 0x5eC710u);
+        std::uniform_real_distribution<double> bDist(0.15, 1.0), hDist(0.2, 1.5);
+        for (size_t i = 0; i < SECTIONS; i++) {
+            double b = bDist(shapes), h = hDist(shapes);
+            sections.push_back({ b, h, PolygonSection::Rectangle(b, h) });
+        }
+    }
+
+    enum { Numerical, Analytical, AnalyticalJacobian, Batch, Polygon, PATHS };
+    PathStats paths[PATHS];
+    paths[Numerical].name = "Numerical (100 strips)";
+    paths[Analytical].name = "Analytical";
+    paths[AnalyticalJacobian].name = "Analytical + Jacobian";
+    paths[Batch].name = "Batch (SIMD)";
+    paths[Polygon].name = "Polygon";
+
+    std::vector<State> batchStates(CHUNK);
+    std::vector<size_t> sectionIndex(CHUNK);
+    std::vector<double> kArr(CHUNK), qArr(CHUNK), bArr(CHUNK), hArr(CHUNK), fcdArr(CHUNK);
+    std::vector<double> refN(CHUNK), refM(CHUNK), outN(CHUNK), outM(CHUNK);
+    std::vector<double> scalarN(CHUNK), scalarM(CHUNK);
+
+    double maxBatchUlp = 0.0;     // batch vs. scalar, in ULP of the force / moment scale
+    bool jacobianIdentical = true;
+    double maxReferenceCheck = 0.0;
+    uint64_t categoryCount[CATEGORIES] = {};
+
+    auto run = [&](PathStats& path, size_t count, auto&& body) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        path.seconds += Seconds(start);
+        path.calls += count;
+    };
+
+    for (size_t done = 0; done < states; done += CHUNK) {
+        const size_t n = std::min(CHUNK, states - done);
+
+        for (size_t i = 0; i < n; i++) {
+            State& s = batchStates[i];
+            s.category = sampler.Category();
+            sampler.Strains(s.category, s.epsTop, s.epsBot);
+            sectionIndex[i] = sampler.Section();
+            s.b = sections[sectionIndex[i]].b;
+            s.h = sections[sectionIndex[i]].h;
+            s.fcd = sampler.Fcd();
+            categoryCount[s.category]++;
+
+            // Same conversion as ConcreteIntegrationFast::CalculateForce
+            kArr[i] = (s.epsTop - s.epsBot) / s.h;
+            qArr[i] = (s.epsTop + s.epsBot) / 2.0;
+            bArr[i] = s.b;
+            hArr[i] = s.h;
+            fcdArr[i] = s.fcd;
+            Reference(s, refN[i], refM[i]);
+        }
+
+        // The reference itself against a 20000-strip midpoint sum (first chunk only)
+        if (done == 0) {
+            for (size_t i = 0; i < std::min<size_t>(n, 500); i++) {
+                double N, M;
+                MidpointReference(batchStates[i], 20000, N, M);
+                double scaleN = std::abs(batchStates[i].fcd) * batchStates[i].b * batchStates[i].h;
+                maxReferenceCheck = std::max(maxReferenceCheck, std::abs(N - refN[i]) / scaleN);
+                maxReferenceCheck = std::max(maxReferenceCheck, std::abs(M - refM[i]) / (scaleN * batchStates[i].h));
+            }
+        }
+
+        // Numerical: subset only, moment in the opposite (C++) convention
+        {
+            size_t m = 0;
+            run(paths[Numerical], (n + NUMERICAL_STRIDE - 1) / NUMERICAL_STRIDE, [&] {
+                for (size_t i = 0; i < n; i += NUMERICAL_STRIDE, m++) {
+                    const State& s = batchStates[i];
+                    ConcreteProperties props{ s.fcd, EPS_C2, EPS_CU };
+                    ConcreteForces cf = ConcreteIntegration::CalculateForce(s.epsTop, s.epsBot, s.b, s.h, props);
+                    outN[m] = cf.Fc;
+                    outM[m] = -cf.Mc;
+                }
+            });
+            for (size_t i = 0, j = 0; i < n; i += NUMERICAL_STRIDE, j++) {
+                paths[Numerical].Add(batchStates[i], refN[i], refM[i], outN[j], outM[j]);
+            }
+        }
+
+        run(paths[Analytical], n, [&] {
+            for (size_t i = 0; i < n; i++) {
+                ConcreteForces cf = ConcreteIntegrationFast::FastConcreteNM(bArr[i], hArr[i], kArr[i], qArr[i], fcdArr[i]);
+                scalarN[i] = cf.Fc;
+                scalarM[i] = cf.Mc;
+            }
+        });
+        for (size_t i = 0; i < n; i++) {
+            paths[Analytical].Add(batchStates[i], refN[i], refM[i], scalarN[i], scalarM[i]);
+        }
+
+        run(paths[AnalyticalJacobian], n, [&] {
+            for (size_t i = 0; i < n; i++) {
+                ConcreteForcesJacobian cf = ConcreteIntegrationFast::FastConcreteNMWithJacobian(
+                    bArr[i], hArr[i], kArr[i], qArr[i], fcdArr[i]);
+                outN[i] = cf.Fc;
+                outM[i] = cf.Mc;
+                Bench::DoNotOptimize(cf.dMc_dk);
+            }
+        });
+        for (size_t i = 0; i < n; i++) {
+            paths[AnalyticalJacobian].Add(batchStates[i], refN[i], refM[i], outN[i], outM[i]);
+            if (outN[i] != scalarN[i] || outM[i] != scalarM[i]) jacobianIdentical = false;
+        }
+
+        run(paths[Batch], n, [&] {
+            ConcreteIntegrationFast::FastConcreteNMBatch(kArr.data(), qArr.data(), bArr.data(), hArr.data(),
+                                                         fcdArr.data(), n, outN.data(), outM.data());
+        });
+        for (size_t i = 0; i < n; i++) {
+            paths[Batch].Add(batchStates[i], refN[i], refM[i], outN[i], outM[i]);
+            double ulpN = std::abs(fcdArr[i] * bArr[i] * hArr[i]) * std::numeric_limits<double>::epsilon();
+            maxBatchUlp = std::max(maxBatchUlp, std::abs(outN[i] - scalarN[i]) / ulpN);
+            maxBatchUlp = std::max(maxBatchUlp, std::abs(outM[i] - scalarM[i]) / (ulpN * hArr[i]));
+        }
+
+        run(paths[Polygon], n, [&] {
+            for (size_t i = 0; i < n; i++) {
+                ConcreteProperties props{ fcdArr[i], EPS_C2, EPS_CU };
+                ConcreteForces cf = ConcreteIntegrationPolygon::PolygonConcreteNM(
+                    sections[sectionIndex[i]].polygon, kArr[i], qArr[i], props);
+                outN[i] = cf.Fc;
+                outM[i] = cf.Mc;
+            }
+        });
+        for (size_t i = 0; i < n; i++) {
+            paths[Polygon].Add(batchStates[i], refN[i], refM[i], outN[i], outM[i]);
+        }
+    }
+
+    // Accuracy limits, relative to |fcd|·b·h (N) and |fcd|·b·h² (M), for the bulk categories
+    // (uniform, full compression, full tension) and for the edge cases. The closed-form paths
+    // sit at rounding level in the bulk; at the edges they treat |k| < 1e-12 as uniform strain
+    // and drop zones thinner than 1e-12 m, which costs up to |k|·h/|εc2| ≈ 1e-9.
+    // The 100-strip midpoint rule is O(1/n²) plus the kink of the stress law inside a strip.
+    const double bulkLimits[PATHS] = { 5e-4, 1e-14, 1e-14, 1e-14, 1e-14 };
+    const double edgeLimits[PATHS] = { 5e-4, 1e-9, 1e-9, 1e-9, 1e-14 };
+    auto isEdge = [](int c) { return c == KNearZero || c == OneBoundary || c == TwoBoundaries; };
+
+    std::cout << "States per category:";
+    for (int c = 0; c < CATEGORIES; c++) std::cout << "  " << CategoryName(c) << "=" << categoryCount[c];
+    std::cout << "\nReference vs. 20000-strip midpoint sum: max error " << std::scientific
+              << std::setprecision(2) << maxReferenceCheck << "\n\n";
+
+    // Accuracy and speed
+    std::cout << "ACCURACY AND SPEED (errors relative to |fcd|*b*h and |fcd|*b*h^2):\n";
+    std::cout << std::string(92, '-') << "\n";
+    std::cout << std::left << std::setw(26) << "Path" << std::right
+              << std::setw(10) << "States" << std::setw(12) << "Max err N" << std::setw(12) << "Max err M"
+              << std::setw(12) << "Edge limit" << std::setw(10) << "ns/call" << std::setw(10) << "Speedup" << "\n";
+    std::cout << std::string(92, '-') << "\n";
+    for (const PathStats& p : paths) {
+        std::cout << std::left << std::setw(26) << p.name << std::right << std::setw(10) << p.calls
+                  << std::scientific << std::setprecision(2)
+                  << std::setw(12) << p.maxErrN << std::setw(12) << p.maxErrM
+                  << std::setw(12) << edgeLimits[&p - paths]
+                  << std::fixed << std::setprecision(1) << std::setw(10) << p.NsPerCall()
+                  << std::setw(9) << paths[Numerical].NsPerCall() / p.NsPerCall() << "x\n";
+    }
+    std::cout << std::string(92, '-') << "\n\n";
+
+    // Maximum error per strain category
+    std::cout << "MAX ERROR PER CATEGORY:\n";
+    std::cout << std::left << std::setw(26) << "Path" << std::right;
+    for (int c = 0; c < CATEGORIES; c++) std::cout << std::setw(13) << CategoryName(c);
+    std::cout << "\n" << std::scientific << std::setprecision(2);
+    for (const PathStats& p : paths) {
+        std::cout << std::left << std::setw(26) << p.name << std::right;
+        for (int c = 0; c < CATEGORIES; c++) std::cout << std::setw(13) << p.maxErrByCategory[c];
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+
+    // Error histograms (max of the N and M errors per state)
+    std::cout << "ERROR HISTOGRAM (states per decade of max(err N, err M)):\n";
+    std::cout << std::left << std::setw(10) << "Error" << std::right;
+    for (const PathStats& p : paths) std::cout << std::setw(24) << p.name;
+    std::cout << "\n";
+    for (int bin = 0; bin < BINS; bin++) {
+        uint64_t total = 0;
+        for (const PathStats& p : paths) total += p.histogram[bin];
+        if (total == 0) continue;
+        std::cout << std::left << std::setw(10) << BinLabel(bin) << std::right;
+        for (const PathStats& p : paths) std::cout << std::setw(24) << p.histogram[bin];
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+
+    // Worst cases
+    std::cout << "WORST CASES:\n";
+    std::cout << std::scientific << std::setprecision(6);
+    for (const PathStats& p : paths) {
+        std::cout << "  " << p.name << "\n";
+        for (const Worst& w : p.worst) {
+            if (w.err < 0.0) break;
+            std::cout << "    err=" << std::setprecision(2) << w.err << std::setprecision(9)
+                      << "  epsTop=" << w.state.epsTop << " epsBot=" << w.state.epsBot
+                      << std::setprecision(4) << "  b=" << w.state.b << " h=" << w.state.h
+                      << " fcd=" << w.state.fcd << "  [" << CategoryName(w.state.category) << "]\n"
+                      << std::setprecision(9)
+                      << "      N=" << w.N << " ref " << w.refN << "   M=" << w.M << " ref " << w.refM << "\n";
+        }
+    }
+    std::cout << "\n" << std::defaultfloat << std::setprecision(6);
+
+    if (!csvFile.empty()) {
+        CsvWriter csv(csvFile);
+        if (!csv.IsOpen()) {
+            std::cerr << "Error: Cannot open file " << csvFile << "\n";
+        } else {
+            csv.Text("Path,States,MaxErrN,MaxErrM,NsPerCall");
+            for (int bin = 0; bin < BINS; bin++) {
+                csv.Text(",Hist_");
+                csv.Text(BinLabel(bin));
+            }
+            csv.Char('\n');
+            for (const PathStats& p : paths) {
+                csv.Text(p.name);
+                csv.Char(',');
+                csv.Integer(int64_t(p.calls));
+                csv.Char(',');
+                csv.Number(p.maxErrN);
+                csv.Char(',');
+                csv.Number(p.maxErrM);
+                csv.Char(',');
+                csv.Fixed(p.NsPerCall(), 2);
+                for (int bin = 0; bin < BINS; bin++) {
+                    csv.Char(',');
+                    csv.Integer(int64_t(p.histogram[bin]));
+                }
+                csv.Char('\n');
+            }
+            if (csv.Close()) std::cout << "Results exported to " << csvFile << "\n\n";
+        }
+    }
+
+    if (!saveBaselineFile.empty()) {
+        std::ofstream out(saveBaselineFile);
+        if (!out.is_open()) {
+            std::cerr << "Error: Cannot open file " << saveBaselineFile << "\n";
+        } else {
+            out << "Path,NsPerCall\n" << std::fixed << std::setprecision(2);
+            for (const PathStats& p : paths) out << p.name << "," << p.NsPerCall() << "\n";
+            std::cout << "Speed baseline saved to " << saveBaselineFile << "\n\n";
+        }
+    }
+
+    std::cout << "==========================================================\n";
+    std::cout << "  SUMMARY\n";
+    std::cout << "==========================================================\n\n";
+
+    int failures = 0;
+
+    if (maxReferenceCheck > 1e-7) {
+        failures++;
+        std::cout << "[WARNING] Reference integration disagrees with the brute-force midpoint sum\n";
+    }
+    for (int p = 0; p < PATHS; p++) {
+        for (int c = 0; c < CATEGORIES; c++) {
+            double limit = isEdge(c) ? edgeLimits[p] : bulkLimits[p];
+            if (!(paths[p].maxErrByCategory[c] <= limit)) {
+                failures++;
+                std::cout << "[WARNING] " << paths[p].name << " exceeds its error limit of " << limit
+                          << " for " << CategoryName(c) << " states\n";
+            }
+        }
+    }
+    if (!jacobianIdentical) {
+        failures++;
+        std::cout << "[WARNING] FastConcreteNMWithJacobian forces differ from FastConcreteNM\n";
+    }
+    if (maxBatchUlp > 4.0) {
+        failures++;
+        std::cout << "[WARNING] Batch kernel deviates from scalar FastConcreteNM by more than 4 ULP\n";
+    }
+
+    // Speed: ratios between paths (independent of the machine), plus an optional saved baseline
+    double numericalNs = paths[Numerical].NsPerCall(), analyticalNs = paths[Analytical].NsPerCall();
+    if (analyticalNs * 5.0 > numericalNs) {
+        failures++;
+        std::cout << "[WARNING] Analytical integration is less than 5x faster than the numerical one\n";
+    }
+    if (paths[Polygon].NsPerCall() > numericalNs) {
+        failures++;
+        std::cout << "[WARNING] Polygon integration is slower than the numerical one\n";
+    }
+#if defined(__AVX2__) || defined(__AVX512F__)
+    // Without vector lanes the batch kernel is branchless scalar code and may lose to the branchy one
+    if (paths[Batch].NsPerCall() > analyticalNs) {
+        failures++;
+        std::cout << "[WARNING] SIMD batch kernel is slower per state than scalar FastConcreteNM\n";
+    }
+#endif
+    if (!baselineFile.empty()) {
+        std::vector<std::pair<std::string, double>> baseline;
+        if (!LoadBaseline(baselineFile, baseline)) {
+            failures++;
+            std::cout << "[WARNING] Cannot read speed baseline " << baselineFile << "\n";
+        }
+        for (const auto& entry : baseline) {
+            for (const PathStats& p : paths) {
+                if (p.name != entry.first || entry.second <= 0.0) continue;
+                double ratio = p.NsPerCall() / entry.second;
+                if (ratio > 1.0 + speedTolerance) {
+                    failures++;
+                    std::cout << "[WARNING] " << p.name << " is " << std::fixed << std::setprecision(0)
+                              << (ratio - 1.0) * 100.0 << "% slower than the baseline ("
+                              << std::setprecision(1) << p.NsPerCall() << " vs. " << entry.second << " ns/call)\n";
+                }
+            }
+        }
+    }
+
+    if (failures == 0) {
+        std::cout << "[OK] All paths within their error limits, no speed regression\n";
+    }
+
+    std::cout << "\n==========================================================\n";
+
+    if (wait) {
+        std::cout << "\nPress Enter to exit...";
+        std::cin.get();
+    }
+    return failures == 0 ? 0 : 1;
+}
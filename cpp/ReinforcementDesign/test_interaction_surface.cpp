@@ -0,0 +1,80 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include "MaterialProperties.h"
+#include "ConcreteIntegrationFast.h"
+#include "ConcreteIntegrationPolygon.h"
+#include "InteractionDiagram.h"
+#include "InteractionSurface.h"
+#include "PerformanceTimer.h"
+#include "TestSupport.h"
+
+// Biaxial bending: rotated sections, the uniaxial meridian and closure of the N-My-Mz surface.
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+    const TestSupport::Strains strains = TestSupport::RandomStrains(10000, geom.h, concrete.epsC2);
+    const double scaleN = std::abs(concrete.fcd * geom.b * geom.h);
+    const double scaleM = scaleN * geom.h;
+    const double pi = 3.14159265358979323846;
+    const double as = 10.0 / 10000.0;
+
+    TestSupport::PrintHeader("BIAXIAL INTERACTION SURFACE");
+
+    // Rectangle rotated by 90 degrees: width and height swap, no moment about the vertical axis
+    PolygonSection rectRotated = PolygonSection::Rectangle(geom.b, geom.h).Rotated(pi / 2.0);
+    double maxRotated = 0.0;
+    for (size_t i = 0; i < strains.k.size(); i++) {
+        double k = strains.k[i] * geom.h / geom.b;
+        ConcreteForces a = ConcreteIntegrationFast::FastConcreteNM(geom.h, geom.b, k, strains.q[i], concrete.fcd);
+        BiaxialConcreteForces p = ConcreteIntegrationPolygon::PolygonConcreteNMM(rectRotated, k, strains.q[i], concrete);
+        maxRotated = std::max(maxRotated, std::abs(a.Fc - p.Fc) / scaleN);
+        maxRotated = std::max(maxRotated, std::abs(a.Mc - p.Mc) / scaleM);
+        maxRotated = std::max(maxRotated, std::abs(p.McX) / scaleM);
+    }
+
+    // Meridian 0 (neutral axis horizontal) must reproduce the uniaxial diagram
+    InteractionSurface bottomOnly = InteractionSurface::RectangularColumn(geom, concrete, steel, 0.0, as);
+    bottomOnly.Generate(8, 10);
+    std::vector<DiagramPoint> uniaxial = InteractionDiagram(geom, concrete, steel, 0.0, as).Generate(10);
+    double maxMeridian = 0.0;
+    for (int p = 0; p < bottomOnly.PointsPerMeridian() && p < (int)uniaxial.size(); p++) {
+        uint32_t v = bottomOnly.MeridianVertex(0, p);
+        maxMeridian = std::max(maxMeridian, std::abs(bottomOnly.N(v) - uniaxial[p].N) / (scaleN / 1000.0));
+        maxMeridian = std::max(maxMeridian, std::abs(bottomOnly.My(v) - uniaxial[p].M) / (scaleM / 1000.0));
+        maxMeridian = std::max(maxMeridian, std::abs(bottomOnly.Mz(v)) / (scaleM / 1000.0));
+    }
+
+    // Symmetric corner bars: every mesh vertex lies on the surface (utilization 1 up to faceting)
+    PerformanceTimer timer(false);
+    timer.Start("InteractionSurface_36x81");
+    InteractionSurface column = InteractionSurface::RectangularColumn(geom, concrete, steel, as, as);
+    column.Generate(36, 10);
+    double timeSurface = timer.Stop();
+
+    double maxVertexDev = 0.0;
+    timer.Start("SurfaceUtilization");
+    for (size_t v = 0; v < column.VertexCount(); v++) {
+        double u = column.Utilization(column.N(v), column.My(v), column.Mz(v));
+        maxVertexDev = std::max(maxVertexDev, std::abs(u - 1.0));
+    }
+    double timeQueries = timer.Stop();
+
+    std::cout << std::scientific << std::setprecision(3);
+    std::cout << "Rotated rectangle vs. analytical:  " << maxRotated << " (relative to fcd*b*h)\n";
+    std::cout << "Meridian 0 vs. uniaxial diagram:   " << maxMeridian << " (relative to fcd*b*h)\n";
+    std::cout << "Vertex utilization |u - 1|:        " << maxVertexDev << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Surface generation (36 x " << column.PointsPerMeridian() << "): " << timeSurface << " ms, "
+              << column.Triangles().size() << " triangles\n";
+    std::cout << "Capacity checks:                   " << timeQueries << " ms (" << column.VertexCount() << " queries)\n\n";
+
+    checks.Expect(maxRotated <= 1e-10 && maxMeridian <= 1e-10 && maxVertexDev <= 0.01,
+                  "Biaxial surface disagrees with the uniaxial results or is not closed");
+    return checks.Finish("Biaxial surface matches the uniaxial results and is closed");
+}
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include "MaterialProperties.h"
+#include "ReinforcementDesigner.h"
+#include "LoadEnvelope.h"
+#include "TestSupport.h"
+
+// Envelope pruning: designing only the governing load cases must cover every case.
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+
+    TestSupport::PrintHeader("ENVELOPE PRUNING (governing load cases only)");
+
+    ReinforcementDesigner designer(geom, concrete, steel, 10, DesignSolver::Newton);
+    designer.SetThreadCount(2);
+
+    bool maxSame = true, rowsOk = true;
+    size_t envCases = 0, envDesigned = 0, envUncovered = 0;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (DesignSolver solver : { DesignSolver::Newton, DesignSolver::Interpolation }) {
+        designer.SetSolver(solver);
+        for (int member = 0; member < 40; member++) {
+            // Combinations of permanent + three variable load patterns, some of them into
+            // compression failure (not pruned)
+            const double gN = -1200e3 * u(rng), gM = 200e3 * u(rng);
+            std::vector<DesignLoads> combos(2000);
+            for (auto& l : combos) {
+                double q1 = u(rng), q2 = 2.0 * u(rng) - 1.0, q3 = u(rng);
+                l = { gN - 200e3 * q1 + 80e3 * q2 + 50e3 * q3, gM + 120e3 * q1 + 60e3 * q2 - 30e3 * q3 };
+            }
+
+            std::vector<DesignResult> full = designer.DesignBatch(combos);
+            std::vector<DesignResult> pruned(combos.size());
+            size_t designed = designer.DesignEnvelope(combos.data(), combos.size(), pruned.data());
+
+            double fullMax = 0.0, prunedMax = 0.0;
+            for (size_t i = 0; i < combos.size(); i++) {
+                if (full[i].converged) fullMax = std::max(fullMax, full[i].As2);
+                if (pruned[i].converged) prunedMax = std::max(prunedMax, pruned[i].As2);
+                if (full[i].converged && (!pruned[i].converged || full[i].As2 > pruned[i].As2 * (1.0 + 1e-9) + 1e-12)) {
+                    envUncovered++;
+                }
+            }
+            maxSame = maxSame && prunedMax == fullMax;
+
+            // Designed rows are the full results; the others carry only As2 and converged
+            size_t enveloped = 0;
+            for (size_t i = 0; i < combos.size(); i++) {
+                if (pruned[i].iterations == -1) {
+                    enveloped++;
+                    rowsOk = rowsOk && pruned[i].converged && std::isnan(pruned[i].N_calc) && std::isnan(pruned[i].epsTop);
+                } else {
+                    rowsOk = rowsOk && pruned[i].As2 == full[i].As2 && pruned[i].M_calc == full[i].M_calc &&
+                             pruned[i].iterations == full[i].iterations;
+                }
+            }
+            rowsOk = rowsOk && enveloped == combos.size() - designed;
+            envCases += combos.size();
+            envDesigned += designed;
+        }
+    }
+    designer.SetSolver(DesignSolver::Newton);
+
+    // A pure bending member (all cases yielded): pruned to a handful, and the band pre-pass
+    // must not change the result
+    std::vector<DesignLoads> beam(100000);
+    for (auto& l : beam) {
+        double q1 = u(rng), q2 = 2.0 * u(rng) - 1.0;
+        l = { -100e3 * q1 + 30e3 * q2, 40e3 + 150e3 * q1 + 40e3 * q2 };
+    }
+    const double z2 = geom.h / 2.0 - geom.d2;
+    LoadEnvelope beamBands = LoadEnvelope::Build(beam.data(), beam.size(), designer.GetDiagram(), z2, steel.fyd);
+    LoadEnvelope beamAll = LoadEnvelope::Build(beam.data(), beam.size(), designer.GetDiagram(), z2, steel.fyd, 0);
+
+    // All cases inside the yielded part of the concrete-only diagram (between its curve and the
+    // chord from the origin to N = -1320 kN, M = 181 kNm): none governs, so one case is designed
+    // and the rest are enveloped by it
+    std::vector<DesignLoads> inside(500);
+    for (auto& l : inside) {
+        double n = -500e3 - 200e3 * u(rng);
+        l = { n, -0.137 * n + 10e3 + 15e3 * u(rng) };
+    }
+    std::vector<DesignResult> insideResults(inside.size());
+    size_t insideDesigned = designer.DesignEnvelope(inside.data(), inside.size(), insideResults.data());
+    size_t insideEnveloped = 0;
+    for (size_t i = 0; i < inside.size(); i++) {
+        if (insideResults[i].iterations == -1) insideEnveloped++;
+    }
+    DesignResult insideFirst = designer.Design(inside[0], false);
+    bool insideOk = insideDesigned == 1 && insideEnveloped == inside.size() - 1 && insideFirst.converged &&
+                    insideResults[0].As2 == insideFirst.As2 && insideResults[1].As2 == insideFirst.As2 &&
+                    std::isnan(insideResults[1].M_calc);
+
+    std::cout << "Mixed members: " << envCases << " cases, " << envDesigned << " designed ("
+              << std::fixed << std::setprecision(1) << double(envCases) / std::max<size_t>(1, envDesigned)
+              << "x fewer), cases not covered: " << envUncovered << "\n";
+    std::cout << "Bending member: " << beam.size() << " cases, " << beamBands.Candidates() << " band candidates, "
+              << beamBands.Escaped() << " added by the final check, " << beamBands.Governing().size() << " governing\n";
+    std::cout << "Cases inside the diagram: " << inside.size() << ", designed: " << insideDesigned
+              << ", enveloped: " << insideEnveloped << "\n\n";
+
+    checks.Expect(envUncovered == 0, "Envelope design leaves load cases uncovered");
+    checks.Expect(maxSame, "Envelope design changes the governing As2 of a member");
+    checks.Expect(rowsOk, "Envelope rows are not the designed results or not marked as enveloped");
+    checks.Expect(insideOk, "Load cases inside the diagram are not enveloped by one designed case");
+    checks.Expect(beamBands.Governing() == beamAll.Governing(), "Band pre-pass changes the governing cases");
+    checks.Expect(beamBands.Governing().size() * 100 < beam.size(), "Bending member is not pruned");
+    return checks.Finish("Envelope pruning covers every load case");
+}
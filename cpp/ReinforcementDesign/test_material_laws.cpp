@@ -0,0 +1,151 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include "MaterialProperties.h"
+#include "MaterialLaws.h"
+#include "ConcreteIntegrationFast.h"
+#include "ConcreteIntegrationPolygon.h"
+#include "InteractionDiagram.h"
+#include "SteelStress.h"
+#include "TestSupport.h"
+
+// Material-law policies: closed forms vs. strip integration, Jacobians vs. finite
+// differences, and the default laws as special cases of the general ones.
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+    const TestSupport::Strains strains = TestSupport::RandomStrains(500, geom.h, concrete.epsC2);
+    const double scaleN = std::abs(concrete.fcd * geom.b * geom.h);
+    const double scaleM = scaleN * geom.h;
+    const double as = 10.0 / 10000.0;
+    const PolygonSection rectPoly = PolygonSection::Rectangle(geom.b, geom.h);
+
+    TestSupport::PrintHeader("MATERIAL LAWS (compile-time policies)");
+
+    // Midpoint-rule reference over a rectangle for any concrete law (local convention)
+    auto stripNM = [&](const auto& law, double k, double q, double& N, double& M) {
+        const int strips = 20000;
+        double dx = geom.h / strips;
+        N = M = 0.0;
+        for (int j = 0; j < strips; j++) {
+            double x = -0.5 * geom.h + (j + 0.5) * dx;
+            double dF = law.Stress(k * x + q) * geom.b * dx;
+            N += dF;
+            M += dF * x;
+        }
+    };
+
+    ConcreteProperties concreteC2 = concrete;
+    concreteC2.epsC2 = -0.00175;
+    ConcreteProperties concreteHS = concrete;
+    concreteHS.fcd = -60.0e6;
+    concreteHS.epsC2 = -0.0025;
+    concreteHS.epsCu = -0.0029;
+    concreteHS.n = 1.6;
+
+    MaterialLaws::ParabolaRectangle lawC2(concreteC2);
+    MaterialLaws::ParabolaRectangleN lawN2(concrete), lawHS(concreteHS);
+    MaterialLaws::BilinearConcrete lawBi(concreteC2);
+    MaterialLaws::ParabolaRectangle lawDefault(concrete);
+
+    double maxEpsC2 = 0.0, maxN2 = 0.0, maxHS = 0.0, maxBi = 0.0, maxHSJac = 0.0;
+    for (size_t i = 0; i < strains.k.size(); i++) {
+        double k = strains.k[i], q = strains.q[i];
+        double nRef, mRef;
+
+        // Configured εc2 is used (was fixed at -2 per mille)
+        ConcreteForces c2 = ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, k, q, lawC2);
+        stripNM(lawC2, k, q, nRef, mRef);
+        maxEpsC2 = std::max({ maxEpsC2, std::abs(c2.Fc - nRef) / scaleN, std::abs(c2.Mc - mRef) / scaleM });
+
+        // General exponent with n = 2 reproduces the closed-form parabola
+        ConcreteForces d = ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, k, q, lawDefault);
+        ConcreteForces n2 = ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, k, q, lawN2);
+        maxN2 = std::max({ maxN2, std::abs(d.Fc - n2.Fc) / scaleN, std::abs(d.Mc - n2.Mc) / scaleM });
+
+        // High-strength concrete, n = 1.6
+        ConcreteForces hs = ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, k, q, lawHS);
+        stripNM(lawHS, k, q, nRef, mRef);
+        maxHS = std::max({ maxHS, std::abs(hs.Fc - nRef) / (3.0 * scaleN), std::abs(hs.Mc - mRef) / (3.0 * scaleM) });
+
+        // Bilinear concrete: rectangle closed form vs polygon vs strips
+        ConcreteForces bi = ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, k, q, lawBi);
+        ConcreteForces biPoly = ConcreteIntegrationPolygon::PolygonConcreteNM(rectPoly, k, q, lawBi);
+        stripNM(lawBi, k, q, nRef, mRef);
+        maxBi = std::max({ maxBi, std::abs(bi.Fc - nRef) / scaleN, std::abs(bi.Mc - mRef) / scaleM,
+                           std::abs(bi.Fc - biPoly.Fc) / scaleN, std::abs(bi.Mc - biPoly.Mc) / scaleM });
+    }
+
+    // Jacobian of the n = 1.6 law vs. central differences, one state per strain region
+    for (const auto& tc : TestSupport::CharacteristicStrains()) {
+        double k = (tc.epsTop - tc.epsBot) / geom.h;
+        double q = (tc.epsTop + tc.epsBot) / 2.0;
+        ConcreteForcesJacobian jac = ConcreteIntegrationFast::FastConcreteNMWithJacobian(geom.b, geom.h, k, q, lawHS);
+        const double dk = 1e-7, dq = 1e-9;
+        ConcreteForces kp = ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, k + dk, q, lawHS);
+        ConcreteForces km = ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, k - dk, q, lawHS);
+        ConcreteForces qp = ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, k, q + dq, lawHS);
+        ConcreteForces qm = ConcreteIntegrationFast::FastConcreteNM(geom.b, geom.h, k, q - dq, lawHS);
+        const double jacScale = 3.0 * scaleN / std::abs(concreteHS.epsC2);
+        maxHSJac = std::max({ maxHSJac,
+            std::abs(jac.dFc_dk - (kp.Fc - km.Fc) / (2 * dk)) / (jacScale * geom.h),
+            std::abs(jac.dFc_dq - (qp.Fc - qm.Fc) / (2 * dq)) / jacScale,
+            std::abs(jac.dMc_dk - (kp.Mc - km.Mc) / (2 * dk)) / (jacScale * geom.h * geom.h),
+            std::abs(jac.dMc_dq - (qp.Mc - qm.Mc) / (2 * dq)) / (jacScale * geom.h) });
+    }
+
+    // Steel: hardening law with k = 1 is the bilinear law; SoA kernel matches the scalar law
+    const SteelLayout layout = TestSupport::LayeredLayout();
+    const double scaleS = steel.fyd * layout.TotalArea();
+    SteelProperties steelHard = steel;
+    steelHard.k = 1.08;
+    SteelProperties steelFlat = steel;
+    MaterialLaws::HardeningSteel lawHard(steelHard), lawFlat(steelFlat);
+    MaterialLaws::BilinearSteel lawSteel(steel);
+    double maxSteelLaw = 0.0;
+    for (size_t i = 0; i < strains.k.size(); i++) {
+        double fs = 0.0, ms = 0.0;
+        for (size_t j = 0; j < layout.Size(); j++) {
+            double eps = strains.k[i] * layout.Y(j) + strains.q[i];
+            double f = layout.Area(j) * lawHard.Stress(eps);
+            fs += f;
+            ms += f * layout.Y(j);
+            maxSteelLaw = std::max(maxSteelLaw, std::abs(lawFlat.Stress(eps) - lawSteel.Stress(eps)) / steel.fyd);
+        }
+        SteelForces sf = SteelStress::LayoutForces(layout, strains.k[i], strains.q[i], lawHard);
+        maxSteelLaw = std::max({ maxSteelLaw, std::abs(sf.Fs - fs) / scaleS, std::abs(sf.Ms - ms) / (scaleS * 0.2) });
+    }
+    double hardAtUk = lawHard.Stress(steel.epsUd / 0.9) / steel.fyd;  // εuk = εud/0.9
+
+    // Diagram templated on the laws: n = 2 and k = 1 reproduce the default diagram
+    std::vector<DiagramPoint> defaultDiagram = InteractionDiagram(geom, concrete, steel, 0.6 * as, as).Generate(10);
+    std::vector<DiagramPoint> lawDiagram = InteractionDiagramT<MaterialLaws::ParabolaRectangleN, MaterialLaws::HardeningSteel>(
+        geom, concrete, steel, 0.6 * as, as).Generate(10);
+    double maxLawDiag = 0.0;
+    for (size_t i = 0; i < defaultDiagram.size() && i < lawDiagram.size(); i++) {
+        maxLawDiag = std::max(maxLawDiag, std::abs(defaultDiagram[i].N - lawDiagram[i].N) / (scaleN / 1000.0));
+        maxLawDiag = std::max(maxLawDiag, std::abs(defaultDiagram[i].M - lawDiagram[i].M) / (scaleM / 1000.0));
+    }
+
+    std::cout << std::scientific << std::setprecision(3);
+    std::cout << "Configured ec2 vs. strips:     " << maxEpsC2 << " (relative to fcd*b*h)\n";
+    std::cout << "Exponent n=2 vs. parabola:     " << maxN2 << "\n";
+    std::cout << "Exponent n=1.6 vs. strips:     " << maxHS << "\n";
+    std::cout << "Exponent n=1.6 Jacobian vs FD: " << maxHSJac << "\n";
+    std::cout << "Bilinear concrete (3 ways):    " << maxBi << "\n";
+    std::cout << "Steel laws vs. scalar:         " << maxSteelLaw << " (relative to fyd*As)\n";
+    std::cout << "Templated diagram vs. default: " << maxLawDiag << "\n";
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Hardening steel at epsUk:      " << hardAtUk << " fyd\n\n";
+
+    checks.Expect(maxEpsC2 <= 1e-7 && maxN2 <= 1e-12 && maxHS <= 1e-7 && maxHSJac <= 1e-5 && maxBi <= 1e-7 &&
+                  maxSteelLaw <= 1e-12 && maxLawDiag <= 1e-12,
+                  "Material-law policies disagree with their references");
+    checks.Expect(std::abs(hardAtUk - steelHard.k) < 1e-12, "Hardening steel does not reach k*fyd at epsUk");
+    return checks.Finish("Material-law policies match their references");
+}
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include "MaterialProperties.h"
+#include "InteractionDiagram.h"
+#include "SteelStress.h"
+#include "PerformanceTimer.h"
+#include "TestSupport.h"
+
+// Multi-layer reinforcement: diagrams from bar layouts vs. the As1 / As2 diagram, and the SoA
+// steel kernel vs. per-bar CalculateStress.
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+    const double scaleN = std::abs(concrete.fcd * geom.b * geom.h);
+    const double scaleM = scaleN * geom.h;
+    const double as = 10.0 / 10000.0;
+
+    TestSupport::PrintHeader("MULTI-LAYER REINFORCEMENT (SoA steel kernel)");
+
+    // Two layers given as bars must reproduce the As1 / As2 diagram
+    std::vector<ReinforcementBar> twoLayers = {
+        { geom.d2, geom.d2, 0.5 * as }, { geom.b - geom.d2, geom.d2, 0.5 * as },
+        { geom.d1, geom.h - geom.d1, 0.3 * as }, { geom.b - geom.d1, geom.h - geom.d1, 0.3 * as },
+    };
+    std::vector<DiagramPoint> fromAs = InteractionDiagram(geom, concrete, steel, 0.6 * as, as).Generate(10);
+    std::vector<DiagramPoint> fromBars = InteractionDiagram(geom, concrete, steel, twoLayers).Generate(10);
+    double maxLayerDiag = 0.0;
+    for (size_t i = 0; i < fromAs.size() && i < fromBars.size(); i++) {
+        maxLayerDiag = std::max(maxLayerDiag, std::abs(fromAs[i].N - fromBars[i].N) / (scaleN / 1000.0));
+        maxLayerDiag = std::max(maxLayerDiag, std::abs(fromAs[i].M - fromBars[i].M) / (scaleM / 1000.0));
+        maxLayerDiag = std::max(maxLayerDiag, std::abs(fromAs[i].Fs1 - fromBars[i].Fs1) / (scaleN / 1000.0));
+    }
+
+    // One bar layer only (bottom or top): the empty side keeps the d1 / d2 of the geometry, so
+    // the diagram is finite and equals the As2-only / As1-only diagram
+    std::vector<ReinforcementBar> bottomLayer = { { geom.d2, geom.d2, 0.5 * as }, { geom.b - geom.d2, geom.d2, 0.5 * as } };
+    std::vector<ReinforcementBar> topLayer = { { geom.d1, geom.h - geom.d1, 0.5 * as }, { geom.b - geom.d1, geom.h - geom.d1, 0.5 * as } };
+    std::vector<DiagramPoint> bottomFromAs = InteractionDiagram(geom, concrete, steel, 0.0, as).Generate(10);
+    std::vector<DiagramPoint> bottomFromBars = InteractionDiagram(geom, concrete, steel, bottomLayer).Generate(10);
+    std::vector<DiagramPoint> topFromAs = InteractionDiagram(geom, concrete, steel, as, 0.0).Generate(10);
+    std::vector<DiagramPoint> topFromBars = InteractionDiagram(geom, concrete, steel, topLayer).Generate(10);
+    bool oneLayerFinite = bottomFromBars.size() == bottomFromAs.size() && topFromBars.size() == topFromAs.size();
+    double maxOneLayer = 0.0;
+    for (size_t i = 0; oneLayerFinite && i < bottomFromAs.size(); i++) {
+        for (const DiagramPoint* pt : { &bottomFromBars[i], &topFromBars[i] }) {
+            oneLayerFinite = oneLayerFinite && std::isfinite(pt->N) && std::isfinite(pt->M) &&
+                             std::isfinite(pt->epsTop) && std::isfinite(pt->epsBot);
+        }
+        maxOneLayer = std::max({ maxOneLayer,
+            std::abs(bottomFromAs[i].N - bottomFromBars[i].N) / (scaleN / 1000.0),
+            std::abs(bottomFromAs[i].M - bottomFromBars[i].M) / (scaleM / 1000.0),
+            std::abs(topFromAs[i].N - topFromBars[i].N) / (scaleN / 1000.0),
+            std::abs(topFromAs[i].M - topFromBars[i].M) / (scaleM / 1000.0) });
+    }
+
+    // Steel moments of ApplyReinforcement by hand, M = Mc - Σ F·y with y up from the centroid:
+    // compression in the top bars adds to the moment of a compressed top fiber. Symmetric
+    // reinforcement under uniform strain (P1, P8) carries no moment; DiagramBasis agrees.
+    std::vector<DiagramPoint> symmetric = InteractionDiagram(geom, concrete, steel, as, as).Generate(10);
+    double maxSteelMoment = 0.0;
+    for (const DiagramPoint& pt : symmetric) {
+        double expected = pt.Mc - (pt.Fs1 * (geom.h / 2.0 - geom.d1) + pt.Fs2 * (geom.d2 - geom.h / 2.0));
+        maxSteelMoment = std::max(maxSteelMoment, std::abs(pt.M - expected) / (scaleM / 1000.0));
+    }
+    maxSteelMoment = std::max({ maxSteelMoment, std::abs(symmetric.front().M) / (scaleM / 1000.0),
+                                std::abs(symmetric.back().M) / (scaleM / 1000.0) });
+    DiagramBasis basis = InteractionDiagram(geom, concrete, steel).GenerateBasis(10);
+    std::vector<double> basisN(basis.Size()), basisM(basis.Size());
+    basis.MaterializeNM(as, as, basisN.data(), basisM.data());
+    for (size_t i = 0; i < basis.Size() && i < symmetric.size(); i++) {
+        maxSteelMoment = std::max(maxSteelMoment, std::abs(basisM[i] - symmetric[i].M) / (scaleM / 1000.0));
+    }
+
+    // Six layers plus web bars
+    const SteelLayout layout = TestSupport::LayeredLayout();
+    const size_t steelStates = 1000000;
+    const TestSupport::Strains strains = TestSupport::RandomStrains(steelStates, geom.h, concrete.epsC2);
+    const double scaleS = steel.fyd * layout.TotalArea();
+    std::vector<double> fsBar(steelStates), msBar(steelStates), fsSoA(steelStates), msSoA(steelStates);
+    double maxSteel = 0.0, steelSink = 0.0;
+
+    PerformanceTimer timer(false);
+    timer.Start("SteelPerBar_1M");
+    for (size_t i = 0; i < steelStates; i++) {
+        double fs = 0.0, ms = 0.0;
+        for (size_t j = 0; j < layout.Size(); j++) {
+            double f = layout.Area(j) * SteelStress::CalculateStress(strains.k[i] * layout.Y(j) + strains.q[i], steel);
+            fs += f;
+            ms += f * layout.Y(j);
+        }
+        fsBar[i] = fs;
+        msBar[i] = ms;
+    }
+    double timePerBar = timer.Stop();
+
+    timer.Start("SteelLayout_1M");
+    for (size_t i = 0; i < steelStates; i++) {
+        SteelForces sf = SteelStress::LayoutForces(layout, strains.k[i], strains.q[i], steel);
+        fsSoA[i] = sf.Fs;
+        msSoA[i] = sf.Ms;
+        steelSink += sf.MsX;
+    }
+    double timeLayout = timer.Stop();
+
+    for (size_t i = 0; i < steelStates; i++) {
+        maxSteel = std::max(maxSteel, std::abs(fsSoA[i] - fsBar[i]) / scaleS);
+        maxSteel = std::max(maxSteel, std::abs(msSoA[i] - msBar[i]) / (scaleS * 0.2));
+    }
+
+    std::cout << std::scientific << std::setprecision(3);
+    std::cout << "Bars as layers vs. As1/As2:   " << maxLayerDiag << " (relative to fcd*b*h)\n";
+    std::cout << "One bar layer vs. As1 / As2:  " << maxOneLayer << (oneLayerFinite ? "" : " (NOT FINITE)") << "\n";
+    std::cout << "Steel moments vs. by hand:    " << maxSteelMoment << "\n";
+    std::cout << "SoA kernel vs. per-bar:       " << maxSteel << " (relative to fyd*As)\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Per-bar (" << layout.Size() << " bars, 1M states): " << timePerBar << " ms\n";
+    std::cout << "SoA kernel:                   " << timeLayout << " ms (" << (timePerBar / timeLayout) << "x)\n\n";
+
+    checks.Expect(maxLayerDiag <= 1e-10 && maxSteel <= 1e-12 && std::isfinite(steelSink),
+                  "Layered reinforcement disagrees with the per-bar steel model");
+    checks.Expect(maxSteelMoment <= 1e-12, "Steel moments have the wrong lever arm or sign");
+    checks.Expect(oneLayerFinite && maxOneLayer <= 1e-10, "Single bar layer gives a non-finite or wrong diagram");
+    return checks.Finish("Layered reinforcement matches the per-bar steel model");
+}
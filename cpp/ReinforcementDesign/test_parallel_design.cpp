@@ -0,0 +1,148 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include "MaterialProperties.h"
+#include "ReinforcementDesigner.h"
+#include "WorkStealingPool.h"
+#include "TestSupport.h"
+
+// Parallel design: DesignBatch gives the same results for any thread count, and the work
+// stealing pool runs every index exactly once for uneven grains and uneven work, and hands an
+// exception of the loop body to the caller.
+
+// Bit for bit, so NaN fields of failed designs compare equal too
+static bool SameResult(const DesignResult& a, const DesignResult& b) {
+    const double fa[] = { a.As2, a.epsTop, a.epsBot, a.epsS2, a.sigmaS2, a.N_calc, a.M_calc, a.errorAbs, a.errorRel };
+    const double fb[] = { b.As2, b.epsTop, b.epsBot, b.epsS2, b.sigmaS2, b.N_calc, b.M_calc, b.errorAbs, b.errorRel };
+    return a.converged == b.converged && a.iterations == b.iterations && std::memcmp(fa, fb, sizeof(fa)) == 0;
+}
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const SteelProperties steel = TestSupport::Steel();
+    const unsigned manyThreads = std::max(4u, std::thread::hardware_concurrency());
+
+    TestSupport::PrintHeader("PARALLEL DESIGN (thread counts, work stealing)");
+
+    // Load cases over the whole diagram and beyond it (some do not converge)
+    std::vector<DesignLoads> loads(20000);
+    std::vector<double> loadN(loads.size()), loadM(loads.size());
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> uN(-3500e3, 500e3), uM(0.0, 400e3);
+    for (size_t i = 0; i < loads.size(); i++) {
+        loads[i] = { uN(rng), uM(rng) };
+        loadN[i] = loads[i].N;
+        loadM[i] = loads[i].M;
+    }
+
+    ReinforcementDesigner designer(geom, concrete, steel, 10, DesignSolver::Newton);
+    size_t batchDiffers = 0, converged = 0;
+    for (DesignSolver solver : { DesignSolver::Newton, DesignSolver::Interpolation }) {
+        designer.SetSolver(solver);
+        designer.SetThreadCount(1);
+        std::vector<DesignResult> serial = designer.DesignBatch(loads);
+        for (const DesignResult& r : serial) converged += r.converged ? 1 : 0;
+
+        for (unsigned threads : { 2u, manyThreads }) {
+            designer.SetThreadCount(threads);
+            std::vector<DesignResult> rows = designer.DesignBatch(loads);
+            std::vector<DesignResult> columns(loads.size());
+            designer.DesignBatch(loadN.data(), loadM.data(), loads.size(), columns.data());
+            for (size_t i = 0; i < loads.size(); i++) {
+                if (!SameResult(rows[i], serial[i]) || !SameResult(columns[i], serial[i])) batchDiffers++;
+            }
+        }
+    }
+
+    // Pool: counts that are not multiples of the grain, a grain above the count, more
+    // participants than chunks, and the expensive indices all in the first participant's block.
+    // The other participants finish their cheap blocks long before that one, so every pool of
+    // more than one participant must steal from it.
+    size_t poolMissed = 0, badChunks = 0, stolen = 0, poolsNotStealing = 0;
+    for (unsigned size : { 1u, 2u, 3u, 8u }) {
+        WorkStealingPool pool(size);
+        const size_t stolenBefore = stolen;
+        for (size_t count : { size_t(1), size_t(7), size_t(1000), size_t(1003), size_t(4097) }) {
+            for (size_t grain : { size_t(1), size_t(3), size_t(16), size_t(5000) }) {
+                std::vector<std::atomic<int>> visits(count);
+                for (auto& v : visits) v = 0;
+                std::mutex chunkMutex;
+                std::vector<std::thread::id> chunkThread((count + grain - 1) / grain);
+                pool.ParallelFor(count, grain, [&](size_t begin, size_t end) {
+                    if (begin % grain != 0 || end > count || end - begin > grain || (end != count && end - begin != grain)) {
+                        std::lock_guard<std::mutex> lock(chunkMutex);
+                        badChunks++;
+                    }
+                    for (size_t i = begin; i < end; i++) {
+                        visits[i]++;
+                        if (i < count / size / 4) std::this_thread::sleep_for(std::chrono::microseconds(20));
+                    }
+                    chunkThread[begin / grain] = std::this_thread::get_id();
+                });
+                for (auto& v : visits) poolMissed += (v != 1) ? 1 : 0;
+
+                // Chunks of the first block run by another thread were stolen
+                size_t firstBlock = chunkThread.size() / size;
+                for (size_t c = 0; size > 1 && c < firstBlock; c++) {
+                    stolen += (chunkThread[c] != std::this_thread::get_id()) ? 1 : 0;
+                }
+            }
+        }
+        if (size > 1 && stolen == stolenBefore) poolsNotStealing++;
+    }
+
+    // Exceptions: the chunk holding index 500 throws, or every chunk a pool thread runs throws
+    // (the caller's own chunks are slow, so the pool threads take part). The caller gets the
+    // exception once the threads are done, and the pool runs the next loop normally.
+    size_t exceptionsLost = 0;
+    const std::thread::id caller = std::this_thread::get_id();
+    for (unsigned size : { 1u, 2u, 8u }) {
+        WorkStealingPool pool(size);
+        for (bool onPoolThreads : { false, true }) {
+            if (onPoolThreads && size == 1) continue;
+            bool caught = false;
+            try {
+                pool.ParallelFor(1000, 7, [&](size_t begin, size_t end) {
+                    bool poolThread = std::this_thread::get_id() != caller;
+                    if (onPoolThreads ? poolThread : (begin <= 500 && 500 < end)) {
+                        throw std::runtime_error("chunk " + std::to_string(begin));
+                    }
+                    if (!poolThread) std::this_thread::sleep_for(std::chrono::microseconds(50));
+                });
+            } catch (const std::runtime_error& e) {
+                caught = std::string(e.what()).rfind("chunk ", 0) == 0;
+            }
+            std::vector<std::atomic<int>> visits(1000);
+            for (auto& v : visits) v = 0;
+            pool.ParallelFor(visits.size(), 7, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) visits[i]++;
+            });
+            bool reusable = std::all_of(visits.begin(), visits.end(), [](const std::atomic<int>& v) { return v == 1; });
+            if (!caught || !reusable) exceptionsLost++;
+        }
+    }
+
+    std::cout << "Batch of " << loads.size() << " cases (" << converged << " converged over both solvers) with 1, 2 and "
+              << manyThreads << " threads: " << batchDiffers << " different results\n";
+    std::cout << "Pool: indices not run exactly once: " << poolMissed << ", malformed chunks: " << badChunks
+              << ", chunks stolen from the busy block: " << stolen << "\n";
+    std::cout << "Pool: exceptions lost or pool unusable afterwards: " << exceptionsLost << "\n\n";
+
+    checks.Expect(converged > 0 && converged < 2 * loads.size(), "Batch does not mix converged and failed cases");
+    checks.Expect(batchDiffers == 0, "DesignBatch results depend on the thread count");
+    checks.Expect(poolMissed == 0, "Work stealing pool skips or repeats indices");
+    checks.Expect(badChunks == 0, "Work stealing pool runs chunks outside the grain");
+    checks.Expect(poolsNotStealing == 0, "Work stealing pool leaves the busy block to its owner");
+    checks.Expect(exceptionsLost == 0, "Exception thrown by a pool loop body is not rethrown to the caller");
+    return checks.Finish("Parallel design is independent of the thread count");
+}
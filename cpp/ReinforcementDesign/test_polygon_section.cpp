@@ -0,0 +1,90 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include "MaterialProperties.h"
+#include "ConcreteIntegrationFast.h"
+#include "ConcreteIntegrationPolygon.h"
+#include "PerformanceTimer.h"
+#include "TestSupport.h"
+
+// Polygonal sections (Green's theorem) vs. the closed-form rectangle: rectangle, hollow box
+// and circle, plus timings.
+
+int main() {
+    TestSupport::Checks checks;
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+    const TestSupport::Strains strains = TestSupport::RandomStrains(100000, geom.h, concrete.epsC2);
+    const double scaleN = std::abs(concrete.fcd * geom.b * geom.h);
+    const double scaleM = scaleN * geom.h;
+
+    TestSupport::PrintHeader("POLYGON SECTIONS (analytical, Green's theorem)");
+
+    // Rectangle as a polygon must reproduce ConcreteIntegrationFast
+    PolygonSection rectPoly = PolygonSection::Rectangle(geom.b, geom.h);
+    double maxPolyRect = 0.0;
+    for (size_t i = 0; i < strains.k.size(); i++) {
+        double eTop = strains.k[i] * geom.h / 2.0 + strains.q[i];
+        double eBot = -strains.k[i] * geom.h / 2.0 + strains.q[i];
+        ConcreteForces a = ConcreteIntegrationFast::CalculateForce(eTop, eBot, geom.b, geom.h, concrete);
+        ConcreteForces p = ConcreteIntegrationPolygon::CalculateForce(eTop, eBot, rectPoly, concrete);
+        maxPolyRect = std::max(maxPolyRect, std::abs(a.Fc - p.Fc) / scaleN);
+        maxPolyRect = std::max(maxPolyRect, std::abs(a.Mc - p.Mc) / scaleM);
+    }
+
+    // Hollow box (outer ring + hole) must equal outer minus inner rectangle
+    const double boxB = 0.8, boxH = 1.0, boxTw = 0.15, boxTf = 0.2;
+    PolygonSection box = PolygonSection::HollowBox(boxB, boxH, boxTw, boxTf);
+    const double scaleBoxN = std::abs(concrete.fcd * box.Area());
+    double maxPolyBox = 0.0;
+    for (size_t i = 0; i < 10000; i++) {
+        double k = strains.k[i] * geom.h / boxH;
+        ConcreteForces outer = ConcreteIntegrationFast::FastConcreteNM(boxB, boxH, k, strains.q[i], concrete.fcd);
+        ConcreteForces inner = ConcreteIntegrationFast::FastConcreteNM(boxB - 2 * boxTw, boxH - 2 * boxTf,
+                                                                       k, strains.q[i], concrete.fcd);
+        ConcreteForces p = ConcreteIntegrationPolygon::PolygonConcreteNM(box, k, strains.q[i], concrete);
+        maxPolyBox = std::max(maxPolyBox, std::abs(outer.Fc - inner.Fc - p.Fc) / scaleBoxN);
+        maxPolyBox = std::max(maxPolyBox, std::abs(outer.Mc - inner.Mc - p.Mc) / (scaleBoxN * boxH));
+    }
+
+    // Circle as an equal-area polygon
+    const double pi = 3.14159265358979323846;
+    const double circleD = 0.5;
+    PolygonSection circle = PolygonSection::Circle(circleD, 64);
+    double circleAreaErr = std::abs(circle.Area() / (pi * circleD * circleD / 4.0) - 1.0);
+    double circleInertiaErr = std::abs(circle.Inertia() / (pi * std::pow(circleD, 4) / 64.0) - 1.0);
+
+    PerformanceTimer timer(false);
+    const int iterations = 10000;
+    const double epsTop = -0.003, epsBot = 0.002;
+    double polySink = 0.0;  // keeps the timed calls from being optimized away
+    timer.Start("PolygonRectangle_10000");
+    for (int i = 0; i < iterations; i++) {
+        ConcreteForces cf = ConcreteIntegrationPolygon::CalculateForce(epsTop, epsBot + i * 1e-12, rectPoly, concrete);
+        polySink += cf.Fc;
+    }
+    double timePolyRect = timer.Stop();
+
+    timer.Start("PolygonCircle64_10000");
+    for (int i = 0; i < iterations; i++) {
+        ConcreteForces cf = ConcreteIntegrationPolygon::CalculateForce(epsTop, epsBot + i * 1e-12, circle, concrete);
+        polySink += cf.Fc;
+    }
+    double timePolyCircle = timer.Stop();
+
+    std::cout << std::scientific << std::setprecision(3);
+    std::cout << "Rectangle vs. analytical:   " << maxPolyRect << " (relative to fcd*b*h)\n";
+    std::cout << "Hollow box vs. difference:  " << maxPolyBox << " (relative to fcd*A)\n";
+    std::cout << "Circle (64 edges) area:     " << circleAreaErr << " relative error\n";
+    std::cout << "Circle (64 edges) inertia:  " << circleInertiaErr << " relative error\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Rectangle polygon:          " << timePolyRect << " ms (" << iterations << " calls)\n";
+    std::cout << "Circle polygon (64 edges):  " << timePolyCircle << " ms (" << iterations << " calls)\n\n";
+
+    checks.Expect(maxPolyRect <= 1e-10 && maxPolyBox <= 1e-10 && std::isfinite(polySink),
+                  "Polygon integration deviates from the closed-form rectangle results");
+    // 64-gon of equal area: exact area, inertia within the faceting error
+    checks.Expect(circleAreaErr < 1e-12 && circleInertiaErr < 1e-3, "Circle polygon has the wrong area or inertia");
+    return checks.Finish("Polygon sections match the closed-form results");
+}
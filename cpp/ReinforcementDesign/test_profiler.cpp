@@ -0,0 +1,92 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MaterialProperties.h"
+#include "ConcreteIntegrationFast.h"
+#include "PerformanceTimer.h"
+#include "Benchmark.h"
+#include "TestSupport.h"
+
+// Hierarchical profiler: scope nesting, per-thread buffers, merged percentiles, optional
+// hardware counters and the Chrome trace export.
+
+int main() {
+    TestSupport::Checks checks;
+    TestSupport::ScratchDirectory scratch("test_profiler");
+    const SectionGeometry geom = TestSupport::Section();
+    const ConcreteProperties concrete = TestSupport::Concrete();
+
+    TestSupport::PrintHeader("PROFILER (nested scopes, 4 threads)");
+
+    PerformanceTimer profiler(false);
+    bool profCounters = profiler.EnableHardwareCounters();  // optional: unavailable in most containers
+    std::cout << "Hardware counters: " << profiler.HardwareCountersStatus() << "\n";
+    profiler.EnableTrace();
+    const int profThreads = 4, profCalls = 2000;
+    auto profWork = [&](int calls) {
+        ScopedTimer outer(profiler, "Outer");
+        double local = 0.0;
+        for (int i = 0; i < calls; i++) {
+            ScopedTimer inner(profiler, "Inner");
+            local += ConcreteIntegrationFast::CalculateForce(-0.003, 0.002 * (i % 7), geom.b, geom.h, concrete).Fc;
+        }
+        Bench::DoNotOptimize(local);
+    };
+    profiler.Start("Main");
+    std::vector<std::thread> profWorkers;
+    for (int t = 0; t < profThreads; t++) profWorkers.emplace_back(profWork, profCalls);
+    for (auto& w : profWorkers) w.join();
+    profWork(profCalls);
+    double profMainMs = profiler.Stop();
+
+    // Expected tree: Main/Outer/Inner (main thread) and Outer/Inner (workers, merged)
+    std::vector<ScopeStats> profStats = profiler.GetScopeStats();
+    auto findScope = [&](const std::string& path) -> const ScopeStats* {
+        for (const auto& st : profStats) {
+            if (st.path == path) return &st;
+        }
+        return nullptr;
+    };
+    const ScopeStats* profMainInner = findScope("Main/Outer/Inner");
+    const ScopeStats* profWorkerInner = findScope("Outer/Inner");
+    const ScopeStats* profWorkerOuter = findScope("Outer");
+    const ScopeStats* profMain = findScope("Main");
+    bool treeOk = profStats.size() == 5 && profMain && profMainInner && profWorkerInner && profWorkerOuter &&
+                  profMain->count == 1 && profMainInner->count == uint64_t(profCalls) &&
+                  profWorkerInner->count == uint64_t(profThreads) * profCalls &&
+                  profWorkerOuter->count == uint64_t(profThreads);
+    bool statsOk = std::isfinite(profMainMs) && profMainMs > 0.0;
+    for (const auto& st : profStats) {
+        // With counters every scope has them (the inner ones run at least the integration);
+        // without, none has and timing is unaffected
+        statsOk = statsOk && st.has_counters == profCounters &&
+                  (!profCounters || st.counters[PerfCounters::Instructions] > 0.0);
+        statsOk = statsOk && st.p50_us <= st.p99_us && st.p99_us <= st.max_us * (1.0 + 1e-12) &&
+                  st.self_ms <= st.total_ms && st.mean_us <= st.max_us;
+        std::cout << std::setw(22) << std::left << st.path << std::right << std::setw(8) << st.count
+                  << std::fixed << std::setprecision(3) << "  mean " << st.mean_us << " us  p50 " << st.p50_us
+                  << " us  p99 " << st.p99_us << " us  max " << st.max_us << " us\n";
+    }
+    std::cout << "Scope tree and statistics consistent: " << (treeOk && statsOk ? "yes" : "NO") << "\n";
+
+    // Trace: one complete event per call, one thread_name record per thread
+    const std::string traceFile = scratch.File("trace.json");
+    profiler.ExportTrace(traceFile);
+    size_t traceEvents = 0, traceThreads = 0;
+    const std::string json = TestSupport::ReadFile(traceFile);
+    for (size_t pos = 0; (pos = json.find("\"ph\":\"X\"", pos)) != std::string::npos; pos++) traceEvents++;
+    for (size_t pos = 0; (pos = json.find("\"thread_name\"", pos)) != std::string::npos; pos++) traceThreads++;
+    uint64_t profCallsTotal = 0;
+    for (const auto& st : profStats) profCallsTotal += st.count;
+    bool traceOk = json.rfind("{\"traceEvents\":[", 0) == 0 && json.find("]") != std::string::npos &&
+                   traceEvents == profCallsTotal && traceThreads == size_t(profThreads) + 1;
+    std::cout << "Trace events: " << traceEvents << " of " << profCallsTotal << " calls on " << traceThreads << " threads\n\n";
+
+    checks.Expect(treeOk, "Profiler scope tree does not match the nesting of the calls");
+    checks.Expect(statsOk, "Profiler statistics are inconsistent");
+    checks.Expect(traceOk, "Profiler trace misses events or threads");
+    return checks.Finish("Profiler scope tree, statistics and trace are consistent");
+}